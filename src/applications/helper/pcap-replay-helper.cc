@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-replay-helper.h"
+#include "ns3/pcap-replay.h"
+#include "ns3/string.h"
+
+namespace ns3 {
+
+PcapReplayHelper::PcapReplayHelper (std::string filename)
+{
+  m_factory.SetTypeId (PcapReplay::GetTypeId ());
+  m_factory.Set ("File", StringValue (filename));
+}
+
+void
+PcapReplayHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+PcapReplayHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (Install (*i));
+    }
+  return apps;
+}
+
+ApplicationContainer
+PcapReplayHelper::Install (Ptr<Node> node) const
+{
+  Ptr<PcapReplay> app = m_factory.Create<PcapReplay> ();
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+ApplicationContainer
+PcapReplayHelper::InstallOnDevice (Ptr<NetDevice> device) const
+{
+  Ptr<PcapReplay> app = m_factory.Create<PcapReplay> ();
+  app->SetDevice (device);
+  device->GetNode ()->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+} // namespace ns3
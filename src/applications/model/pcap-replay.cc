@@ -0,0 +1,598 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-replay.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/mac48-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/udp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/trace-helper.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplay");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplay);
+
+namespace {
+
+const uint16_t ETHERTYPE_IPV4 = 0x0800;  //!< EtherType of IPv4
+const uint16_t ETHERTYPE_IPV6 = 0x86dd;  //!< EtherType of IPv6
+const uint8_t PROTOCOL_TCP = 6;          //!< IP protocol number of TCP
+const uint8_t PROTOCOL_UDP = 17;         //!< IP protocol number of UDP
+
+/**
+ * \param [in] data Two bytes.
+ * \returns The bytes in network order.
+ */
+uint16_t
+ReadNtohU16 (const uint8_t *data)
+{
+  return (data[0] << 8) | data[1];
+}
+
+/**
+ * Update an Internet checksum for new bytes, as in RFC 1624.
+ * \param [in,out] checksum The checksum, in network order.
+ * \param [in] from The old bytes.
+ * \param [in] to The new bytes.
+ * \param [in] size The number of bytes, even.
+ */
+void
+UpdateChecksum (uint8_t *checksum, const uint8_t *from, const uint8_t *to, uint32_t size)
+{
+  uint32_t sum = ~ReadNtohU16 (checksum) & 0xffff;
+  for (uint32_t i = 0; i < size; i += 2)
+    {
+      sum += ~ReadNtohU16 (from + i) & 0xffff;
+      sum += ReadNtohU16 (to + i);
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  sum = ~sum & 0xffff;
+  checksum[0] = sum >> 8;
+  checksum[1] = sum & 0xff;
+}
+
+/**
+ * \param [in] data The bytes of an IP packet.
+ * \param [in] size The number of bytes.
+ * \param [in] offset The position of the transport header.
+ * \param [in] protocol The transport protocol.
+ * \returns The checksum of the transport header, or 0 if it is missing.
+ */
+uint8_t *
+GetTransportChecksum (uint8_t *data, uint32_t size, uint32_t offset, uint8_t protocol)
+{
+  uint32_t position;
+  if (protocol == PROTOCOL_TCP)
+    {
+      position = offset + 16;
+    }
+  else if (protocol == PROTOCOL_UDP)
+    {
+      position = offset + 6;
+    }
+  else
+    {
+      return 0;
+    }
+  if (position + 2 > size)
+    {
+      return 0;
+    }
+  // A zero UDP checksum is no checksum.
+  if (protocol == PROTOCOL_UDP && data[position] == 0 && data[position + 1] == 0)
+    {
+      return 0;
+    }
+  return data + position;
+}
+
+} // anonymous namespace
+
+TypeId
+PcapReplay::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplay")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<PcapReplay> ()
+    .AddAttribute ("File",
+                   "The pcap or pcapng file to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplay::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("TimeScale",
+                   "The factor applied to the gaps between the recorded "
+                   "time stamps: 2 replays twice slower, 0.5 twice faster.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&PcapReplay::m_timeScale),
+                   MakeDoubleChecker<double> (0))
+    .AddTraceSource ("Tx", "A packet is sent",
+                     MakeTraceSourceAccessor (&PcapReplay::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplay::PcapReplay ()
+  : m_timeScale (1.0),
+    m_replayed (0),
+    m_skipped (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplay::~PcapReplay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PcapReplay::AddFile (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_filenames.push_back (filename);
+}
+
+void
+PcapReplay::SetDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_device = device;
+}
+
+void
+PcapReplay::AddAddressMapping (Ipv4Address from, Ipv4Address to)
+{
+  NS_LOG_FUNCTION (this << from << to);
+  m_ipv4Mapping[from] = to;
+}
+
+void
+PcapReplay::AddAddressMapping (Ipv6Address from, Ipv6Address to)
+{
+  NS_LOG_FUNCTION (this << from << to);
+  m_ipv6Mapping[from] = to;
+}
+
+uint64_t
+PcapReplay::GetNReplayed (void) const
+{
+  return m_replayed;
+}
+
+uint64_t
+PcapReplay::GetNSkipped (void) const
+{
+  return m_skipped;
+}
+
+void
+PcapReplay::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<struct Source>::iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      delete i->reader;
+    }
+  m_sources.clear ();
+  m_device = 0;
+  m_socket = 0;
+  m_socket6 = 0;
+  Application::DoDispose ();
+}
+
+void
+PcapReplay::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<std::string> filenames;
+  if (!m_filename.empty ())
+    {
+      filenames.push_back (m_filename);
+    }
+  filenames.insert (filenames.end (), m_filenames.begin (), m_filenames.end ());
+
+  for (std::vector<std::string>::const_iterator i = filenames.begin (); i != filenames.end (); ++i)
+    {
+      struct Source source;
+      source.reader = new PcapReader ();
+      if (!source.reader->Open (*i))
+        {
+          NS_FATAL_ERROR ("Cannot replay " << *i);
+        }
+      ReadNext (source);
+      m_sources.push_back (source);
+    }
+
+  m_start = Simulator::Now ();
+  bool first = true;
+  for (std::vector<struct Source>::const_iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      if (i->pending && (first || i->record.time < m_origin))
+        {
+          m_origin = i->record.time;
+          first = false;
+        }
+    }
+  ScheduleNext ();
+}
+
+void
+PcapReplay::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_event);
+  for (std::vector<struct Source>::iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      delete i->reader;
+    }
+  m_sources.clear ();
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket = 0;
+    }
+  if (m_socket6 != 0)
+    {
+      m_socket6->Close ();
+      m_socket6 = 0;
+    }
+}
+
+void
+PcapReplay::ReadNext (struct Source &source)
+{
+  source.pending = source.reader->Read (source.record);
+  if (!source.pending && source.reader->Fail ())
+    {
+      NS_LOG_WARN ("Stop replaying a malformed file");
+    }
+}
+
+void
+PcapReplay::ScheduleNext (void)
+{
+  struct Source *next = 0;
+  for (std::vector<struct Source>::iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      if (i->pending && (next == 0 || i->record.time < next->record.time))
+        {
+          next = &*i;
+        }
+    }
+  if (next == 0)
+    {
+      NS_LOG_LOGIC ("Replayed all the files");
+      return;
+    }
+  // Records out of order are sent at once.
+  Time at = m_start + (next->record.time - m_origin) * int64x64_t (m_timeScale);
+  Time delay = at > Simulator::Now () ? at - Simulator::Now () : Time (0);
+  m_event = Simulator::Schedule (delay, &PcapReplay::Replay, this);
+}
+
+void
+PcapReplay::Replay (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct Source *source = 0;
+  for (std::vector<struct Source>::iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      if (i->pending && (source == 0 || i->record.time < source->record.time))
+        {
+          source = &*i;
+        }
+    }
+  NS_ASSERT (source != 0);
+  const PcapReader::Record &record = source->record;
+
+  uint32_t offset;
+  uint16_t protocol;
+  Address destination;
+  bool sent = false;
+  if (ParseLinkHeader (record.data, record.inclLen, record.dataLinkType,
+                       offset, protocol, destination))
+    {
+      const uint8_t *data = record.data + offset;
+      uint32_t size = record.inclLen - offset;
+      if (!m_ipv4Mapping.empty () || !m_ipv6Mapping.empty ())
+        {
+          m_scratch.assign (data, data + size);
+          Remap (m_scratch.data (), size, protocol);
+          data = m_scratch.data ();
+        }
+      Ptr<Packet> packet = Create<Packet> (data, size);
+      if (record.origLen > record.inclLen)
+        {
+          packet->AddPaddingAtEnd (record.origLen - record.inclLen);
+        }
+
+      if (m_device != 0)
+        {
+          if (!Mac48Address::IsMatchingType (destination)
+              || !Mac48Address::IsMatchingType (m_device->GetAddress ()))
+            {
+              destination = m_device->GetBroadcast ();
+            }
+          m_txTrace (packet);
+          sent = m_device->Send (packet, destination, protocol);
+        }
+      else
+        {
+          sent = SendToSocket (packet, protocol);
+        }
+    }
+  if (sent)
+    {
+      m_replayed++;
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Skip a record of data link type " << record.dataLinkType);
+      m_skipped++;
+    }
+
+  ReadNext (*source);
+  ScheduleNext ();
+}
+
+bool
+PcapReplay::ParseLinkHeader (const uint8_t *data, uint32_t size, uint32_t dataLinkType,
+                             uint32_t &offset, uint16_t &protocol, Address &destination) const
+{
+  switch (dataLinkType)
+    {
+    case PcapHelper::DLT_EN10MB:
+      if (size < 14)
+        {
+          return false;
+        }
+      {
+        Mac48Address address;
+        address.CopyFrom (data);
+        destination = address;
+      }
+      protocol = ReadNtohU16 (data + 12);
+      offset = 14;
+      if (protocol <= 1500)
+        {
+          // An 802.3 length, followed by an LLC/SNAP header.
+          if (size < 22)
+            {
+              return false;
+            }
+          protocol = ReadNtohU16 (data + 20);
+          offset = 22;
+        }
+      return true;
+    case PcapHelper::DLT_PPP:
+      offset = 0;
+      if (size >= 2 && data[0] == 0xff && data[1] == 0x03)
+        {
+          // HDLC-like framing.
+          offset = 2;
+        }
+      if (size < offset + 2)
+        {
+          return false;
+        }
+      switch (ReadNtohU16 (data + offset))
+        {
+        case 0x0021:
+          protocol = ETHERTYPE_IPV4;
+          break;
+        case 0x0057:
+          protocol = ETHERTYPE_IPV6;
+          break;
+        default:
+          return false;
+        }
+      offset += 2;
+      return true;
+    case PcapHelper::DLT_RAW:
+      offset = 0;
+      break;
+    case PcapHelper::DLT_NULL:
+      // A protocol family, in the byte order of the capturing host.
+      offset = 4;
+      break;
+    case PcapHelper::DLT_LINUX_SLL:
+      if (size < 16)
+        {
+          return false;
+        }
+      offset = 16;
+      protocol = ReadNtohU16 (data + 14);
+      return true;
+    default:
+      return false;
+    }
+
+  // The version of the IP header tells the protocol.
+  if (size <= offset)
+    {
+      return false;
+    }
+  switch (data[offset] >> 4)
+    {
+    case 4:
+      protocol = ETHERTYPE_IPV4;
+      return true;
+    case 6:
+      protocol = ETHERTYPE_IPV6;
+      return true;
+    default:
+      return false;
+    }
+}
+
+void
+PcapReplay::Remap (uint8_t *data, uint32_t size, uint16_t protocol) const
+{
+  if (protocol == ETHERTYPE_IPV4)
+    {
+      uint32_t headerSize = (data[0] & 0x0f) * 4;
+      if (size < 20 || headerSize < 20 || headerSize > size)
+        {
+          return;
+        }
+      // Only the first fragment holds the transport header.
+      uint16_t fragmentOffset = ReadNtohU16 (data + 6) & 0x1fff;
+      uint8_t *transportChecksum = 0;
+      if (fragmentOffset == 0)
+        {
+          transportChecksum = GetTransportChecksum (data, size, headerSize, data[9]);
+        }
+      for (uint32_t position = 12; position <= 16; position += 4)
+        {
+          std::map<Ipv4Address, Ipv4Address>::const_iterator it =
+            m_ipv4Mapping.find (Ipv4Address::Deserialize (data + position));
+          if (it == m_ipv4Mapping.end ())
+            {
+              continue;
+            }
+          uint8_t address[4];
+          it->second.Serialize (address);
+          UpdateChecksum (data + 10, data + position, address, 4);
+          if (transportChecksum != 0)
+            {
+              UpdateChecksum (transportChecksum, data + position, address, 4);
+            }
+          std::memcpy (data + position, address, 4);
+        }
+    }
+  else if (protocol == ETHERTYPE_IPV6)
+    {
+      if (size < 40)
+        {
+          return;
+        }
+      // Extension headers are not walked.
+      uint8_t *transportChecksum = GetTransportChecksum (data, size, 40, data[6]);
+      for (uint32_t position = 8; position <= 24; position += 16)
+        {
+          std::map<Ipv6Address, Ipv6Address>::const_iterator it =
+            m_ipv6Mapping.find (Ipv6Address::Deserialize (data + position));
+          if (it == m_ipv6Mapping.end ())
+            {
+              continue;
+            }
+          uint8_t address[16];
+          it->second.Serialize (address);
+          if (transportChecksum != 0)
+            {
+              UpdateChecksum (transportChecksum, data + position, address, 16);
+            }
+          std::memcpy (data + position, address, 16);
+        }
+    }
+}
+
+bool
+PcapReplay::SendToSocket (Ptr<Packet> packet, uint16_t protocol)
+{
+  Address destination;
+  if (protocol == ETHERTYPE_IPV4)
+    {
+      uint8_t first;
+      if (packet->CopyData (&first, 1) != 1 || (first & 0x0f) * 4u > packet->GetSize ())
+        {
+          return false;
+        }
+      Ipv4Header header;
+      packet->RemoveHeader (header);
+      if (header.GetProtocol () != PROTOCOL_UDP || header.GetFragmentOffset () != 0
+          || !header.IsLastFragment ())
+        {
+          return false;
+        }
+      if (packet->GetSize () > header.GetPayloadSize ())
+        {
+          packet->RemoveAtEnd (packet->GetSize () - header.GetPayloadSize ());
+        }
+      if (m_socket == 0)
+        {
+          m_socket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+          m_socket->Bind ();
+        }
+      destination = InetSocketAddress (header.GetDestination ());
+    }
+  else if (protocol == ETHERTYPE_IPV6)
+    {
+      if (packet->GetSize () < 40)
+        {
+          return false;
+        }
+      Ipv6Header header;
+      packet->RemoveHeader (header);
+      if (header.GetNextHeader () != PROTOCOL_UDP)
+        {
+          return false;
+        }
+      if (packet->GetSize () > header.GetPayloadLength ())
+        {
+          packet->RemoveAtEnd (packet->GetSize () - header.GetPayloadLength ());
+        }
+      if (m_socket6 == 0)
+        {
+          m_socket6 = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+          m_socket6->Bind6 ();
+        }
+      destination = Inet6SocketAddress (header.GetDestinationAddress ());
+    }
+  else
+    {
+      return false;
+    }
+
+  if (packet->GetSize () < 8)
+    {
+      return false;
+    }
+  UdpHeader udp;
+  packet->RemoveHeader (udp);
+  m_txTrace (packet);
+  if (protocol == ETHERTYPE_IPV4)
+    {
+      InetSocketAddress address = InetSocketAddress::ConvertFrom (destination);
+      address.SetPort (udp.GetDestinationPort ());
+      return m_socket->SendTo (packet, 0, address) >= 0;
+    }
+  Inet6SocketAddress address = Inet6SocketAddress::ConvertFrom (destination);
+  address.SetPort (udp.GetDestinationPort ());
+  return m_socket6->SendTo (packet, 0, address) >= 0;
+}
+
+} // namespace ns3
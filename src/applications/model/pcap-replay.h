@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_H
+#define PCAP_REPLAY_H
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/pcap-reader.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+class NetDevice;
+
+/**
+ * \ingroup applications
+ * \defgroup pcapreplay PcapReplay
+ *
+ * Traffic generator replaying pcap captures.
+ */
+
+/**
+ * \ingroup pcapreplay
+ *
+ * \brief Replay the packets of pcap and pcapng files.
+ *
+ * The records of the files are read one at a time with a PcapReader,
+ * so that captures larger than the memory can be replayed, and each
+ * packet is sent at its recorded time stamp, relative to the earliest
+ * time stamp of the files and to the start of the application.  The
+ * gaps between the packets are multiplied by the "TimeScale" attribute.
+ * When several files are replayed, their records are merged by time
+ * stamp.  Packets truncated by the snap length of the capture are
+ * padded with zeros to their original length.
+ *
+ * The packets are sent in one of two ways:
+ * \li if a device was set with SetDevice, the link-layer header of the
+ *     captured frames is removed and the packets are sent by the device,
+ *     to the captured destination if the device has a MAC-48 address
+ *     and to its broadcast address otherwise;
+ * \li otherwise, the payloads of the captured UDP datagrams are sent
+ *     through UDP sockets of the node, to the captured destination
+ *     address and port.
+ *
+ * Ethernet, PPP, raw IP, BSD loopback and Linux cooked captures are
+ * supported; the records of other data link types, and in socket mode
+ * the packets which are not UDP datagrams, are skipped.
+ *
+ * The IPv4 and IPv6 addresses of the captured packets may be replaced
+ * with the addresses of the simulation with AddAddressMapping.  The IPv4
+ * header checksum and the UDP and TCP checksums of the packets whose
+ * addresses are replaced are updated incrementally, so that they remain
+ * valid if they were (the transport checksums of IPv6 packets with
+ * extension headers are left alone).
+ */
+class PcapReplay : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapReplay ();
+  virtual ~PcapReplay ();
+
+  /**
+   * \brief Add a file to replay, after the one of the "File" attribute.
+   * \param filename The name of a pcap or pcapng file.
+   */
+  void AddFile (std::string const &filename);
+
+  /**
+   * \brief Send the packets through a device rather than through sockets.
+   * \param device A device of the node of the application.
+   */
+  void SetDevice (Ptr<NetDevice> device);
+
+  /**
+   * \brief Replace an IPv4 address of the captured packets.
+   * \param from The captured address.
+   * \param to The address to use instead.
+   */
+  void AddAddressMapping (Ipv4Address from, Ipv4Address to);
+  /**
+   * \brief Replace an IPv6 address of the captured packets.
+   * \param from The captured address.
+   * \param to The address to use instead.
+   */
+  void AddAddressMapping (Ipv6Address from, Ipv6Address to);
+
+  /**
+   * \return The number of packets sent so far.
+   */
+  uint64_t GetNReplayed (void) const;
+  /**
+   * \return The number of records skipped so far.
+   */
+  uint64_t GetNSkipped (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /** A file being replayed. */
+  struct Source
+  {
+    PcapReader *reader;           //!< The reader of the file.
+    PcapReader::Record record;    //!< The next record of the file.
+    bool pending;                 //!< Whether the record is yet to be sent.
+  };
+
+  /**
+   * Read the next record of a file.
+   * \param source The file.
+   */
+  void ReadNext (struct Source &source);
+  /**
+   * Schedule the earliest pending record of the files.
+   */
+  void ScheduleNext (void);
+  /**
+   * Send the earliest pending record and schedule the next one.
+   */
+  void Replay (void);
+  /**
+   * Find the payload of a captured frame.
+   * \param data The bytes of the frame.
+   * \param size The number of bytes of the frame.
+   * \param dataLinkType The data link type of the frame.
+   * \param offset [out] The position of the payload of the frame.
+   * \param protocol [out] The EtherType of the payload of the frame.
+   * \param destination [out] The destination of the frame, if any.
+   * \returns false if the data link type is not supported or the frame
+   *          is too short.
+   */
+  bool ParseLinkHeader (const uint8_t *data, uint32_t size, uint32_t dataLinkType,
+                        uint32_t &offset, uint16_t &protocol, Address &destination) const;
+  /**
+   * Replace the mapped addresses of an IP packet and update its checksums.
+   * \param data The bytes of the packet.
+   * \param size The number of bytes of the packet.
+   * \param protocol The EtherType of the packet.
+   */
+  void Remap (uint8_t *data, uint32_t size, uint16_t protocol) const;
+  /**
+   * Send the payload of a UDP datagram through a socket.
+   * \param packet The IP packet.
+   * \param protocol The EtherType of the packet.
+   * \returns false if the packet is not a UDP datagram.
+   */
+  bool SendToSocket (Ptr<Packet> packet, uint16_t protocol);
+
+  std::string m_filename;                  //!< The file of the "File" attribute.
+  std::vector<std::string> m_filenames;    //!< The files added with AddFile.
+  double m_timeScale;                      //!< The factor of the gaps between packets.
+  Ptr<NetDevice> m_device;                 //!< The device sending the packets, or 0.
+  std::map<Ipv4Address, Ipv4Address> m_ipv4Mapping; //!< The IPv4 addresses to replace.
+  std::map<Ipv6Address, Ipv6Address> m_ipv6Mapping; //!< The IPv6 addresses to replace.
+  std::vector<struct Source> m_sources;    //!< The files being replayed.
+  Time m_origin;                           //!< The earliest time stamp of the files.
+  Time m_start;                            //!< The start of the replay.
+  EventId m_event;                         //!< The event sending the next packet.
+  Ptr<Socket> m_socket;                    //!< The IPv4 UDP socket.
+  Ptr<Socket> m_socket6;                   //!< The IPv6 UDP socket.
+  uint64_t m_replayed;                     //!< The number of packets sent.
+  uint64_t m_skipped;                      //!< The number of records skipped.
+  std::vector<uint8_t> m_scratch;          //!< The bytes of a remapped packet.
+
+  /// Traced Callback: transmitted packets.
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_H */
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/pcap-writer.h"
+#include "ns3/pcap-replay.h"
+#include "ns3/pcap-replay-helper.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/socket.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Make a captured Ethernet frame holding a UDP datagram.
+ *
+ * \param destination The destination MAC address.
+ * \param source The source IP address.
+ * \param target The destination IP address.
+ * \param port The destination port.
+ * \param size The size of the UDP payload.
+ * \returns The frame.
+ */
+static Ptr<Packet>
+MakeFrame (Mac48Address destination, Ipv4Address source, Ipv4Address target,
+           uint16_t port, uint32_t size)
+{
+  Ptr<Packet> frame = Create<Packet> (size);
+  UdpHeader udp;
+  udp.SetSourcePort (9);
+  udp.SetDestinationPort (port);
+  udp.InitializeChecksum (source, target, 17);
+  udp.EnableChecksums ();
+  frame->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (source);
+  ip.SetDestination (target);
+  ip.SetProtocol (17);
+  ip.SetPayloadSize (frame->GetSize ());
+  ip.SetTtl (64);
+  ip.EnableChecksum ();
+  frame->AddHeader (ip);
+  EthernetHeader ethernet (false);
+  ethernet.SetSource (Mac48Address ("00:00:00:00:00:aa"));
+  ethernet.SetDestination (destination);
+  ethernet.SetLengthType (0x0800);
+  frame->AddHeader (ethernet);
+  return frame;
+}
+
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that the UDP datagrams of two merged captures are sent through
+ * sockets at their scaled time stamps, to the remapped destination.
+ */
+class PcapReplaySocketTestCase : public TestCase
+{
+public:
+  PcapReplaySocketTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a sent packet.
+   * \param packet The packet.
+   */
+  void Tx (Ptr<const Packet> packet);
+  /**
+   * Receive the packets of a socket.
+   * \param socket The socket.
+   */
+  void Receive (Ptr<Socket> socket);
+
+  std::vector<Time> m_txTimes;   //!< The times of the sent packets.
+  std::vector<uint32_t> m_sizes; //!< The sizes of the received packets.
+};
+
+PcapReplaySocketTestCase::PcapReplaySocketTestCase ()
+  : TestCase ("Check the replay of merged captures through sockets")
+{
+}
+
+void
+PcapReplaySocketTestCase::Tx (Ptr<const Packet> packet)
+{
+  m_txTimes.push_back (Simulator::Now ());
+}
+
+void
+PcapReplaySocketTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_sizes.push_back (packet->GetSize ());
+    }
+}
+
+void
+PcapReplaySocketTestCase::DoRun (void)
+{
+  // Two captures interleaved every 5 ms, the second with a TCP segment.
+  Mac48Address mac ("00:00:00:00:00:bb");
+  Ipv4Address source ("192.0.2.1");
+  Ipv4Address target ("192.0.2.2");
+  std::string first = CreateTempDirFilename ("pcap-replay-1.pcap");
+  std::string second = CreateTempDirFilename ("pcap-replay-2.pcapng");
+  {
+    PcapWriter writer;
+    NS_TEST_ASSERT_MSG_EQ (writer.Open (first), true, "Cannot open " << first);
+    writer.AddInterface (1);
+    for (uint32_t i = 0; i < 5; ++i)
+      {
+        writer.Write (0, Seconds (100) + MilliSeconds (10 * i),
+                      MakeFrame (mac, source, target, 5000, 100 + i));
+      }
+    writer.Close ();
+    NS_TEST_ASSERT_MSG_EQ (writer.Open (second, PcapWriter::PCAPNG), true, "Cannot open " << second);
+    writer.AddInterface (1);
+    for (uint32_t i = 0; i < 5; ++i)
+      {
+        writer.Write (0, Seconds (100) + MilliSeconds (10 * i + 5),
+                      MakeFrame (mac, source, target, 5000, 200 + i));
+      }
+    Ptr<Packet> tcp = MakeFrame (mac, source, target, 5000, 10);
+    uint8_t bytes[64];
+    tcp->CopyData (bytes, tcp->GetSize ());
+    bytes[14 + 9] = 6;
+    writer.Write (0, Seconds (100) + MilliSeconds (100), bytes, tcp->GetSize ());
+    writer.Close ();
+  }
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  nodes.Get (0)->AddDevice (txDev);
+  nodes.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel);
+  rxDev->SetChannel (channel);
+  NetDeviceContainer devices;
+  devices.Add (txDev);
+  devices.Add (rxDev);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  sink->SetRecvCallback (MakeCallback (&PcapReplaySocketTestCase::Receive, this));
+
+  PcapReplayHelper helper (first);
+  helper.SetAttribute ("TimeScale", DoubleValue (2));
+  ApplicationContainer apps = helper.Install (nodes.Get (0));
+  Ptr<PcapReplay> replay = DynamicCast<PcapReplay> (apps.Get (0));
+  replay->AddFile (second);
+  replay->AddAddressMapping (target, interfaces.GetAddress (1));
+  replay->TraceConnectWithoutContext ("Tx", MakeCallback (&PcapReplaySocketTestCase::Tx, this));
+  apps.Start (Seconds (1));
+  apps.Stop (Seconds (10));
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (replay->GetNReplayed (), 10, "Wrong number of replayed packets");
+  NS_TEST_EXPECT_MSG_EQ (replay->GetNSkipped (), 1, "The TCP segment should be skipped");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_txTimes.size (), 10, "Wrong number of sent packets");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 10, "Wrong number of received packets");
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_txTimes[i], Seconds (1) + MilliSeconds (10 * i),
+                             "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], ((i % 2 == 0 ? 100U : 200U) + i / 2),
+                             "Wrong size of packet " << i);
+    }
+}
+
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that the frames of a truncated capture are sent by a device,
+ * padded to their length, with checksums still valid after remapping.
+ */
+class PcapReplayDeviceTestCase : public TestCase
+{
+public:
+  PcapReplayDeviceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Receive a packet from the device.
+   * \param device The device.
+   * \param packet The packet.
+   * \param protocol The protocol of the packet.
+   * \param from The sender of the packet.
+   * \returns true.
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from);
+
+  std::vector<Ptr<Packet> > m_packets; //!< The received packets.
+};
+
+PcapReplayDeviceTestCase::PcapReplayDeviceTestCase ()
+  : TestCase ("Check the replay of a capture through a device")
+{
+}
+
+bool
+PcapReplayDeviceTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                   uint16_t protocol, const Address &from)
+{
+  NS_TEST_EXPECT_MSG_EQ (protocol, 0x0800, "Wrong protocol");
+  m_packets.push_back (packet->Copy ());
+  return true;
+}
+
+void
+PcapReplayDeviceTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  txDev->SetAddress (Mac48Address::Allocate ());
+  rxDev->SetAddress (Mac48Address::Allocate ());
+  nodes.Get (0)->AddDevice (txDev);
+  nodes.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel);
+  rxDev->SetChannel (channel);
+  rxDev->SetReceiveCallback (MakeCallback (&PcapReplayDeviceTestCase::Receive, this));
+
+  // Frames truncated to 64 bytes by the capture.
+  Ipv4Address source ("192.0.2.1");
+  Ipv4Address target ("192.0.2.2");
+  std::string filename = CreateTempDirFilename ("pcap-replay-device.pcap");
+  {
+    PcapWriter writer;
+    NS_TEST_ASSERT_MSG_EQ (writer.Open (filename), true, "Cannot open " << filename);
+    writer.AddInterface (1, 64);
+    for (uint32_t i = 0; i < 3; ++i)
+      {
+        writer.Write (0, MilliSeconds (i),
+                      MakeFrame (Mac48Address::ConvertFrom (rxDev->GetAddress ()),
+                                 source, target, 7, 500));
+      }
+    writer.Close ();
+  }
+
+  PcapReplayHelper helper (filename);
+  ApplicationContainer apps = helper.InstallOnDevice (txDev);
+  Ptr<PcapReplay> replay = DynamicCast<PcapReplay> (apps.Get (0));
+  replay->AddAddressMapping (source, Ipv4Address ("10.0.0.1"));
+  replay->AddAddressMapping (target, Ipv4Address ("10.0.0.2"));
+  apps.Start (Seconds (1));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_packets.size (), 3, "Wrong number of received packets");
+  for (uint32_t i = 0; i < m_packets.size (); ++i)
+    {
+      Ptr<Packet> packet = m_packets[i];
+      NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 20 + 8 + 500, "Wrong size of packet " << i);
+      Ipv4Header ip;
+      ip.EnableChecksum ();
+      packet->RemoveHeader (ip);
+      NS_TEST_EXPECT_MSG_EQ (ip.GetSource (), Ipv4Address ("10.0.0.1"), "Wrong source");
+      NS_TEST_EXPECT_MSG_EQ (ip.GetDestination (), Ipv4Address ("10.0.0.2"), "Wrong destination");
+      NS_TEST_EXPECT_MSG_EQ (ip.IsChecksumOk (), true, "Wrong IP checksum of packet " << i);
+      // The zeros padding the truncated payload are those of the capture.
+      UdpHeader udp;
+      udp.InitializeChecksum (ip.GetSource (), ip.GetDestination (), 17);
+      udp.EnableChecksums ();
+      packet->RemoveHeader (udp);
+      NS_TEST_EXPECT_MSG_EQ (udp.IsChecksumOk (), true, "Wrong UDP checksum of packet " << i);
+    }
+}
+
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * PcapReplay TestSuite
+ */
+class PcapReplayTestSuite : public TestSuite
+{
+public:
+  PcapReplayTestSuite ();
+};
+
+PcapReplayTestSuite::PcapReplayTestSuite ()
+  : TestSuite ("pcap-replay", UNIT)
+{
+  AddTestCase (new PcapReplaySocketTestCase, TestCase::QUICK);
+  AddTestCase (new PcapReplayDeviceTestCase, TestCase::QUICK);
+}
+
+static PcapReplayTestSuite g_pcapReplayTestSuite; //!< Static variable for test initialization
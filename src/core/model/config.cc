@@ -18,14 +18,18 @@
  * Authors: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "config.h"
-#include "singleton.h"
+#include "simulation-context.h"
+#include "system-mutex.h"
 #include "object.h"
 #include "global-value.h"
 #include "object-ptr-container.h"
 #include "names.h"
 #include "pointer.h"
+#include "trace-source-accessor.h"
 #include "log.h"
 
+#include <limits>
+#include <map>
 #include <sstream>
 
 /**
@@ -40,6 +44,167 @@ NS_LOG_COMPONENT_DEFINE ("Config");
 
 namespace Config {
 
+/**
+ * \ingroup config-impl
+ * Cache of attribute and trace source lookups by name, indexed by TypeId.
+ *
+ * The attributes and trace sources of a TypeId never change once it is
+ * registered, so the result of a lookup by name can be kept for the
+ * rest of the run.  This replaces the linear walk over the TypeId and
+ * its parents done by ObjectBase for every object on every Config call.
+ */
+class LookupCache : public ContextSingleton<LookupCache>
+{
+public:
+  /** An attribute holding objects reachable from a Config path. */
+  struct Child
+  {
+    std::string name;   //!< The attribute name.
+    bool pointer;       //!< A pointer attribute, rather than a container.
+    bool gettable;      //!< Whether the attribute can be read directly.
+    struct TypeId::AttributeInformation info; //!< The attribute, as found by name.
+  };
+  /** The attributes matching a path element. */
+  typedef std::vector<Child> Children;
+
+  /**
+   * Find the pointer and container attributes matching a path element.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] item The path element, an attribute name or \c *.
+   * \returns The matching attributes, in TypeId then parent order.
+   */
+  const Children & LookupChildren (TypeId tid, std::string item);
+  /**
+   * Set an attribute, as ObjectBase::SetAttribute does.
+   *
+   * \param [in] object The object.
+   * \param [in] name The attribute name.
+   * \param [in] value The value to set.
+   */
+  void SetAttribute (Ptr<Object> object, std::string name, const AttributeValue &value);
+  /**
+   * Find a trace source, as TypeId::LookupTraceSourceByName does.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] name The trace source name.
+   * \returns The trace source accessor, or null if there is none.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (TypeId tid, std::string name);
+
+private:
+  /** Cache key: TypeId uid and name. */
+  typedef std::pair<uint16_t, std::string> Key;
+  /** Result of an attribute lookup by name. */
+  struct Attribute
+  {
+    bool found;         //!< Whether the attribute exists.
+    struct TypeId::AttributeInformation info; //!< The attribute.
+  };
+
+  /** Path element lookups. */
+  std::map<Key, Children> m_children;
+  /** Attribute lookups. */
+  std::map<Key, Attribute> m_attributes;
+  /** Trace source lookups. */
+  std::map<Key, Ptr<const TraceSourceAccessor> > m_traceSources;
+
+};  // class LookupCache
+
+const LookupCache::Children &
+LookupCache::LookupChildren (TypeId tid, std::string item)
+{
+  NS_LOG_FUNCTION (this << tid << item);
+  Key key = std::make_pair (tid.GetUid (), item);
+  std::map<Key, Children>::const_iterator it = m_children.find (key);
+  if (it != m_children.end ())
+    {
+      return it->second;
+    }
+  Children &children = m_children[key];
+  TypeId instanceTid = tid;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          Child child;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              child.pointer = true;
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              child.pointer = false;
+            }
+          else
+            {
+              // this could be anything else and we don't know what to do with it.
+              // So, we just ignore it.
+              continue;
+            }
+          // Getting the attribute by name finds the first one in the
+          // TypeId hierarchy, which may not be this one.
+          child.name = info.name;
+          instanceTid.LookupAttributeByName (info.name, &child.info);
+          child.gettable = (child.info.flags & TypeId::ATTR_GET) &&
+            child.info.accessor->HasGetter ();
+          children.push_back (child);
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return children;
+}
+
+void
+LookupCache::SetAttribute (Ptr<Object> object, std::string name, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << object << name << &value);
+  TypeId tid = object->GetInstanceTypeId ();
+  Key key = std::make_pair (tid.GetUid (), name);
+  std::map<Key, Attribute>::iterator it = m_attributes.find (key);
+  if (it == m_attributes.end ())
+    {
+      Attribute attribute;
+      attribute.found = tid.LookupAttributeByName (name, &attribute.info) &&
+        (attribute.info.flags & TypeId::ATTR_SET) &&
+        attribute.info.accessor->HasSetter ();
+      it = m_attributes.insert (std::make_pair (key, attribute)).first;
+    }
+  if (it->second.found)
+    {
+      const struct TypeId::AttributeInformation &info = it->second.info;
+      Ptr<AttributeValue> v = info.checker->CreateValidValue (value);
+      if (v != 0 && info.accessor->Set (PeekPointer (object), *v))
+        {
+          return;
+        }
+    }
+  // Let ObjectBase report the error.
+  object->SetAttribute (name, value);
+}
+
+Ptr<const TraceSourceAccessor>
+LookupCache::LookupTraceSource (TypeId tid, std::string name)
+{
+  NS_LOG_FUNCTION (this << tid << name);
+  Key key = std::make_pair (tid.GetUid (), name);
+  std::map<Key, Ptr<const TraceSourceAccessor> >::const_iterator it = m_traceSources.find (key);
+  if (it != m_traceSources.end ())
+    {
+      return it->second;
+    }
+  Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName (name);
+  m_traceSources[key] = accessor;
+  return accessor;
+}
+
 MatchContainer::MatchContainer ()
 {
   NS_LOG_FUNCTION (this);
@@ -94,10 +259,10 @@ void
 MatchContainer::Set (std::string name, const AttributeValue &value)
 {
   NS_LOG_FUNCTION (this << name << &value);
+  LookupCache *cache = LookupCache::Get ();
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
-      Ptr<Object> object = *tmp;
-      object->SetAttribute (name, value);
+      cache->SetAttribute (*tmp, name, value);
     }
 }
 void 
@@ -105,22 +270,30 @@ MatchContainer::Connect (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
   NS_ASSERT (m_objects.size () == m_contexts.size ());
+  LookupCache *cache = LookupCache::Get ();
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
-      Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceConnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        cache->LookupTraceSource (m_objects[i]->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->Connect (PeekPointer (m_objects[i]), m_contexts[i] + name, cb);
+        }
     }
 }
 void 
 MatchContainer::ConnectWithoutContext (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
-
+  LookupCache *cache = LookupCache::Get ();
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
-      Ptr<Object> object = *tmp;
-      object->TraceConnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        cache->LookupTraceSource ((*tmp)->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->ConnectWithoutContext (PeekPointer (*tmp), cb);
+        }
     }
 }
 void 
@@ -128,152 +301,166 @@ MatchContainer::Disconnect (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
   NS_ASSERT (m_objects.size () == m_contexts.size ());
+  LookupCache *cache = LookupCache::Get ();
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
-      Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceDisconnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        cache->LookupTraceSource (m_objects[i]->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->Disconnect (PeekPointer (m_objects[i]), m_contexts[i] + name, cb);
+        }
     }
 }
 void 
 MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
+  LookupCache *cache = LookupCache::Get ();
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
-      Ptr<Object> object = *tmp;
-      object->TraceDisconnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        cache->LookupTraceSource ((*tmp)->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->DisconnectWithoutContext (PeekPointer (*tmp), cb);
+        }
     }
 }
 
 
 /**
  * \ingroup config-impl
- * Helper to test if an array entry matches a config path specification.
+ * Convert a string to an \c uint32_t.
+ *
+ * \param [in] str The string.
+ * \param [in] value The location to store the \c uint32_t.
+ * \returns \c true if the string could be converted.
  */
-class ArrayMatcher
-{
-public:
-  /**
-   * Construct from a Config path specification.
-   *
-   * \param [in] element The Config path specification.
-   */
-  ArrayMatcher (std::string element);
-  /**
-   * Test if a specific index matches the Config Path.
-   *
-   * \param [in] i The index.
-   * \returns \c true if the index matches the Config Path.
-   */
-  bool Matches (std::size_t i) const;
-private:
-  /**
-   * Convert a string to an \c uint32_t.
-   *
-   * \param [in] str The string.
-   * \param [in] value The location to store the \c uint32_t.
-   * \returns \c true if the string could be converted.
-   */
-  bool StringToUint32 (std::string str, uint32_t *value) const;
-  /** The Config path element. */
-  std::string m_element;
-
-};  // class ArrayMatcher
-
-
-ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+static bool
+StringToUint32 (std::string str, uint32_t *value)
 {
-  NS_LOG_FUNCTION (this << element);
+  NS_LOG_FUNCTION (str << value);
+  std::istringstream iss;
+  iss.str (str);
+  iss >> (*value);
+  return !iss.bad () && !iss.fail ();
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+
+/**
+ * \ingroup config-impl
+ * Compile an array index element of a Config path into the index
+ * ranges it matches.
+ *
+ * The element is either \c *, an index, an index range \c [min-max],
+ * or several of these separated by \c |.
+ *
+ * \param [in] element The Config path element.
+ * \param [in,out] indices The [min, max] ranges matched by \p element.
+ */
+static void
+CompileArrayElement (std::string element, std::vector<std::pair<uint32_t, uint32_t> > *indices)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (element << indices);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      indices->push_back (std::make_pair (0, std::numeric_limits<uint32_t>::max ()));
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      CompileArrayElement (left, indices);
+      CompileArrayElement (right, indices);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          indices->push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
+      indices->push_back (std::make_pair (value, value));
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-  return false;
 }
 
-bool
-ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
+/**
+ * \ingroup config-impl
+ * Break a Config path into its elements.
+ *
+ * \param [in] path The object part of a Config path.
+ * \param [in,out] segments The compiled path elements.
+ */
+static void
+CompilePath (std::string path, std::vector<Path::Segment> *segments)
 {
-  NS_LOG_FUNCTION (this << str << value);
-  std::istringstream iss;
-  iss.str (str);
-  iss >> (*value);
-  return !iss.bad () && !iss.fail ();
+  NS_LOG_FUNCTION (path << segments);
+
+  // ensure that we start and end with a '/'
+  std::string::size_type tmp = path.find ("/");
+  if (tmp != 0)
+    {
+      // no slash at start
+      path = "/" + path;
+    }
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
+    {
+      // no slash at end
+      path = path + "/";
+    }
+
+  std::string::size_type cur = 0;
+  std::string::size_type next = path.find ("/", 1);
+  while (next != std::string::npos)
+    {
+      Path::Segment segment;
+      segment.item = path.substr (cur + 1, next - (cur + 1));
+      segment.names = segment.item.compare (0, 5, "Names") == 0;
+      segment.getObject = segment.item.find ("$") == 0;
+      segment.tidFound = false;
+      if (segment.getObject)
+        {
+          std::string tidString = segment.item.substr (1, segment.item.size () - 1);
+          segment.tidFound = TypeId::LookupByNameFailSafe (tidString, &segment.tid);
+        }
+      CompileArrayElement (segment.item, &segment.indices);
+      segments->push_back (segment);
+      cur = next;
+      next = path.find ("/", cur + 1);
+    }
 }
 
 /**
  * \ingroup config-impl
- * Abstract class to parse Config paths into object references.
+ * Abstract class to resolve compiled Config paths into object references.
  */
 class Resolver
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from a compiled Config path.
    *
-   * \param [in] path The Config path.
+   * \param [in] segments The compiled Config path.
    */
-  Resolver (std::string path);
+  Resolver (const std::vector<Path::Segment> &segments);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -287,23 +474,21 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
-   * Parse the next element in the Config path.
+   * Resolve the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] index The index of the next element.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t index, Ptr<Object> root);
   /**
-   * Parse an index on the Config path.
+   * Resolve an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] index The index of the array index element.
+   * \param [in] container The objects to select from.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t index, const ObjectPtrContainerValue &container);
   /**
    * Handle one object found on the path.
    *
@@ -326,47 +511,27 @@ private:
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The compiled Config path. */
+  const std::vector<Path::Segment> &m_segments;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (const std::vector<Path::Segment> &segments)
+  : m_segments (segments)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << &segments);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -392,13 +557,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (std::size_t index, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << index << root);
 
-  if (next == std::string::npos)
+  if (index == m_segments.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +577,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const Path::Segment &segment = m_segments[index];
+  const std::string &item = segment.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -426,11 +589,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (segment.names)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (index + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -447,7 +609,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (index + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -463,13 +625,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (segment.getObject)
     {
       // This is a call to GetObject
       std::string tidString = item.substr (1, item.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      TypeId tid = segment.tidFound ? segment.tid : TypeId::LookupByName (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
@@ -477,69 +638,51 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (index + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const LookupCache::Children &children =
+        LookupCache::Get ()->LookupChildren (root->GetInstanceTypeId (), item);
+      for (LookupCache::Children::const_iterator i = children.begin (); i != children.end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (i->pointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              if (!i->gettable || !i->info.accessor->Get (PeekPointer (root), pValue))
                 {
-                  continue;
+                  root->GetAttribute (i->name, pValue);
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
+                  continue;
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              m_workStack.push_back (i->name);
+              DoResolve (index + 1, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              ObjectPtrContainerValue vector;
+              if (!i->gettable || !i->info.accessor->Get (PeekPointer (root), vector))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  root->GetAttribute (i->name, vector);
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (i->name);
+              DoArrayResolve (index + 1, vector);
+              m_workStack.pop_back ();
             }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
+      if (children.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -548,30 +691,29 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t index, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << index << &container);
+  if (index == m_segments.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const std::vector<std::pair<uint32_t, uint32_t> > &indices = m_segments[index].indices;
 
-  ArrayMatcher matcher = ArrayMatcher (item);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
-      if (matcher.Matches ((*it).first))
+      for (std::size_t j = 0; j < indices.size (); ++j)
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          if ((*it).first >= indices[j].first && (*it).first <= indices[j].second)
+            {
+              std::ostringstream oss;
+              oss << (*it).first;
+              m_workStack.push_back (oss.str ());
+              DoResolve (index + 1, (*it).second);
+              m_workStack.pop_back ();
+              break;
+            }
         }
     }
 }
@@ -579,8 +721,11 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
 /**
  * \ingroup config-impl
  * Config system implementation class.
+ *
+ * There is one per SimulationContext, so each context has its own
+ * root namespace.
  */
-class ConfigImpl : public Singleton<ConfigImpl>
+class ConfigImpl : public ContextSingleton<ConfigImpl>
 {
 public:
   /** \copydoc Config::Set() */
@@ -595,6 +740,35 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * Find the objects matching a compiled Config path.
+   *
+   * \param [in] path The Config path.
+   * \param [in] segments The compiled \p path.
+   * \returns A container which contains all the objects which match
+   *          the input path.
+   */
+  MatchContainer LookupMatches (std::string path, const std::vector<Path::Segment> &segments);
+  /**
+   * Break a Config path into the leading path and the last leaf token.
+   * \param [in] path The Config path.
+   * \param [in,out] root The leading part of the \p path,
+   *   up to the final slash.
+   * \param [in,out] leaf The trailing part of the \p path.
+   */
+  void ParsePath (std::string path, std::string *root, std::string *leaf) const;
+
+  /** \copydoc Config::InvalidateMatchCache() */
+  void InvalidateMatchCache (void);
+  /**
+   * Get the current match cache generation.
+   *
+   * Generations are unique across all the ConfigImpl instances, so that
+   * a Path memoized in one SimulationContext is not reused in another.
+   *
+   * \returns The current match cache generation.
+   */
+  uint64_t GetGeneration (void) const;
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -606,24 +780,41 @@ public:
   /** \copydoc Config::GetRootNamespaceObject() */
   Ptr<Object> GetRootNamespaceObject (std::size_t i) const;
 
-private:
-  /**
-   * Break a Config path into the leading path and the last leaf token.
-   * \param [in] path The Config path.
-   * \param [in,out] root The leading part of the \p path,
-   *   up to the final slash.
-   * \param [in,out] leaf The trailing part of the \p path.
-   */
-  void ParsePath (std::string path, std::string *root, std::string *leaf) const;
+  /** Constructor. */
+  ConfigImpl ();
 
+private:
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /**
+   * Allocate a new match cache generation.
+   * \returns A generation never returned before.
+   */
+  static uint64_t AllocateGeneration (void);
+
+  /** The match cache generation. */
+  uint64_t m_generation;
 
 };  // class ConfigImpl
 
+ConfigImpl::ConfigImpl ()
+  : m_generation (AllocateGeneration ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+ConfigImpl::AllocateGeneration (void)
+{
+  static SystemMutex mutex;
+  static uint64_t next = 1;
+  CriticalSection critical (mutex);
+  return next++;
+}
+
 void 
 ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
 {
@@ -640,60 +831,51 @@ void
 ConfigImpl::Set (std::string path, const AttributeValue &value)
 {
   NS_LOG_FUNCTION (this << path << &value);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.Set (leaf, value);
+  Path (path).Set (value);
 }
 void 
 ConfigImpl::ConnectWithoutContext (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.ConnectWithoutContext (leaf, cb);
+  Path (path).ConnectWithoutContext (cb);
 }
 void 
 ConfigImpl::DisconnectWithoutContext (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.DisconnectWithoutContext (leaf, cb);
+  Path (path).DisconnectWithoutContext (cb);
 }
 void 
 ConfigImpl::Connect (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.Connect (leaf, cb);
+  Path (path).Connect (cb);
 }
 void 
 ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.Disconnect (leaf, cb);
+  Path (path).Disconnect (cb);
 }
 
 MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  std::vector<Path::Segment> segments;
+  CompilePath (path, &segments);
+  return LookupMatches (path, segments);
+}
+
+MatchContainer 
+ConfigImpl::LookupMatches (std::string path, const std::vector<Path::Segment> &segments)
+{
+  NS_LOG_FUNCTION (this << path << &segments);
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const std::vector<Path::Segment> &segments)
+      : Resolver (segments)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path)
     {
@@ -702,7 +884,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (segments);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -718,11 +900,25 @@ ConfigImpl::LookupMatches (std::string path)
   return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
 }
 
+void
+ConfigImpl::InvalidateMatchCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_generation = AllocateGeneration ();
+}
+
+uint64_t
+ConfigImpl::GetGeneration (void) const
+{
+  return m_generation;
+}
+
 void 
 ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  InvalidateMatchCache ();
 }
 
 void 
@@ -735,6 +931,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          InvalidateMatchCache ();
           return;
         }
     }
@@ -881,6 +1078,112 @@ Ptr<Object> GetRootNamespaceObject (uint32_t i)
   return ConfigImpl::Get ()->GetRootNamespaceObject (i);
 }
 
+void InvalidateMatchCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->InvalidateMatchCache ();
+}
+
+
+Path::Path ()
+  : m_memoize (false),
+    m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Path::Path (std::string path)
+  : m_path (path),
+    m_memoize (false),
+    m_generation (0)
+{
+  NS_LOG_FUNCTION (this << path);
+  ConfigImpl::Get ()->ParsePath (path, &m_root, &m_leaf);
+  CompilePath (m_root, &m_segments);
+}
+
+std::string
+Path::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path;
+}
+
+void
+Path::SetMemoize (bool memoize)
+{
+  NS_LOG_FUNCTION (this << memoize);
+  m_memoize = memoize;
+  if (!memoize)
+    {
+      m_matches = MatchContainer ();
+      m_generation = 0;
+    }
+}
+
+bool
+Path::GetMemoize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_memoize;
+}
+
+MatchContainer
+Path::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_path.empty ())
+    {
+      return MatchContainer ();
+    }
+  ConfigImpl *impl = ConfigImpl::Get ();
+  if (!m_memoize)
+    {
+      return impl->LookupMatches (m_root, m_segments);
+    }
+  if (m_generation != impl->GetGeneration ())
+    {
+      m_matches = impl->LookupMatches (m_root, m_segments);
+      m_generation = impl->GetGeneration ();
+    }
+  return m_matches;
+}
+
+void
+Path::Set (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  LookupMatches ().Set (m_leaf, value);
+}
+
+void
+Path::Connect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupMatches ().Connect (m_leaf, cb);
+}
+
+void
+Path::ConnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupMatches ().ConnectWithoutContext (m_leaf, cb);
+}
+
+void
+Path::Disconnect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupMatches ().Disconnect (m_leaf, cb);
+}
+
+void
+Path::DisconnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupMatches ().DisconnectWithoutContext (m_leaf, cb);
+}
+
 } // namespace Config
 
 } // namespace ns3
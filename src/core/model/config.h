@@ -21,8 +21,10 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "type-id.h"
 #include <string>
 #include <vector>
+#include <utility>
 
 /**
  * \file
@@ -287,6 +289,129 @@ std::size_t GetRootNamespaceObjectN (void);
  */
 Ptr<Object> GetRootNamespaceObject (uint32_t i);
 
+/**
+ * \ingroup config
+ * Invalidate the match sets memoized by Config::Path objects.
+ *
+ * This is called by the code which changes the object graph seen
+ * by Config paths: Config::RegisterRootNamespaceObject, Names::Add,
+ * Object::AggregateObject, NodeList::Add, ChannelList::Add,
+ * Node::AddDevice and Node::AddApplication.  Code changing the graph
+ * by other means, e.g. by replacing an object held in a pointer
+ * attribute, should call this if memoized paths may traverse the change.
+ */
+void InvalidateMatchCache (void);
+
+/**
+ * \ingroup config
+ * A Config path compiled for repeated use.
+ *
+ * Config::Set, Config::Connect and friends parse their path string on
+ * every call.  A Path parses it once, resolving the \c $TypeId elements
+ * and array index expressions up front, so that scenarios which apply
+ * the same path many times (or to many nodes) pay only for the object
+ * graph walk.  Attribute and trace source lookups by name are served
+ * from a cache indexed by TypeId, shared with the functions above.
+ *
+ * When memoization is enabled, the set of objects matching the path is
+ * also kept across calls, until Config::InvalidateMatchCache is called.
+ *
+ * \code
+ *   Config::Path path ("/NodeList/[0-99]/DeviceList/0/$ns3::WifiNetDevice/Phy/PhyTxBegin");
+ *   path.ConnectWithoutContext (MakeCallback (&PhyTxBegin));
+ * \endcode
+ */
+class Path
+{
+public:
+  /** Create an empty path, which matches nothing. */
+  Path ();
+  /**
+   * Compile a path.
+   *
+   * \param [in] path A Config path, whose last element is the
+   *                  attribute or trace source name.
+   */
+  Path (std::string path);
+
+  /**
+   * \returns The path this object was compiled from.
+   */
+  std::string GetPath (void) const;
+  /**
+   * Enable or disable memoization of the match set.
+   *
+   * \param [in] memoize Whether to keep the matching objects across calls.
+   */
+  void SetMemoize (bool memoize);
+  /**
+   * \returns Whether the match set is memoized.
+   */
+  bool GetMemoize (void) const;
+
+  /**
+   * Find the objects holding the attribute or trace source named by
+   * the last path element.
+   *
+   * \returns A container of the objects matching the path, less its
+   *          last element.
+   */
+  MatchContainer LookupMatches (void) const;
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \sa Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param [in] cb The sink to connect to all matching trace sources.
+   * \sa Config::Connect
+   */
+  void Connect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to connect to all matching trace sources.
+   * \sa Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to disconnect from all matching trace sources.
+   * \sa Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to disconnect from all matching trace sources.
+   * \sa Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb) const;
+
+  /** A pre-parsed element of the object part of a path. */
+  struct Segment
+  {
+    std::string item;       //!< The path element.
+    bool names;             //!< The element starts with "Names".
+    bool getObject;         //!< The element is a \c $TypeId.
+    bool tidFound;          //!< The \c $TypeId element names a registered TypeId.
+    TypeId tid;             //!< The TypeId of a \c $TypeId element.
+    /** The [min, max] index ranges matched by the element, if an array index. */
+    std::vector<std::pair<uint32_t, uint32_t> > indices;
+  };
+
+private:
+  /** The path this object was compiled from. */
+  std::string m_path;
+  /** The object part of the path, canonicalized. */
+  std::string m_root;
+  /** The attribute or trace source name. */
+  std::string m_leaf;
+  /** The parsed object part of the path. */
+  std::vector<Segment> m_segments;
+  /** Whether to memoize the match set. */
+  bool m_memoize;
+  /** The memoized match set. */
+  mutable MatchContainer m_matches;
+  /** The InvalidateMatchCache generation of #m_matches; zero if none. */
+  mutable uint64_t m_generation;
+};
+
 } // namespace Config
 
 } // namespace ns3
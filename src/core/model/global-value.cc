@@ -22,8 +22,11 @@
 #include "attribute.h"
 #include "string.h"
 #include "uinteger.h"
+#include "simulation-context.h"
 #include "log.h"
 
+#include <map>
+
 #include "ns3/core-config.h"
 #ifdef HAVE_STDLIB_H
 #include <cstdlib>
@@ -39,6 +42,21 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalValue");
 
+namespace {
+
+/**
+ * \ingroup core
+ * The GlobalValue values set in a SimulationContext other than
+ * the default one.
+ */
+struct ContextValues
+{
+  /** The values, by GlobalValue. */
+  std::map<const GlobalValue *, Ptr<AttributeValue> > values;
+};
+
+} // anonymous namespace
+
 GlobalValue::GlobalValue (std::string name, std::string help,
                           const AttributeValue &initialValue,
                           Ptr<const AttributeChecker> checker)
@@ -117,7 +135,8 @@ void
 GlobalValue::GetValue (AttributeValue &value) const
 {
   NS_LOG_FUNCTION (&value);
-  bool ok = m_checker->Copy (*m_currentValue, value);
+  Ptr<AttributeValue> current = GetCurrentValue ();
+  bool ok = m_checker->Copy (*current, value);
   if (ok)
     {
       return;
@@ -127,7 +146,7 @@ GlobalValue::GetValue (AttributeValue &value) const
     {
       NS_FATAL_ERROR ("GlobalValue name="<<m_name<<": input value is not a string");
     }
-  str->Set (m_currentValue->SerializeToString (m_checker));
+  str->Set (current->SerializeToString (m_checker));
 }
 Ptr<const AttributeChecker> 
 GlobalValue::GetChecker (void) const
@@ -147,7 +166,7 @@ GlobalValue::SetValue (const AttributeValue &value)
     {
       return 0;
     }
-  m_currentValue = v;
+  SetCurrentValue (v);
   return true;
 }
 
@@ -201,7 +220,38 @@ void
 GlobalValue::ResetInitialValue (void)
 {
   NS_LOG_FUNCTION (this);
-  m_currentValue = m_initialValue;
+  SetCurrentValue (m_initialValue);
+}
+
+Ptr<AttributeValue>
+GlobalValue::GetCurrentValue (void) const
+{
+  SimulationContext *context = SimulationContext::GetCurrent ();
+  if (!context->IsDefault ())
+    {
+      ContextValues *values = context->GetInstance<ContextValues> ();
+      std::map<const GlobalValue *, Ptr<AttributeValue> >::const_iterator i =
+        values->values.find (this);
+      if (i != values->values.end ())
+        {
+          return i->second;
+        }
+    }
+  return m_currentValue;
+}
+
+void
+GlobalValue::SetCurrentValue (Ptr<AttributeValue> value)
+{
+  SimulationContext *context = SimulationContext::GetCurrent ();
+  if (context->IsDefault ())
+    {
+      m_currentValue = value;
+    }
+  else
+    {
+      context->GetInstance<ContextValues> ()->values[this] = value;
+    }
 }
 
 bool
@@ -69,6 +69,10 @@ namespace ns3 {
  * Users of the CommandLine class also get the ability to set global 
  * values through command line arguments to their program:
  * \c --Name=Value will set global value \c Name to \c Value.
+ *
+ * Values set while a SimulationContext other than the default one is
+ * current are only seen by that context; until then, it sees the
+ * values of the default context.
  */
 class GlobalValue
 {
@@ -195,6 +199,16 @@ private:
   static Vector *GetVector (void);
   /** Initialize from the \c NS_GLOBAL_VALUE environment variable. */
   void InitializeFromEnv (void);
+  /**
+   * Get the current value in the current SimulationContext.
+   * \returns The current value.
+   */
+  Ptr<AttributeValue> GetCurrentValue (void) const;
+  /**
+   * Set the current value in the current SimulationContext.
+   * \param [in] value The new value.
+   */
+  void SetCurrentValue (Ptr<AttributeValue> value);
 
   /** The name of this GlobalValue. */
   std::string m_name;
@@ -202,7 +216,7 @@ private:
   std::string m_help;
   /** The initial value. */
   Ptr<AttributeValue> m_initialValue;
-  /** The current value. */
+  /** The current value in the default SimulationContext. */
   Ptr<AttributeValue> m_currentValue;
   /** The AttributeChecker for this GlobalValue. */
   Ptr<const AttributeChecker> m_checker;
@@ -0,0 +1,381 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ctime>       // clock_gettime, nanosleep
+#include <algorithm>   // std::max
+
+#if defined (__linux__)
+#include <pthread.h>   // pthread_setaffinity_np
+#include <sched.h>     // cpu_set_t
+#endif
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h> // __rdtsc, _mm_pause
+#define NS3_HAVE_TSC 1
+#endif
+
+#include "log.h"
+#include "boolean.h"
+#include "integer.h"
+#include "uinteger.h"
+#include "system-condition.h"
+
+#include "hybrid-wall-clock-synchronizer.h"
+
+/**
+ * \file
+ * \ingroup realtime
+ * ns3::HybridWallClockSynchronizer implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HybridWallClockSynchronizer");
+
+NS_OBJECT_ENSURE_REGISTERED (HybridWallClockSynchronizer);
+
+TypeId
+HybridWallClockSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HybridWallClockSynchronizer")
+    .SetParent<WallClockSynchronizer> ()
+    .SetGroupName ("Core")
+    .AddConstructor<HybridWallClockSynchronizer> ()
+    .AddAttribute ("SpinThreshold",
+                   "Time before the target at which to stop sleeping and "
+                   "start busy-waiting.  Zero calibrates the threshold "
+                   "from the measured sleep overshoot.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&HybridWallClockSynchronizer::m_spinThresholdAttribute),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("CalibrationSamples",
+                   "Number of sleeps measured to calibrate the spin threshold.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&HybridWallClockSynchronizer::m_calibrationSamples),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("CpuAffinity",
+                   "The CPU to pin the simulator thread to, or -1 to leave "
+                   "it unpinned (only supported on Linux).",
+                   IntegerValue (-1),
+                   MakeIntegerAccessor (&HybridWallClockSynchronizer::m_cpuAffinity),
+                   MakeIntegerChecker<int32_t> (-1))
+    .AddAttribute ("UseTsc",
+                   "Read the CPU timestamp counter instead of the system "
+                   "monotonic clock (only supported on x86).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HybridWallClockSynchronizer::m_useTsc),
+                   MakeBooleanChecker ())
+    .AddAttribute ("JitterBinWidth",
+                   "Width of a bin of the jitter histogram.",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&HybridWallClockSynchronizer::m_jitterBinWidth),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("JitterBins",
+                   "Number of bins of the jitter histogram.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&HybridWallClockSynchronizer::m_jitterBins),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Jitter",
+                     "How late each completed wait returned.",
+                     MakeTraceSourceAccessor (&HybridWallClockSynchronizer::m_jitterTrace),
+                     "ns3::Time::TracedCallback")
+  ;
+  return tid;
+}
+
+HybridWallClockSynchronizer::HybridWallClockSynchronizer ()
+  : m_spinThreshold (0),
+    m_tscEnabled (false),
+    m_tscBase (0),
+    m_tscBaseNs (0),
+    m_nsPerTick (0),
+    m_jitterSamples (0),
+    m_jitterSum (0),
+    m_jitterMax (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HybridWallClockSynchronizer::~HybridWallClockSynchronizer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+HybridWallClockSynchronizer::GetSpinThreshold (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_spinThreshold;
+}
+
+std::vector<uint64_t>
+HybridWallClockSynchronizer::GetJitterHistogram (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_jitterHistogram;
+}
+
+uint64_t
+HybridWallClockSynchronizer::GetJitterSamples (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_jitterSamples;
+}
+
+Time
+HybridWallClockSynchronizer::GetMaxJitter (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return NanoSeconds (m_jitterMax);
+}
+
+Time
+HybridWallClockSynchronizer::GetMeanJitter (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_jitterSamples == 0)
+    {
+      return Seconds (0);
+    }
+  return NanoSeconds (m_jitterSum / m_jitterSamples);
+}
+
+void
+HybridWallClockSynchronizer::ResetJitterHistogram (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_jitterHistogram.assign (m_jitterBins, 0);
+  m_jitterSamples = 0;
+  m_jitterSum = 0;
+  m_jitterMax = 0;
+}
+
+void
+HybridWallClockSynchronizer::DoSetOrigin (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+//
+// SetOrigin is called by RealtimeSimulatorImpl::Run in the simulator
+// thread, so this is where we can pin that thread.  Calibration has to
+// happen afterwards, since migrating to another CPU changes what we
+// measure.
+//
+  if (m_cpuAffinity >= 0)
+    {
+      SetThreadAffinity ();
+    }
+  if (m_useTsc && !m_tscEnabled)
+    {
+      CalibrateTsc ();
+    }
+  if (m_spinThresholdAttribute.IsZero ())
+    {
+      CalibrateSpinThreshold ();
+    }
+  else
+    {
+      m_spinThreshold = m_spinThresholdAttribute.GetNanoSeconds ();
+    }
+  NS_LOG_INFO ("Spin threshold is " << m_spinThreshold << " ns");
+
+  if (m_jitterHistogram.size () != m_jitterBins)
+    {
+      ResetJitterHistogram ();
+    }
+  WallClockSynchronizer::DoSetOrigin (ns);
+}
+
+bool
+HybridWallClockSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
+{
+  NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+//
+// Rather than correcting the delay for drift and sleeping in jiffies, we
+// aim directly at the normalized real time at which the next event is due.
+// If we are already past it there is nothing to do.
+//
+  uint64_t nsTarget = nsCurrent + nsDelay;
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow >= nsTarget)
+    {
+      RecordJitter (nsNow - nsTarget);
+      return true;
+    }
+//
+// Sleep until the spin threshold before the target.  The threshold is at
+// least the worst oversleep we measured, so we should wake up early; the
+// remainder is covered by the spin below.
+//
+  uint64_t nsLeft = nsTarget - nsNow;
+  if (nsLeft > m_spinThreshold)
+    {
+      NS_LOG_INFO ("SleepWait for " << nsLeft - m_spinThreshold << " ns");
+      if (SleepWait (nsLeft - m_spinThreshold) == false)
+        {
+          NS_LOG_INFO ("SleepWait interrupted");
+          return false;
+        }
+    }
+  NS_LOG_INFO ("SpinWait until " << nsTarget);
+  if (RelaxedSpinWait (nsTarget) == false)
+    {
+      return false;
+    }
+  RecordJitter (GetNormalizedRealtime () - nsTarget);
+  return true;
+}
+
+uint64_t
+HybridWallClockSynchronizer::GetRealtime (void)
+{
+#ifdef NS3_HAVE_TSC
+  if (m_tscEnabled)
+    {
+      uint64_t ticks = __rdtsc () - m_tscBase;
+      return m_tscBaseNs + static_cast<uint64_t> (ticks * m_nsPerTick);
+    }
+#endif
+  return GetMonotonicRealtime ();
+}
+
+bool
+HybridWallClockSynchronizer::RelaxedSpinWait (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  for (;;)
+    {
+      if (GetNormalizedRealtime () >= ns)
+        {
+          return true;
+        }
+      if (m_condition.GetCondition ())
+        {
+          return false;
+        }
+#ifdef NS3_HAVE_TSC
+      // Let a sibling hyperthread run while we wait.
+      _mm_pause ();
+#endif
+    }
+  // Quiet compiler
+  return true;
+}
+
+void
+HybridWallClockSynchronizer::SetThreadAffinity (void)
+{
+  NS_LOG_FUNCTION (this);
+#if defined (__linux__)
+  cpu_set_t cpus;
+  CPU_ZERO (&cpus);
+  CPU_SET (m_cpuAffinity, &cpus);
+  int rc = pthread_setaffinity_np (pthread_self (), sizeof (cpus), &cpus);
+  if (rc != 0)
+    {
+      NS_LOG_WARN ("Could not pin simulator thread to CPU " << m_cpuAffinity
+                   << " (error " << rc << ")");
+    }
+  else
+    {
+      NS_LOG_INFO ("Pinned simulator thread to CPU " << m_cpuAffinity);
+    }
+#else
+  NS_LOG_WARN ("CpuAffinity is not supported on this platform");
+#endif
+}
+
+void
+HybridWallClockSynchronizer::CalibrateTsc (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef NS3_HAVE_TSC
+//
+// Count timestamp counter ticks over a 20 ms interval of the monotonic
+// clock.  The relative error of the resulting rate is about the clock read
+// cost over the interval, i.e. well below a part per million.
+//
+  uint64_t ns0 = GetMonotonicRealtime ();
+  uint64_t tsc0 = __rdtsc ();
+  struct timespec ts = { 0, 20000000 };
+  nanosleep (&ts, NULL);
+  uint64_t ns1 = GetMonotonicRealtime ();
+  uint64_t tsc1 = __rdtsc ();
+  if (tsc1 <= tsc0 || ns1 <= ns0)
+    {
+      NS_LOG_WARN ("Timestamp counter is not usable; using the system clock");
+      return;
+    }
+  m_nsPerTick = static_cast<double> (ns1 - ns0) / (tsc1 - tsc0);
+  m_tscBase = tsc1;
+  m_tscBaseNs = ns1;
+  m_tscEnabled = true;
+  NS_LOG_INFO ("Timestamp counter runs at " << 1.0 / m_nsPerTick << " GHz");
+#else
+  NS_LOG_WARN ("UseTsc is not supported on this platform");
+#endif
+}
+
+void
+HybridWallClockSynchronizer::CalibrateSpinThreshold (void)
+{
+  NS_LOG_FUNCTION (this);
+//
+// Sleep the way SleepWait does, for a jiffy or 100 us, whichever is longer,
+// and keep the worst oversleep.  Twice that, to leave some margin for an
+// unlucky wakeup, is how early we need to stop sleeping to come back in time.
+//
+  SystemCondition condition;
+  uint64_t nsSleep = std::max<uint64_t> (m_jiffy, 100000);
+  uint64_t nsWorst = 0;
+  for (uint32_t i = 0; i < m_calibrationSamples; ++i)
+    {
+      uint64_t nsStart = GetRealtime ();
+      condition.TimedWait (nsSleep);
+      uint64_t nsSlept = GetRealtime () - nsStart;
+      if (nsSlept > nsSleep)
+        {
+          nsWorst = std::max (nsWorst, nsSlept - nsSleep);
+        }
+    }
+  m_spinThreshold = 2 * nsWorst;
+  NS_LOG_INFO ("Worst oversleep is " << nsWorst << " ns");
+}
+
+uint64_t
+HybridWallClockSynchronizer::GetMonotonicRealtime (void) const
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+void
+HybridWallClockSynchronizer::RecordJitter (uint64_t nsLate)
+{
+  NS_LOG_FUNCTION (this << nsLate);
+  uint64_t bin = nsLate / m_jitterBinWidth.GetNanoSeconds ();
+  if (bin >= m_jitterHistogram.size ())
+    {
+      bin = m_jitterHistogram.size () - 1;
+    }
+  ++m_jitterHistogram[bin];
+  ++m_jitterSamples;
+  m_jitterSum += nsLate;
+  m_jitterMax = std::max (m_jitterMax, nsLate);
+  m_jitterTrace (NanoSeconds (nsLate));
+}
+
+} // namespace ns3
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HYBRID_WALL_CLOCK_SYNCHRONIZER_H
+#define HYBRID_WALL_CLOCK_SYNCHRONIZER_H
+
+#include "wall-clock-synchronizer.h"
+#include "nstime.h"
+#include "traced-callback.h"
+
+#include <vector>
+
+/**
+ * @file
+ * @ingroup realtime
+ * ns3::HybridWallClockSynchronizer declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup realtime
+ * @brief Low-jitter wall clock synchronizer combining a short sleep
+ * with a calibrated busy-wait.
+ *
+ * The WallClockSynchronizer sleeps in whole jiffies and only busy-waits
+ * for the last few of them, reading the wall clock through
+ * @c gettimeofday.  On emulation setups this yields jitter in the
+ * hundreds of microseconds.  This synchronizer instead:
+ *
+ *   - reads a monotonic nanosecond clock (@c CLOCK_MONOTONIC), or the
+ *     CPU timestamp counter when @c UseTsc is set and the platform
+ *     supports it;
+ *   - sleeps until @c SpinThreshold before the target time and then
+ *     busy-waits, so that the (late-biased) wakeup error of the sleep
+ *     is absorbed by the spin.  If @c SpinThreshold is zero, the
+ *     threshold is calibrated at SetOrigin () time by measuring the
+ *     worst observed oversleep of @c CalibrationSamples short sleeps;
+ *   - optionally pins the simulator thread to the CPU given by
+ *     @c CpuAffinity (Linux only);
+ *   - records the lateness of every completed wait in a histogram and
+ *     reports it through the @c Jitter trace source.
+ *
+ * External events still interrupt both the sleep and the spin through
+ * the SystemCondition inherited from WallClockSynchronizer, since a
+ * newly scheduled event may be earlier than the one we are waiting for.
+ *
+ * It is selected through the RealtimeSimulatorImpl @c SynchronizerType
+ * attribute:
+ *
+ * @code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::RealtimeSimulatorImpl"));
+ *   Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+ *                       TypeIdValue (HybridWallClockSynchronizer::GetTypeId ()));
+ * @endcode
+ *
+ * @note The TSC clock assumes an invariant timestamp counter which is
+ * synchronized across cores, as found on current x86 processors.
+ * It is ignored on other architectures.
+ */
+class HybridWallClockSynchronizer : public WallClockSynchronizer
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * @returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  HybridWallClockSynchronizer ();
+  /** Destructor. */
+  virtual ~HybridWallClockSynchronizer ();
+
+  /**
+   * @brief Get the spin threshold in use.
+   *
+   * This is either the @c SpinThreshold attribute or, if that is zero,
+   * the value calibrated by the last call to SetOrigin ().
+   *
+   * @returns The spin threshold, in ns.
+   */
+  uint64_t GetSpinThreshold (void) const;
+
+  /**
+   * @brief Get the jitter histogram.
+   *
+   * Bin @c i counts the waits which completed between
+   * <tt>i * JitterBinWidth</tt> and <tt>(i + 1) * JitterBinWidth</tt>
+   * after their target time; the last bin also counts all later ones.
+   *
+   * @returns The jitter histogram.
+   */
+  std::vector<uint64_t> GetJitterHistogram (void) const;
+  /**
+   * @brief Get the number of jitter samples recorded.
+   * @returns The number of completed waits since the last reset.
+   */
+  uint64_t GetJitterSamples (void) const;
+  /**
+   * @brief Get the largest jitter recorded.
+   * @returns The largest lateness observed since the last reset.
+   */
+  Time GetMaxJitter (void) const;
+  /**
+   * @brief Get the mean jitter recorded.
+   * @returns The mean lateness observed since the last reset.
+   */
+  Time GetMeanJitter (void) const;
+  /** Clear the jitter histogram and statistics. */
+  void ResetJitterHistogram (void);
+
+protected:
+  // Inherited from WallClockSynchronizer
+  virtual void DoSetOrigin (uint64_t ns);
+  virtual bool DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay);
+  virtual uint64_t GetRealtime (void);
+
+private:
+  /**
+   * @brief Busy-wait until the normalized real time reaches @p ns,
+   * relaxing the CPU between clock reads.
+   *
+   * @param [in] ns The target normalized real time.
+   * @returns @c true if we reached the target time,
+   *          @c false if we returned because the condition was set.
+   */
+  bool RelaxedSpinWait (uint64_t ns);
+  /** Pin the calling thread to the CPU given by #m_cpuAffinity. */
+  void SetThreadAffinity (void);
+  /** Measure the TSC frequency against the monotonic clock. */
+  void CalibrateTsc (void);
+  /** Measure the sleep overshoot and derive #m_spinThreshold. */
+  void CalibrateSpinThreshold (void);
+  /**
+   * Read the monotonic system clock.
+   * @returns The monotonic clock, in ns.
+   */
+  uint64_t GetMonotonicRealtime (void) const;
+  /**
+   * Account for a completed wait.
+   * @param [in] nsLate How late the wait completed, in ns.
+   */
+  void RecordJitter (uint64_t nsLate);
+
+  /** The configured spin threshold; zero asks for calibration. */
+  Time m_spinThresholdAttribute;
+  /** The spin threshold in use, in ns. */
+  uint64_t m_spinThreshold;
+  /** Number of sleeps measured by CalibrateSpinThreshold. */
+  uint32_t m_calibrationSamples;
+  /** The CPU to pin the simulator thread to, or -1. */
+  int32_t m_cpuAffinity;
+  /** Read the timestamp counter instead of the system clock. */
+  bool m_useTsc;
+  /** Whether the timestamp counter was calibrated and is in use. */
+  bool m_tscEnabled;
+  /** Timestamp counter value at calibration time. */
+  uint64_t m_tscBase;
+  /** Monotonic clock value at calibration time, in ns. */
+  uint64_t m_tscBaseNs;
+  /** Nanoseconds per timestamp counter tick. */
+  double m_nsPerTick;
+
+  /** Width of a jitter histogram bin. */
+  Time m_jitterBinWidth;
+  /** Number of jitter histogram bins. */
+  uint32_t m_jitterBins;
+  /** The jitter histogram. */
+  std::vector<uint64_t> m_jitterHistogram;
+  /** Number of recorded jitter samples. */
+  uint64_t m_jitterSamples;
+  /** Sum of the recorded jitter samples, in ns. */
+  uint64_t m_jitterSum;
+  /** Largest recorded jitter sample, in ns. */
+  uint64_t m_jitterMax;
+  /** Trace fired with the lateness of every completed wait. */
+  TracedCallback<Time> m_jitterTrace;
+};
+
+} // namespace ns3
+
+#endif /* HYBRID_WALL_CLOCK_SYNCHRONIZER_H */
@@ -48,13 +48,16 @@ namespace ns3 {
  * \ingroup logging
  * The Log TimePrinter.
  * This is private to the logging implementation.
+ *
+ * The printers are per thread, since they are installed by the
+ * Simulator of the thread's SimulationContext.
  */
-static TimePrinter g_logTimePrinter = 0;
+static thread_local TimePrinter g_logTimePrinter = 0;
 /**
  * \ingroup logging
  * The Log NodePrinter.
  */
-static NodePrinter g_logNodePrinter = 0;
+static thread_local NodePrinter g_logNodePrinter = 0;
 
 /**
  * \ingroup logging
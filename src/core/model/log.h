@@ -303,6 +303,7 @@ void LogComponentPrintList (void);
  * to prepend log messages with the simulation time.
  *
  * The default is DefaultTimePrinter().
+ * The printer is set for the calling thread only.
  *
  * \param [in] lp The TimePrinter function.
  */
@@ -318,6 +319,7 @@ TimePrinter LogGetTimePrinter (void);
  * to prepend log messages with the node id.
  *
  * The default is DefaultNodePrinter().
+ * The printer is set for the calling thread only.
  *
  * \param [in] np The LogNodePrinter function.
  */
@@ -22,7 +22,8 @@
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
-#include "singleton.h"
+#include "simulation-context.h"
+#include "config.h"
 
 /**
  * \file
@@ -115,9 +116,9 @@ NameNode::~NameNode ()
 
 /**
  * \ingroup config
- * The singleton root Names object.
+ * The singleton root Names object, one per SimulationContext.
  */
-class NamesPriv : public Singleton<NamesPriv>
+class NamesPriv : public ContextSingleton<NamesPriv>
 {
 public:
   /** Constructor. */
@@ -772,6 +773,7 @@ Names::Add (std::string name, Ptr<Object> object)
   NS_LOG_FUNCTION (name << object);
   bool result = NamesPriv::Get ()->Add (name, object);
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name);
+  Config::InvalidateMatchCache ();
 }
 
 void
@@ -780,6 +782,7 @@ Names::Rename (std::string oldpath, std::string newname)
   NS_LOG_FUNCTION (oldpath << newname);
   bool result = NamesPriv::Get ()->Rename (oldpath, newname);
   NS_ABORT_MSG_UNLESS (result, "Names::Rename(): Error renaming " << oldpath << " to " << newname);
+  Config::InvalidateMatchCache ();
 }
 
 void
@@ -788,6 +791,7 @@ Names::Add (std::string path, std::string name, Ptr<Object> object)
   NS_LOG_FUNCTION (path << name << object);
   bool result = NamesPriv::Get ()->Add (path, name, object);
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding " << path << " " << name);
+  Config::InvalidateMatchCache ();
 }
 
 void
@@ -796,6 +800,7 @@ Names::Rename (std::string path, std::string oldname, std::string newname)
   NS_LOG_FUNCTION (path << oldname << newname);
   bool result = NamesPriv::Get ()->Rename (path, oldname, newname);
   NS_ABORT_MSG_UNLESS (result, "Names::Rename (): Error renaming " << path << " " << oldname << " to " << newname);
+  Config::InvalidateMatchCache ();
 }
 
 void
@@ -804,6 +809,7 @@ Names::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NS_LOG_FUNCTION (context << name << object);
   bool result = NamesPriv::Get ()->Add (context, name, object);
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name << " under context " << &context);
+  Config::InvalidateMatchCache ();
 }
 
 void
@@ -813,6 +819,7 @@ Names::Rename (Ptr<Object> context, std::string oldname, std::string newname)
   bool result = NamesPriv::Get ()->Rename (context, oldname, newname);
   NS_ABORT_MSG_UNLESS (result, "Names::Rename (): Error renaming " << oldname << " to " << newname << " under context " <<
                        &context);
+  Config::InvalidateMatchCache ();
 }
 
 std::string
@@ -833,7 +840,8 @@ void
 Names::Clear (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return NamesPriv::Get ()->Clear ();
+  NamesPriv::Get ()->Clear ();
+  Config::InvalidateMatchCache ();
 }
 
 Ptr<Object>
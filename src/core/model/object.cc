@@ -25,6 +25,7 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include "config.h"
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -316,6 +317,9 @@ Object::AggregateObject (Ptr<Object> o)
   // Now that we are done with them, we can free our old aggregate buffers
   std::free (a);
   std::free (b);
+
+  // Config paths may now resolve $TypeId elements differently.
+  Config::InvalidateMatchCache ();
 }
 /**
  * This function must be implemented in the stack that needs to notify
@@ -34,6 +34,7 @@
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
 #include "unused.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -49,6 +50,66 @@ NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
+namespace {
+
+/**
+ * \ingroup randomvariable
+ * Fill \p values with the next \p n uniform randoms from \p rng,
+ * flipped to \c 1-u if \p antithetic.
+ *
+ * \param [in] rng The underlying RngStream.
+ * \param [in] antithetic Whether to generate antithetic values.
+ * \param [out] values The array to fill.
+ * \param [in] n The number of values to generate.
+ */
+void
+FillU01 (RngStream *rng, bool antithetic, double *values, std::size_t n)
+{
+  rng->RandU01 (values, n);
+  if (antithetic)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          values[i] = (1 - values[i]);
+        }
+    }
+}
+
+/**
+ * \ingroup randomvariable
+ * Compact the values no larger than \p bound to the front of \p values,
+ * preserving their order.
+ *
+ * The rejection loops of the bounded distributions discard a uniform
+ * random whenever the transformed value is out of bounds, so keeping the
+ * accepted values of a block in order and drawing only as many more as
+ * are missing consumes exactly the same uniforms as the scalar loop.
+ *
+ * \param [in,out] values The values to filter.
+ * \param [in] n The number of values.
+ * \param [in] bound The upper bound; zero means unbounded.
+ * \returns The number of values kept.
+ */
+std::size_t
+KeepBounded (double *values, std::size_t n, double bound)
+{
+  if (bound == 0)
+    {
+      return n;
+    }
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      if (values[i] <= bound)
+        {
+          values[kept++] = values[i];
+        }
+    }
+  return kept;
+}
+
+} // anonymous namespace
+
 TypeId 
 RandomVariableStream::GetTypeId (void)
 {
@@ -131,6 +192,16 @@ RandomVariableStream::GetStream(void) const
   return m_stream;
 }
 
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 RngStream *
 RandomVariableStream::Peek(void) const
 {
@@ -208,6 +279,25 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double min = m_min;
+  const double max = m_max;
+  Peek ()->RandU01 (values, n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = min + values[i] * (max - min);
+    }
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          values[i] = min + (max - values[i]);
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -263,6 +353,12 @@ ConstantRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_constant);
 }
+void
+ConstantRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  std::fill (values, values + n, m_constant);
+}
 
 NS_OBJECT_ENSURE_REGISTERED(SequentialRandomVariable);
 
@@ -445,6 +541,24 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double mean = m_mean;
+  std::size_t done = 0;
+  while (done < n)
+    {
+      double *block = values + done;
+      std::size_t size = n - done;
+      FillU01 (Peek (), IsAntithetic (), block, size);
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          block[i] = -mean*std::log (block[i]);
+        }
+      done += KeepBounded (block, size, m_bound);
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -564,6 +678,25 @@ ParetoRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_scale, m_shape, m_bound);
 }
+void
+ParetoRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double scale = m_scale;
+  const double exponent = 1.0 / m_shape;
+  std::size_t done = 0;
+  while (done < n)
+    {
+      double *block = values + done;
+      std::size_t size = n - done;
+      FillU01 (Peek (), IsAntithetic (), block, size);
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          block[i] = (scale * ( 1.0 / std::pow (block[i], exponent)));
+        }
+      done += KeepBounded (block, size, m_bound);
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(WeibullRandomVariable);
 
@@ -658,6 +791,25 @@ WeibullRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_scale, m_shape, m_bound);
 }
+void
+WeibullRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double scale = m_scale;
+  const double exponent = 1.0 / m_shape;
+  std::size_t done = 0;
+  while (done < n)
+    {
+      double *block = values + done;
+      std::size_t size = n - done;
+      FillU01 (Peek (), IsAntithetic (), block, size);
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          block[i] = scale * std::pow ( -std::log (block[i]), exponent);
+        }
+      done += KeepBounded (block, size, m_bound);
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(NormalRandomVariable);
 
@@ -30,6 +30,7 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+#include <cstddef>
 
 /**
  * \file
@@ -149,6 +150,22 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   *
+   * This returns the same values, in the same order and leaving the
+   * stream in the same state, as \p n successive calls to GetValue (void),
+   * so it can be used on seeded streams without changing any results.
+   * Distributions with a closed form inverse transform override it to
+   * generate the underlying uniform randoms as a block and transform
+   * them in tight loops; the default implementation simply calls
+   * GetValue (void) \p n times.
+   *
+   * \param [out] values The array to fill with \p n random values.
+   * \param [in] n The number of values to generate.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
@@ -294,6 +311,7 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -353,6 +371,7 @@ public:
   virtual double GetValue (void);
   /* \note This RNG always returns the same value. */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The constant value returned by this RNG stream. */
@@ -586,6 +605,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -792,6 +812,9 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
   /** The mean parameter for the Pareto distribution returned by this RNG stream. */
   double m_mean;
@@ -1001,6 +1024,9 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+  // Inherited from RandomVariableStream
+  virtual void GetValues (double *values, std::size_t n);
+
 private:
   /** The scale parameter for the Weibull distribution returned by this RNG stream. */
   double m_scale;
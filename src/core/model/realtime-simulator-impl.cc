@@ -31,6 +31,7 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "object-factory.h"
 
 
 #include <cmath>
@@ -69,6 +70,11 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("SynchronizerType",
+                   "The type of Synchronizer used to track real time.",
+                   TypeIdValue (WallClockSynchronizer::GetTypeId ()),
+                   MakeTypeIdAccessor (&RealtimeSimulatorImpl::SetSynchronizerType),
+                   MakeTypeIdChecker ())
   ;
   return tid;
 }
@@ -853,4 +859,26 @@ RealtimeSimulatorImpl::GetHardLimit (void) const
   return m_hardLimit;
 }
 
+void
+RealtimeSimulatorImpl::SetSynchronizerType (TypeId type)
+{
+  NS_LOG_FUNCTION (this << type);
+  NS_ASSERT_MSG (m_running == false,
+                 "RealtimeSimulatorImpl::SetSynchronizerType(): Simulator is running");
+  if (m_synchronizer != 0 && m_synchronizer->GetInstanceTypeId () == type)
+    {
+      return;
+    }
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  m_synchronizer = factory.Create<Synchronizer> ();
+}
+
+Ptr<Synchronizer>
+RealtimeSimulatorImpl::GetSynchronizer (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_synchronizer;
+}
+
 } // namespace ns3
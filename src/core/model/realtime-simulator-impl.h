@@ -155,6 +155,21 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /**
+   * Replace the Synchronizer with a new one of the given type.
+   *
+   * This must be done before the simulator starts running.
+   *
+   * \param [in] type The TypeId of a Synchronizer subclass.
+   */
+  void SetSynchronizerType (TypeId type);
+  /**
+   * Get the Synchronizer in use, e.g. to read its statistics.
+   *
+   * \returns The Synchronizer.
+   */
+  Ptr<Synchronizer> GetSynchronizer (void) const;
+
 private:
   /**
    * Is the simulator running?
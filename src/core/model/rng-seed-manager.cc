@@ -22,6 +22,7 @@
 #include "attribute-helper.h"
 #include "uinteger.h"
 #include "config.h"
+#include "simulation-context.h"
 #include "log.h"
 
 /**
@@ -34,12 +35,24 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("RngSeedManager");
 
+namespace {
+
 /**
  * \relates RngSeedManager
  * The next random number generator stream number to use
- * for automatic assignment.
+ * for automatic assignment.  There is one per SimulationContext,
+ * so replications run in separate contexts allocate the same streams.
  */
-static uint64_t g_nextStreamIndex = 0;
+struct NextStreamIndex
+{
+  NextStreamIndex ()
+    : value (0)
+  {}
+  uint64_t value;  //!< The next stream number.
+};
+
+} // anonymous namespace
+
 /**
  * \relates RngSeedManager
  * The random number generator seed number global value.  This is used to
@@ -100,8 +113,9 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint64_t next = g_nextStreamIndex;
-  g_nextStreamIndex++;
+  NextStreamIndex *index = SimulationContext::GetCurrent ()->GetInstance<NextStreamIndex> ();
+  uint64_t next = index->value;
+  index->value++;
   return next;
 }
 
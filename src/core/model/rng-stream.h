@@ -20,6 +20,7 @@
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
 #include <string>
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -70,6 +71,17 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   *
+   * This yields the same values, in the same order, as \p n calls
+   * to RandU01 (void), but keeps the generator state in registers
+   * for the whole block.
+   *
+   * \param [out] values The array to fill with \p n uniform randoms.
+   * \param [in] n The number of values to generate.
+   */
+  void RandU01 (double *values, std::size_t n);
 
 private:
   /**
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulation-context.h"
+#include "system-mutex.h"
+#include "assert.h"
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SimulationContext implementation.
+ */
+
+// Note:  Logging in this file is largely avoided because the
+// context is looked up by the Simulator, which the log time printer
+// calls back into.
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \ingroup core
+ * The context entered by the calling thread, or 0 for the default one.
+ */
+thread_local SimulationContext *g_current = 0;
+
+/**
+ * \ingroup core
+ * Get the mutex protecting the allocation of instance indices.
+ * \returns The mutex.
+ */
+SystemMutex &
+GetIndexMutex (void)
+{
+  static SystemMutex mutex;
+  return mutex;
+}
+
+} // anonymous namespace
+
+SimulationContext::SimulationContext ()
+  : m_previous (0),
+    m_entered (false),
+    m_default (false)
+{
+}
+
+SimulationContext::~SimulationContext ()
+{
+  NS_ASSERT_MSG (!m_entered, "Deleting a SimulationContext which is still current");
+  // The instances may use other instances of this context while
+  // they are deleted, so make it current meanwhile.  Deleting an
+  // instance may also create a new one, which is deleted in turn.
+  SimulationContext *current = g_current;
+  g_current = this;
+  while (!m_order.empty ())
+    {
+      std::size_t index = m_order.back ();
+      m_order.pop_back ();
+      struct Instance instance = m_instances[index];
+      m_instances[index].object = 0;
+      instance.deleter (instance.object);
+    }
+  g_current = current;
+}
+
+SimulationContext *
+SimulationContext::GetCurrent (void)
+{
+  SimulationContext *context = g_current;
+  if (context == 0)
+    {
+      context = GetDefault ();
+    }
+  return context;
+}
+
+SimulationContext *
+SimulationContext::GetDefault (void)
+{
+  // Never deleted: the default context lives as long as the process,
+  // and some of its instances may be used by static destructors.
+  static SimulationContext *context = CreateDefault ();
+  return context;
+}
+
+SimulationContext *
+SimulationContext::CreateDefault (void)
+{
+  SimulationContext *context = new SimulationContext ();
+  context->m_default = true;
+  return context;
+}
+
+void
+SimulationContext::Enter (Ptr<SimulationContext> context)
+{
+  NS_ASSERT (context != 0);
+  NS_ASSERT_MSG (!context->m_entered, "SimulationContext is already current");
+  context->Ref ();
+  context->m_previous = g_current;
+  context->m_entered = true;
+  g_current = PeekPointer (context);
+}
+
+void
+SimulationContext::Leave (void)
+{
+  SimulationContext *context = g_current;
+  NS_ASSERT_MSG (context != 0, "Leave without a matching Enter");
+  g_current = context->m_previous;
+  context->m_previous = 0;
+  context->m_entered = false;
+  context->Unref ();
+}
+
+bool
+SimulationContext::IsDefault (void) const
+{
+  return m_default;
+}
+
+std::size_t
+SimulationContext::AllocateIndex (void)
+{
+  static std::size_t next = 0;
+  CriticalSection critical (GetIndexMutex ());
+  return next++;
+}
+
+void
+SimulationContext::Adopt (std::size_t index, void *object, void (*deleter)(void *object))
+{
+  if (index >= m_instances.size ())
+    {
+      struct Instance empty = { 0, 0 };
+      m_instances.resize (index + 1, empty);
+    }
+  m_instances[index].object = object;
+  m_instances[index].deleter = deleter;
+  m_order.push_back (index);
+}
+
+} // namespace ns3
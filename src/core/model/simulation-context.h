@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_CONTEXT_H
+#define SIMULATION_CONTEXT_H
+
+#include "simple-ref-count.h"
+#include "ptr.h"
+#include "non-copyable.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SimulationContext and ns3::ContextSingleton declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief The registries of one simulation.
+ *
+ * The state which makes up a simulation, as opposed to the state
+ * shared by the whole process, is owned by a SimulationContext:
+ * the simulator implementation, the NodeList and ChannelList,
+ * the Names, the Config root namespace, the GlobalValue values,
+ * the RngSeedManager stream allocation, the SimulationSingleton
+ * instances and the packet uid counter.  Each thread has a current
+ * context; unless another one is entered, this is the default context,
+ * which is what a single-threaded program uses.
+ *
+ * Entering a separate context on each of several threads lets
+ * independent simulations, for instance replications of the same
+ * scenario with different RngRun values, run concurrently in one
+ * process:
+ *
+ * \code
+ *   void
+ *   RunReplication (uint32_t run)
+ *   {
+ *     SimulationContext::Enter (Create<SimulationContext> ());
+ *     RngSeedManager::SetRun (run);
+ *     // Build the scenario, then
+ *     Simulator::Run ();
+ *     Simulator::Destroy ();
+ *     SimulationContext::Leave ();
+ *   }
+ * \endcode
+ *
+ * A context starts from the process-wide GlobalValue values, and
+ * changes made while it is current are only seen by that context.
+ * The TypeId registry, the attribute defaults set with
+ * Config::SetDefault, and the logging configuration remain shared by
+ * the whole process: they should be set up before the threads are
+ * started and left untouched while the simulations run.
+ *
+ * A context may only be current on one thread at a time.
+ */
+class SimulationContext : public SimpleRefCount<SimulationContext>
+{
+public:
+  /** Constructor. */
+  SimulationContext ();
+  /**
+   * Destructor.
+   *
+   * Deletes the instances owned by this context, newest first,
+   * with this context current.
+   */
+  ~SimulationContext ();
+
+  /**
+   * Get the current context of the calling thread.
+   * \returns The entered context, or the default context.
+   */
+  static SimulationContext *GetCurrent (void);
+  /**
+   * Get the default context, used by threads which have not entered
+   * a context.
+   * \returns The default context.
+   */
+  static SimulationContext *GetDefault (void);
+  /**
+   * Make \p context the current context of the calling thread.
+   *
+   * Calls to Enter and Leave nest.
+   *
+   * \param [in] context The context to enter.
+   */
+  static void Enter (Ptr<SimulationContext> context);
+  /**
+   * Restore the context of the calling thread which was current
+   * before the last call to Enter.
+   */
+  static void Leave (void);
+
+  /**
+   * Check if this is the default context.
+   * \returns \c true if this is the default context.
+   */
+  bool IsDefault (void) const;
+
+  /**
+   * Get the instance of \p T owned by this context, creating it
+   * with its default constructor on first use.
+   *
+   * \tparam T \explicit The type of the instance.
+   * \returns The instance of \p T.
+   */
+  template <typename T>
+  T *GetInstance (void);
+
+private:
+  /**
+   * Create the default context.
+   * \returns The default context.
+   */
+  static SimulationContext *CreateDefault (void);
+
+  /** An instance owned by the context. */
+  struct Instance
+  {
+    void *object;                    //!< The instance, or 0.
+    void (*deleter)(void *object);   //!< Deletes the instance.
+  };
+
+  /**
+   * Allocate the index of the instance of a new type.
+   * \returns The next free index.
+   */
+  static std::size_t AllocateIndex (void);
+  /**
+   * Delete an instance.
+   * \tparam T \explicit The type of the instance.
+   * \param [in] object The instance to delete.
+   */
+  template <typename T>
+  static void DeleteInstance (void *object);
+  /**
+   * Take ownership of a new instance.
+   * \param [in] index The index of the instance type.
+   * \param [in] object The instance.
+   * \param [in] deleter Deletes the instance.
+   */
+  void Adopt (std::size_t index, void *object, void (*deleter)(void *object));
+
+  /** The instances, indexed by AllocateIndex of their type. */
+  std::vector<struct Instance> m_instances;
+  /** The indices of the instances, in creation order. */
+  std::vector<std::size_t> m_order;
+  /** The context of the calling thread before Enter. */
+  SimulationContext *m_previous;
+  /** Whether this context is current on some thread. */
+  bool m_entered;
+  /** Whether this is the default context. */
+  bool m_default;
+};
+
+/**
+ * \ingroup core
+ * \brief A singleton with one instance per SimulationContext.
+ *
+ * This has the same usage as Singleton, but Get () returns the
+ * instance of the calling thread's current SimulationContext:
+ * \code
+ *   class ExampleS : public ContextSingleton<ExampleS> { ... };
+ *   ExampleS::Get ()->...;
+ * \endcode
+ *
+ * The instance is deleted with its context.
+ */
+template <typename T>
+class ContextSingleton : private NonCopyable
+{
+public:
+  /**
+   * Get a pointer to the instance of the current context.
+   * \return A pointer to the instance.
+   */
+  static T *Get (void);
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+T *
+SimulationContext::GetInstance (void)
+{
+  static const std::size_t index = AllocateIndex ();
+  if (index < m_instances.size () && m_instances[index].object != 0)
+    {
+      return static_cast<T *> (m_instances[index].object);
+    }
+  T *object = new T ();
+  Adopt (index, object, &SimulationContext::DeleteInstance<T>);
+  return object;
+}
+
+template <typename T>
+void
+SimulationContext::DeleteInstance (void *object)
+{
+  delete static_cast<T *> (object);
+}
+
+template <typename T>
+T *
+ContextSingleton<T>::Get (void)
+{
+  return SimulationContext::GetCurrent ()->GetInstance<T> ();
+}
+
+} // namespace ns3
+
+#endif /* SIMULATION_CONTEXT_H */
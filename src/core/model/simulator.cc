@@ -24,6 +24,7 @@
 #include "map-scheduler.h"
 #include "event-impl.h"
 #include "des-metrics.h"
+#include "simulation-context.h"
 
 #include "ptr.h"
 #include "string.h"
@@ -78,13 +79,12 @@ static GlobalValue g_schedTypeImpl = GlobalValue ("SchedulerType",
 
 /**
  * \ingroup simulator
- * \brief Get the static SimulatorImpl instance.
+ * \brief Get the SimulatorImpl instance of the current SimulationContext.
  * \return The SimulatorImpl instance pointer.
  */
 static SimulatorImpl **PeekImpl (void)
 {
-  static SimulatorImpl *impl = 0;
-  return &impl;
+  return SimulationContext::GetCurrent ()->GetInstance<SimulatorImpl *> ();
 }
 
 /**
@@ -0,0 +1,734 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "trace-recorder.h"
+#include "simulator.h"
+#include "system-thread.h"
+#include "system-mutex.h"
+#include "system-condition.h"
+#include "assert.h"
+#include "abort.h"
+
+#include <deque>
+#include <iostream>
+#include <set>
+#include <streambuf>
+
+/**
+ * \file
+ * \ingroup tracing
+ * ns3::TraceRecorder and ns3::TraceRecording implementations.
+ */
+
+// Note:  This file does not log, since the log output may itself
+// be recorded.
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \ingroup tracing
+ * The magic number at the start of a recording.
+ */
+const char RECORDING_MAGIC[8] = { 'n', 's', '3', 't', 'r', 'a', 'c', 'e' };
+/** The version of the recording format. */
+const uint32_t RECORDING_VERSION = 1;
+/** The type of a chunk holding one source definition. */
+const uint32_t CHUNK_SOURCE = 1;
+/** The type of a chunk holding records. */
+const uint32_t CHUNK_RECORDS = 2;
+/** The offset of the data in the first slot of a record. */
+const uint32_t DATA_OFFSET = TraceRecorder::RECORD_SIZE - TraceRecorder::HEADER_DATA;
+/** The size of a record buffer, in bytes. */
+const uint32_t BLOCK_SIZE = 1024 * TraceRecorder::RECORD_SIZE;
+/** The number of record buffers after which recording threads wait for the writer. */
+const uint32_t MAX_BLOCKS = 64;
+/** The largest snap length. */
+const uint32_t MAX_SNAP_LENGTH = 16384;
+/** The smallest snap length. */
+const uint32_t MIN_SNAP_LENGTH = 16;
+
+/**
+ * \ingroup tracing
+ * A buffer of records.
+ */
+struct Block
+{
+  /** Constructor. */
+  Block ()
+    : data (new uint8_t[BLOCK_SIZE] ()),
+      used (0)
+  {}
+  /** Destructor. */
+  ~Block ()
+  {
+    delete [] data;
+  }
+  uint8_t *data;   //!< The records.
+  uint32_t used;   //!< The number of bytes used.
+};
+
+struct ThreadBuffer;
+
+/**
+ * \ingroup tracing
+ * The state of the recorder, shared by all threads.
+ */
+class Recorder
+{
+public:
+  /** Constructor. */
+  Recorder ();
+  /**
+   * Hand a buffer to the writer and get an empty one.
+   * \param [in] thread The buffer of the calling thread.
+   */
+  void Swap (struct ThreadBuffer *thread);
+  /**
+   * Hand the buffer of a thread which exits to the writer.
+   * \param [in] thread The buffer of the calling thread.
+   */
+  void Release (struct ThreadBuffer *thread);
+  /** Write the buffers handed to the writer, until stopped. */
+  void Write (void);
+  /**
+   * Write a source definition to the file.
+   * \param [in] id The id of the source.
+   * \param [in] source The source.
+   */
+  void WriteSource (uint16_t id, const struct TraceRecording::Source &source);
+
+  SystemMutex m_mutex;                              //!< Protects the members below.
+  SystemCondition m_ready;                          //!< Buffers are waiting to be written.
+  SystemCondition m_written;                        //!< A buffer was written.
+  std::deque<Block *> m_full;                       //!< Buffers to write.
+  std::vector<Block *> m_free;                      //!< Empty buffers.
+  uint32_t m_blocks;                                //!< The number of buffers.
+  std::vector<struct TraceRecording::Source> m_sources; //!< The registered sources.
+  std::size_t m_sourcesWritten;                     //!< The sources in the file.
+  std::set<struct ThreadBuffer *> m_threads;        //!< The buffers of the threads.
+  std::ofstream m_file;                             //!< The recording.
+  Ptr<SystemThread> m_writer;                       //!< The writer thread.
+  bool m_stopping;                                  //!< Whether the writer should stop.
+  uint32_t m_snapLength;                            //!< The snap length.
+  uint16_t m_logSource;                             //!< The source of the log lines.
+  std::streambuf *m_clog;                           //!< The buffer of std::clog.
+};
+
+/**
+ * \ingroup tracing
+ * The buffer of a thread.
+ */
+struct ThreadBuffer
+{
+  /** Constructor. */
+  ThreadBuffer ()
+    : block (0),
+      registered (false)
+  {}
+  /** Destructor. */
+  ~ThreadBuffer ();
+
+  Block *block;       //!< The buffer, or 0.
+  bool registered;    //!< Whether the buffer is known to the Recorder.
+};
+
+/**
+ * \ingroup tracing
+ * Whether the recorder is enabled.
+ */
+bool g_enabled = false;
+/**
+ * \ingroup tracing
+ * The buffer of the calling thread.
+ */
+thread_local ThreadBuffer g_thread;
+/**
+ * \ingroup tracing
+ * Whether the calling thread is stamping a record, to avoid recursion
+ * if getting the time causes logging.
+ */
+thread_local bool g_stamping = false;
+
+/**
+ * \ingroup tracing
+ * Get the recorder.
+ * \returns The recorder.
+ */
+Recorder *
+GetRecorder (void)
+{
+  // Never deleted: threads may still hand it their buffers at exit.
+  static Recorder *recorder = new Recorder ();
+  return recorder;
+}
+
+ThreadBuffer::~ThreadBuffer ()
+{
+  if (registered)
+    {
+      GetRecorder ()->Release (this);
+    }
+}
+
+Recorder::Recorder ()
+  : m_blocks (0),
+    m_sourcesWritten (0),
+    m_stopping (false),
+    m_snapLength (256),
+    m_logSource (0),
+    m_clog (0)
+{
+}
+
+void
+Recorder::Swap (struct ThreadBuffer *thread)
+{
+  CriticalSection critical (m_mutex);
+  if (!thread->registered)
+    {
+      m_threads.insert (thread);
+      thread->registered = true;
+    }
+  if (thread->block != 0)
+    {
+      m_full.push_back (thread->block);
+      thread->block = 0;
+      m_ready.SetCondition (true);
+      m_ready.Signal ();
+    }
+  while (m_free.empty () && m_blocks >= MAX_BLOCKS)
+    {
+      // The writer lags behind: wait rather than drop records.
+      m_mutex.Unlock ();
+      m_written.TimedWait (1000000);
+      m_mutex.Lock ();
+    }
+  if (m_free.empty ())
+    {
+      ++m_blocks;
+      thread->block = new Block ();
+    }
+  else
+    {
+      thread->block = m_free.back ();
+      m_free.pop_back ();
+    }
+  thread->block->used = 0;
+}
+
+void
+Recorder::Release (struct ThreadBuffer *thread)
+{
+  CriticalSection critical (m_mutex);
+  if (thread->block != 0)
+    {
+      if (g_enabled && thread->block->used != 0)
+        {
+          m_full.push_back (thread->block);
+          m_ready.SetCondition (true);
+          m_ready.Signal ();
+        }
+      else
+        {
+          m_free.push_back (thread->block);
+        }
+      thread->block = 0;
+    }
+  m_threads.erase (thread);
+  thread->registered = false;
+}
+
+void
+Recorder::Write (void)
+{
+  while (true)
+    {
+      std::vector<struct TraceRecording::Source> sources;
+      std::size_t firstSource;
+      Block *block = 0;
+      bool stopping;
+      {
+        CriticalSection critical (m_mutex);
+        firstSource = m_sourcesWritten;
+        sources.assign (m_sources.begin () + m_sourcesWritten, m_sources.end ());
+        m_sourcesWritten = m_sources.size ();
+        if (!m_full.empty ())
+          {
+            block = m_full.front ();
+            m_full.pop_front ();
+          }
+        stopping = m_stopping;
+      }
+      for (std::size_t i = 0; i < sources.size (); ++i)
+        {
+          WriteSource (firstSource + i, sources[i]);
+        }
+      if (block != 0)
+        {
+          m_file.write (reinterpret_cast<const char *> (&CHUNK_RECORDS), 4);
+          m_file.write (reinterpret_cast<const char *> (&block->used), 4);
+          m_file.write (reinterpret_cast<const char *> (block->data), block->used);
+          {
+            CriticalSection critical (m_mutex);
+            m_free.push_back (block);
+          }
+          m_written.SetCondition (true);
+          m_written.Broadcast ();
+        }
+      else if (stopping)
+        {
+          break;
+        }
+      else
+        {
+          // Polling bounds the delay of a missed signal.
+          m_ready.TimedWait (10000000);
+        }
+    }
+  m_file.flush ();
+}
+
+void
+Recorder::WriteSource (uint16_t id, const struct TraceRecording::Source &source)
+{
+  uint16_t type = source.type;
+  uint32_t nameLength = source.name.size ();
+  uint32_t size = 2 + 2 + 4 + 4 + 4 + nameLength;
+  uint32_t event = static_cast<uint8_t> (source.event);
+  m_file.write (reinterpret_cast<const char *> (&CHUNK_SOURCE), 4);
+  m_file.write (reinterpret_cast<const char *> (&size), 4);
+  m_file.write (reinterpret_cast<const char *> (&id), 2);
+  m_file.write (reinterpret_cast<const char *> (&type), 2);
+  m_file.write (reinterpret_cast<const char *> (&source.linkType), 4);
+  m_file.write (reinterpret_cast<const char *> (&event), 4);
+  m_file.write (reinterpret_cast<const char *> (&nameLength), 4);
+  m_file.write (source.name.data (), nameLength);
+}
+
+
+/**
+ * \ingroup tracing
+ * A stream buffer recording each line written to it.
+ */
+class LogRecorderBuffer : public std::streambuf
+{
+protected:
+  /**
+   * Write one character.
+   * \param [in] c The character.
+   * \returns \p c.
+   */
+  virtual int_type overflow (int_type c);
+  /**
+   * Write characters.
+   * \param [in] s The characters.
+   * \param [in] n The number of characters.
+   * \returns \p n.
+   */
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+
+private:
+  /** Record the current line of the calling thread. */
+  static void Flush (void);
+  /** The current line of each thread. */
+  static thread_local std::string m_line;
+};
+
+thread_local std::string LogRecorderBuffer::m_line;
+
+LogRecorderBuffer::int_type
+LogRecorderBuffer::overflow (int_type c)
+{
+  if (traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      return traits_type::not_eof (c);
+    }
+  if (traits_type::to_char_type (c) == '\n')
+    {
+      Flush ();
+    }
+  else
+    {
+      m_line += traits_type::to_char_type (c);
+    }
+  return c;
+}
+
+std::streamsize
+LogRecorderBuffer::xsputn (const char *s, std::streamsize n)
+{
+  const char *end = s + n;
+  while (s != end)
+    {
+      const char *newline = std::find (s, end, '\n');
+      m_line.append (s, newline);
+      if (newline == end)
+        {
+          break;
+        }
+      Flush ();
+      s = newline + 1;
+    }
+  return n;
+}
+
+void
+LogRecorderBuffer::Flush (void)
+{
+  // Recording may log in turn, so release the line first.
+  std::string line;
+  line.swap (m_line);
+  TraceRecorder::Record (GetRecorder ()->m_logSource,
+                         reinterpret_cast<const uint8_t *> (line.data ()),
+                         line.size ());
+}
+
+/**
+ * \ingroup tracing
+ * Get the stream buffer recording the log output.
+ * \returns The stream buffer.
+ */
+LogRecorderBuffer *
+GetLogRecorderBuffer (void)
+{
+  static LogRecorderBuffer *buffer = new LogRecorderBuffer ();
+  return buffer;
+}
+
+/**
+ * \ingroup tracing
+ * Write the recording when the program exits.
+ */
+struct DisableAtExit
+{
+  /** Destructor. */
+  ~DisableAtExit ()
+  {
+    TraceRecorder::Disable ();
+  }
+} g_disableAtExit;   //!< Disables the recorder at exit.
+
+} // anonymous namespace
+
+
+bool
+TraceRecorder::Enable (std::string filename)
+{
+  Disable ();
+  Recorder *recorder = GetRecorder ();
+  recorder->m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!recorder->m_file)
+    {
+      return false;
+    }
+  int64_t stepsPerSecond = Seconds (1).GetTimeStep ();
+  uint32_t recordSize = RECORD_SIZE;
+  recorder->m_file.write (RECORDING_MAGIC, sizeof (RECORDING_MAGIC));
+  recorder->m_file.write (reinterpret_cast<const char *> (&RECORDING_VERSION), 4);
+  recorder->m_file.write (reinterpret_cast<const char *> (&recordSize), 4);
+  recorder->m_file.write (reinterpret_cast<const char *> (&stepsPerSecond), 8);
+
+  recorder->m_sourcesWritten = 0;
+  recorder->m_stopping = false;
+  recorder->m_writer = Create<SystemThread> (MakeCallback (&Recorder::Write, recorder));
+  recorder->m_writer->Start ();
+  g_enabled = true;
+  return true;
+}
+
+void
+TraceRecorder::Disable (void)
+{
+  if (!g_enabled)
+    {
+      return;
+    }
+  RecordLog (false);
+  Recorder *recorder = GetRecorder ();
+  {
+    CriticalSection critical (recorder->m_mutex);
+    g_enabled = false;
+    for (std::set<struct ThreadBuffer *>::iterator i = recorder->m_threads.begin ();
+         i != recorder->m_threads.end (); ++i)
+      {
+        Block *block = (*i)->block;
+        if (block != 0 && block->used != 0)
+          {
+            recorder->m_full.push_back (block);
+            (*i)->block = 0;
+          }
+      }
+    recorder->m_stopping = true;
+    recorder->m_ready.SetCondition (true);
+    recorder->m_ready.Signal ();
+  }
+  recorder->m_writer->Join ();
+  recorder->m_writer = 0;
+  recorder->m_file.close ();
+}
+
+bool
+TraceRecorder::IsEnabled (void)
+{
+  return g_enabled;
+}
+
+void
+TraceRecorder::SetSnapLength (uint32_t bytes)
+{
+  GetRecorder ()->m_snapLength = std::min (std::max (bytes, MIN_SNAP_LENGTH), MAX_SNAP_LENGTH);
+}
+
+uint32_t
+TraceRecorder::GetSnapLength (void)
+{
+  return GetRecorder ()->m_snapLength;
+}
+
+void
+TraceRecorder::RecordLog (bool enable)
+{
+  Recorder *recorder = GetRecorder ();
+  if (enable && recorder->m_clog == 0)
+    {
+      if (recorder->m_logSource == 0)
+        {
+          recorder->m_logSource = RegisterSource ("log", TEXT);
+        }
+      recorder->m_clog = std::clog.rdbuf (GetLogRecorderBuffer ());
+    }
+  else if (!enable && recorder->m_clog != 0)
+    {
+      std::clog.rdbuf (recorder->m_clog);
+      recorder->m_clog = 0;
+    }
+}
+
+uint16_t
+TraceRecorder::RegisterSource (std::string name, enum SourceType type,
+                               uint32_t linkType, char event)
+{
+  Recorder *recorder = GetRecorder ();
+  CriticalSection critical (recorder->m_mutex);
+  // Id 0 is reserved, so that it can mean "no source".
+  if (recorder->m_sources.empty ())
+    {
+      struct TraceRecording::Source none = { "", TEXT, 0, 't' };
+      recorder->m_sources.push_back (none);
+    }
+  NS_ABORT_MSG_IF (recorder->m_sources.size () > 0xffff, "Too many recorded trace sources");
+  struct TraceRecording::Source source = { name, type, linkType, event };
+  recorder->m_sources.push_back (source);
+  return recorder->m_sources.size () - 1;
+}
+
+uint8_t *
+TraceRecorder::Reserve (uint16_t source, uint32_t length, uint32_t captured)
+{
+  if (!g_enabled)
+    {
+      return 0;
+    }
+  NS_ASSERT (captured <= length && captured <= MAX_SNAP_LENGTH);
+  // Stamp first: getting the time may log, and so record, which
+  // must not happen once the space of this record is taken.
+  int64_t time = 0;
+  uint32_t context = 0xffffffff;
+  if (!g_stamping)
+    {
+      g_stamping = true;
+      time = Simulator::Now ().GetTimeStep ();
+      context = Simulator::GetContext ();
+      g_stamping = false;
+    }
+  uint32_t size = RECORD_SIZE;
+  if (captured > HEADER_DATA)
+    {
+      size += (captured - HEADER_DATA + RECORD_SIZE - 1) / RECORD_SIZE * RECORD_SIZE;
+    }
+  ThreadBuffer *thread = &g_thread;
+  if (thread->block == 0 || thread->block->used + size > BLOCK_SIZE)
+    {
+      GetRecorder ()->Swap (thread);
+    }
+  uint8_t *record = thread->block->data + thread->block->used;
+  thread->block->used += size;
+  uint16_t captured16 = captured;
+  memcpy (record, &time, 8);
+  memcpy (record + 8, &context, 4);
+  memcpy (record + 12, &source, 2);
+  memcpy (record + 14, &captured16, 2);
+  memcpy (record + 16, &length, 4);
+  return record + DATA_OFFSET;
+}
+
+void
+TraceRecorder::Record (uint16_t source, const uint8_t *data, uint32_t length)
+{
+  uint32_t captured = std::min (length, GetSnapLength ());
+  uint8_t *buffer = Reserve (source, length, captured);
+  if (buffer != 0)
+    {
+      memcpy (buffer, data, captured);
+    }
+}
+
+Config::MatchContainer
+TraceRecorder::LookupSources (std::string path, std::string &name)
+{
+  std::string::size_type pos = path.rfind ("/");
+  NS_ASSERT_MSG (pos != std::string::npos, "Invalid trace source path " << path);
+  name = path.substr (pos + 1);
+  return Config::LookupMatches (path.substr (0, pos));
+}
+
+
+TraceRecording::TraceRecording (std::string filename)
+  : m_file (filename.c_str (), std::ios::in | std::ios::binary),
+    m_ok (false),
+    m_stepsPerSecond (1),
+    m_offset (0)
+{
+  char magic[sizeof (RECORDING_MAGIC)];
+  uint32_t version = 0;
+  uint32_t recordSize = 0;
+  m_file.read (magic, sizeof (magic));
+  m_file.read (reinterpret_cast<char *> (&version), 4);
+  m_file.read (reinterpret_cast<char *> (&recordSize), 4);
+  m_file.read (reinterpret_cast<char *> (&m_stepsPerSecond), 8);
+  m_ok = m_file
+    && std::equal (magic, magic + sizeof (magic), RECORDING_MAGIC)
+    && version == RECORDING_VERSION
+    && recordSize == TraceRecorder::RECORD_SIZE
+    && m_stepsPerSecond > 0;
+}
+
+bool
+TraceRecording::IsOk (void) const
+{
+  return m_ok;
+}
+
+bool
+TraceRecording::Next (Record &record)
+{
+  while (m_ok && m_offset >= m_chunk.size ())
+    {
+      if (!ReadChunk ())
+        {
+          return false;
+        }
+    }
+  if (!m_ok)
+    {
+      return false;
+    }
+  const uint8_t *slot = &m_chunk[m_offset];
+  uint16_t captured;
+  memcpy (&record.time, slot, 8);
+  memcpy (&record.context, slot + 8, 4);
+  memcpy (&record.source, slot + 12, 2);
+  memcpy (&captured, slot + 14, 2);
+  memcpy (&record.length, slot + 16, 4);
+  uint32_t size = TraceRecorder::RECORD_SIZE;
+  if (captured > TraceRecorder::HEADER_DATA)
+    {
+      size += (captured - TraceRecorder::HEADER_DATA + TraceRecorder::RECORD_SIZE - 1)
+        / TraceRecorder::RECORD_SIZE * TraceRecorder::RECORD_SIZE;
+    }
+  if (m_offset + size > m_chunk.size () || captured > record.length)
+    {
+      m_ok = false;
+      return false;
+    }
+  record.data.assign (slot + DATA_OFFSET, slot + DATA_OFFSET + captured);
+  m_offset += size;
+  return true;
+}
+
+bool
+TraceRecording::ReadChunk (void)
+{
+  uint32_t type;
+  uint32_t size;
+  m_file.read (reinterpret_cast<char *> (&type), 4);
+  if (m_file.eof ())
+    {
+      return false;
+    }
+  m_file.read (reinterpret_cast<char *> (&size), 4);
+  std::vector<uint8_t> chunk (size);
+  m_file.read (reinterpret_cast<char *> (chunk.data ()), size);
+  if (!m_file)
+    {
+      m_ok = false;
+      return false;
+    }
+  if (type == CHUNK_RECORDS)
+    {
+      m_chunk.swap (chunk);
+      m_offset = 0;
+    }
+  else if (type == CHUNK_SOURCE && size >= 16)
+    {
+      uint16_t id;
+      uint16_t sourceType;
+      uint32_t event;
+      uint32_t nameLength;
+      struct Source source;
+      memcpy (&id, &chunk[0], 2);
+      memcpy (&sourceType, &chunk[2], 2);
+      memcpy (&source.linkType, &chunk[4], 4);
+      memcpy (&event, &chunk[8], 4);
+      memcpy (&nameLength, &chunk[12], 4);
+      if (16 + nameLength != size)
+        {
+          m_ok = false;
+          return false;
+        }
+      source.name.assign (chunk.begin () + 16, chunk.end ());
+      source.type = static_cast<enum TraceRecorder::SourceType> (sourceType);
+      source.event = static_cast<char> (event);
+      m_sources[id] = source;
+    }
+  else
+    {
+      m_ok = false;
+      return false;
+    }
+  return true;
+}
+
+const struct TraceRecording::Source *
+TraceRecording::GetSource (uint16_t id) const
+{
+  std::map<uint16_t, struct Source>::const_iterator i = m_sources.find (id);
+  if (i == m_sources.end ())
+    {
+      return 0;
+    }
+  return &i->second;
+}
+
+int64_t
+TraceRecording::GetStepsPerSecond (void) const
+{
+  return m_stepsPerSecond;
+}
+
+} // namespace ns3
@@ -0,0 +1,434 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "callback.h"
+#include "config.h"
+#include "nstime.h"
+#include "object.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup tracing
+ * ns3::TraceRecorder, ns3::TraceRecordTraits and ns3::TraceRecording
+ * declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup tracing
+ * \brief Record trace source invocations and log messages in a
+ * compact binary file.
+ *
+ * Formatting text traces with iostreams while the simulation runs is
+ * often the dominant cost of a traced run.  The recorder instead
+ * appends fixed-size binary records to a memory buffer owned by the
+ * calling thread; full buffers are written to disk by a background
+ * thread.  Each record holds the simulation time, the simulator
+ * context (usually the node id), the id of the trace source, and the
+ * first bytes of the traced data.  A recording is read back with
+ * TraceRecording, and converted to the usual ASCII and pcap formats by
+ * the trace-recording-decoder program.
+ *
+ * \code
+ *   TraceRecorder::Enable ("trace.bin");
+ *   TraceRecorder::Connect<Ptr<const Packet> >
+ *     ("/NodeList/0/DeviceList/0/$ns3::PointToPointNetDevice/MacTx",
+ *      PcapHelper::DLT_PPP, 't');
+ *   TraceRecorder::RecordLog (true);
+ *   Simulator::Run ();
+ *   TraceRecorder::Disable ();
+ * \endcode
+ *
+ * The recorder is shared by the whole process.  It should be enabled
+ * before, and disabled after, the threads which record.
+ */
+class TraceRecorder
+{
+public:
+  /** How the data of the records of a source is decoded. */
+  enum SourceType
+  {
+    TEXT = 0,     //!< Text, such as a log message.
+    PACKET = 1,   //!< The bytes of a packet.
+    VALUES = 2    //!< A sequence of host order doubles.
+  };
+
+  /**
+   * Start recording to a file.
+   *
+   * The sources registered so far are recorded in the new file.
+   *
+   * \param [in] filename The name of the file to write.
+   * \returns \c true if the file could be opened.
+   */
+  static bool Enable (std::string filename);
+  /**
+   * Write the buffered records and close the file.
+   *
+   * No thread may be recording while this is called.
+   */
+  static void Disable (void);
+  /**
+   * Check if the recorder is enabled.
+   * \returns \c true if the recorder is enabled.
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * Set the maximum number of data bytes kept by each record.
+   *
+   * Data beyond this length is dropped, but its length is recorded.
+   *
+   * \param [in] bytes The maximum number of data bytes, clamped
+   *             to [16, 16384].  The default is 256.
+   */
+  static void SetSnapLength (uint32_t bytes);
+  /**
+   * Get the maximum number of data bytes kept by each record.
+   * \returns The maximum number of data bytes.
+   */
+  static uint32_t GetSnapLength (void);
+
+  /**
+   * Record the lines written to std::clog, and so the output of the
+   * NS_LOG macros, instead of printing them.
+   *
+   * \param [in] enable Whether to record the log output.
+   */
+  static void RecordLog (bool enable);
+
+  /**
+   * Register a source of records.
+   *
+   * \param [in] name The name of the source, usually the path of
+   *             its trace source.
+   * \param [in] type How the data of the records is decoded.
+   * \param [in] linkType The pcap data link type of PACKET sources.
+   * \param [in] event The ASCII trace event character of PACKET sources.
+   * \returns The id of the source.
+   */
+  static uint16_t RegisterSource (std::string name, enum SourceType type,
+                                  uint32_t linkType = 0, char event = 't');
+
+  /**
+   * Reserve a record in the buffer of the calling thread.
+   *
+   * The record is stamped with the current time and context.
+   *
+   * \param [in] source The id of the source.
+   * \param [in] length The length of the data.
+   * \param [in] captured The number of data bytes kept in the record,
+   *             at most GetSnapLength ().
+   * \returns Where to copy the captured data bytes, or 0 if
+   *          the recorder is disabled.
+   */
+  static uint8_t *Reserve (uint16_t source, uint32_t length, uint32_t captured);
+  /**
+   * Record a block of data.
+   *
+   * \param [in] source The id of the source.
+   * \param [in] data The data.
+   * \param [in] length The length of the data.
+   */
+  static void Record (uint16_t source, const uint8_t *data, uint32_t length);
+
+  /**
+   * Record the invocations of a trace source with one argument.
+   *
+   * Each trace source matched by \p path is registered as a separate
+   * source, named after its matched path.  TraceRecordTraits<T> gives
+   * the type and data of the records.
+   *
+   * \tparam T \explicit The type of the argument of the trace source.
+   * \param [in] path The Config path of the trace sources.
+   * \param [in] linkType The pcap data link type of PACKET sources.
+   * \param [in] event The ASCII trace event character of PACKET sources.
+   * \returns The number of trace sources connected.
+   */
+  template <typename T>
+  static std::size_t Connect (std::string path, uint32_t linkType = 0, char event = 't');
+  /**
+   * Record the new values of a TracedValue.
+   *
+   * \tparam T \explicit The type of the TracedValue.
+   * \param [in] path The Config path of the TracedValues.
+   * \returns The number of trace sources connected.
+   */
+  template <typename T>
+  static std::size_t ConnectTracedValue (std::string path);
+
+  /** The size of a record, in bytes. */
+  static const uint32_t RECORD_SIZE = 64;
+  /** The number of data bytes held by the first slot of a record. */
+  static const uint32_t HEADER_DATA = 44;
+
+private:
+  /**
+   * Trace sink for sources with one argument.
+   * \tparam T \deduced The type of the argument.
+   * \param [in] source The id of the source.
+   * \param [in] value The traced value.
+   */
+  template <typename T>
+  static void Sink (uint16_t source, T value);
+  /**
+   * Trace sink for TracedValue sources.
+   * \tparam T \deduced The type of the value.
+   * \param [in] source The id of the source.
+   * \param [in] oldValue The previous value.
+   * \param [in] newValue The new value.
+   */
+  template <typename T>
+  static void ValueSink (uint16_t source, T oldValue, T newValue);
+  /**
+   * Record the data of a traced value.
+   * \tparam T \deduced The type of the value.
+   * \param [in] source The id of the source.
+   * \param [in] value The traced value.
+   */
+  template <typename T>
+  static void Write (uint16_t source, T value);
+  /**
+   * Split a Config path in the path of the objects and the name
+   * of the trace source.
+   * \param [in] path The Config path of the trace sources.
+   * \param [out] name The name of the trace source.
+   * \returns The objects matched by the path.
+   */
+  static Config::MatchContainer LookupSources (std::string path, std::string &name);
+};
+
+
+/**
+ * \ingroup tracing
+ * \brief How TraceRecorder records a traced value of type \p T.
+ *
+ * The default records any type convertible to \c double as a VALUES
+ * record.  Other types provide a specialization with the same members.
+ *
+ * \tparam T \explicit The type of the traced value.
+ */
+template <typename T>
+struct TraceRecordTraits
+{
+  /** The type of the records. */
+  static const enum TraceRecorder::SourceType type = TraceRecorder::VALUES;
+  /**
+   * Get the length of the data of a value.
+   * \returns The length of the data.
+   */
+  static uint32_t GetLength (T)
+  {
+    return sizeof (double);
+  }
+  /**
+   * Copy the data of a value.
+   * \param [in] value The value.
+   * \param [out] data Where to copy the data.
+   * \param [in] captured The number of bytes to copy.
+   */
+  static void Copy (T value, uint8_t *data, uint32_t captured)
+  {
+    double v = static_cast<double> (value);
+    memcpy (data, &v, captured);
+  }
+};
+
+/**
+ * \ingroup tracing
+ * TraceRecordTraits specialization recording a Time in seconds.
+ */
+template <>
+struct TraceRecordTraits<Time>
+{
+  /** \copydoc TraceRecordTraits::type */
+  static const enum TraceRecorder::SourceType type = TraceRecorder::VALUES;
+  /** \copydoc TraceRecordTraits::GetLength */
+  static uint32_t GetLength (Time)
+  {
+    return sizeof (double);
+  }
+  /** \copydoc TraceRecordTraits::Copy */
+  static void Copy (Time value, uint8_t *data, uint32_t captured)
+  {
+    double v = value.GetSeconds ();
+    memcpy (data, &v, captured);
+  }
+};
+
+
+/**
+ * \ingroup tracing
+ * \brief Read a file written by TraceRecorder.
+ */
+class TraceRecording
+{
+public:
+  /** A registered source. */
+  struct Source
+  {
+    std::string name;                        //!< The name of the source.
+    enum TraceRecorder::SourceType type;     //!< How the data is decoded.
+    uint32_t linkType;                       //!< The pcap data link type.
+    char event;                              //!< The ASCII trace event.
+  };
+  /** A record. */
+  struct Record
+  {
+    int64_t time;                 //!< The time, in time steps.
+    uint32_t context;             //!< The simulator context.
+    uint16_t source;              //!< The id of the source.
+    uint32_t length;              //!< The length of the data.
+    std::vector<uint8_t> data;    //!< The captured data.
+  };
+
+  /**
+   * Open a recording.
+   * \param [in] filename The name of the file.
+   */
+  TraceRecording (std::string filename);
+  /**
+   * Check if the file is a valid recording.
+   * \returns \c true if no error occurred so far.
+   */
+  bool IsOk (void) const;
+  /**
+   * Read the next record.
+   *
+   * The sources are read as they are found in the file.
+   *
+   * \param [out] record The record.
+   * \returns \c true if a record was read.
+   */
+  bool Next (Record &record);
+  /**
+   * Get a source.
+   * \param [in] id The id of the source.
+   * \returns The source, or 0 if it is not known yet.
+   */
+  const struct Source *GetSource (uint16_t id) const;
+  /**
+   * Get the number of time steps per second of the record times.
+   * \returns The number of time steps per second.
+   */
+  int64_t GetStepsPerSecond (void) const;
+
+private:
+  /**
+   * Read the next chunk of the file.
+   * \returns \c true if a chunk was read.
+   */
+  bool ReadChunk (void);
+
+  std::ifstream m_file;                         //!< The recording.
+  bool m_ok;                                    //!< Whether no error occurred.
+  int64_t m_stepsPerSecond;                     //!< The time steps per second.
+  std::map<uint16_t, struct Source> m_sources;  //!< The sources read so far.
+  std::vector<uint8_t> m_chunk;                 //!< The current record chunk.
+  std::size_t m_offset;                         //!< The next record in m_chunk.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+std::size_t
+TraceRecorder::Connect (std::string path, uint32_t linkType, char event)
+{
+  std::string name;
+  Config::MatchContainer matches = LookupSources (path, name);
+  std::size_t connected = 0;
+  for (std::size_t i = 0; i < matches.GetN (); ++i)
+    {
+      uint16_t source = RegisterSource (matches.GetMatchedPath (i) + name,
+                                        TraceRecordTraits<T>::type, linkType, event);
+      if (matches.Get (i)->TraceConnectWithoutContext
+            (name, MakeBoundCallback (&TraceRecorder::Sink<T>, source)))
+        {
+          ++connected;
+        }
+    }
+  return connected;
+}
+
+template <typename T>
+std::size_t
+TraceRecorder::ConnectTracedValue (std::string path)
+{
+  std::string name;
+  Config::MatchContainer matches = LookupSources (path, name);
+  std::size_t connected = 0;
+  for (std::size_t i = 0; i < matches.GetN (); ++i)
+    {
+      uint16_t source = RegisterSource (matches.GetMatchedPath (i) + name,
+                                        TraceRecordTraits<T>::type);
+      if (matches.Get (i)->TraceConnectWithoutContext
+            (name, MakeBoundCallback (&TraceRecorder::ValueSink<T>, source)))
+        {
+          ++connected;
+        }
+    }
+  return connected;
+}
+
+template <typename T>
+void
+TraceRecorder::Sink (uint16_t source, T value)
+{
+  Write<T> (source, value);
+}
+
+template <typename T>
+void
+TraceRecorder::ValueSink (uint16_t source, T oldValue, T newValue)
+{
+  Write<T> (source, newValue);
+}
+
+template <typename T>
+void
+TraceRecorder::Write (uint16_t source, T value)
+{
+  uint32_t length = TraceRecordTraits<T>::GetLength (value);
+  uint32_t captured = std::min (length, GetSnapLength ());
+  uint8_t *data = Reserve (source, length, captured);
+  if (data != 0)
+    {
+      TraceRecordTraits<T>::Copy (value, data, captured);
+    }
+}
+
+} // namespace ns3
+
+#endif /* TRACE_RECORDER_H */
@@ -152,9 +152,13 @@ protected:
   /**
    * @brief Get the current absolute real time (in ns since the epoch).
    *
+   * Subclasses may read a different clock source, as long as it is
+   * monotonic in ns; only differences against the origin recorded in
+   * DoSetOrigin are ever used.
+   *
    * @returns The current real time, in ns.
    */
-  uint64_t GetRealtime (void);
+  virtual uint64_t GetRealtime (void);
   /**
    * @brief Get the current normalized real time, in ns.
    *
@@ -830,6 +830,112 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for compiled Config paths and their memoized match sets.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Trace sink.
+   * \param context The trace context.
+   * \param oldValue The old value.
+   * \param newValue The new value.
+   */
+  void Trace (std::string context, int16_t oldValue, int16_t newValue);
+
+  std::string m_context;  //!< Context of the last trace.
+  int16_t m_got;          //!< Value of the last trace.
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that compiled Config paths match and memoize the same objects as path strings")
+{
+}
+
+void
+CompiledPathConfigTestCase::Trace (std::string context, int16_t oldValue, int16_t newValue)
+{
+  NS_UNUSED (oldValue);
+  m_context = context;
+  m_got = newValue;
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj2 = CreateObject<ConfigTestObject> ();
+  a->AddNodeB (obj0);
+  a->AddNodeB (obj1);
+  a->AddNodeB (obj2);
+
+  //
+  // A compiled path sets the same attributes as the path string.
+  //
+  Config::Path set ("/NodeA/NodesB/[0-1]/A");
+  set.Set (IntegerValue (-5));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -5, "Object Attribute \"A\" not set as expected");
+  obj1->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -5, "Object Attribute \"A\" not set as expected");
+  obj2->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+
+  //
+  // And it finds the same objects, in the same order.
+  //
+  Config::Path source ("/NodeA/NodesB/*/Source");
+  Config::MatchContainer compiled = source.LookupMatches ();
+  Config::MatchContainer parsed = Config::LookupMatches ("/NodeA/NodesB/*");
+  NS_TEST_ASSERT_MSG_EQ (compiled.GetN (), parsed.GetN (), "Compiled path matched a different number of objects");
+  for (std::size_t i = 0; i < compiled.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (compiled.Get (i), parsed.Get (i), "Compiled path matched a different object");
+      NS_TEST_ASSERT_MSG_EQ (compiled.GetMatchedPath (i), parsed.GetMatchedPath (i), "Compiled path matched a different context");
+    }
+
+  //
+  // A memoized path keeps its match set until it is invalidated.
+  //
+  source.SetMemoize (true);
+  std::size_t n = source.LookupMatches ().GetN ();
+  Ptr<ConfigTestObject> obj3 = CreateObject<ConfigTestObject> ();
+  a->AddNodeB (obj3);
+  NS_TEST_ASSERT_MSG_EQ (source.LookupMatches ().GetN (), n, "Memoized match set unexpectedly changed");
+  Config::InvalidateMatchCache ();
+  NS_TEST_ASSERT_MSG_EQ (source.LookupMatches ().GetN (), n + 1, "Memoized match set not invalidated");
+
+  //
+  // Connect through the memoized match set.
+  //
+  m_got = 0;
+  source.Connect (MakeCallback (&CompiledPathConfigTestCase::Trace, this));
+  obj3->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_got, -3, "Trace not connected through compiled path");
+  NS_TEST_ASSERT_MSG_EQ (m_context, "/NodeA/NodesB/3/Source", "Unexpected trace context");
+  source.Disconnect (MakeCallback (&CompiledPathConfigTestCase::Trace, this));
+  obj3->SetAttribute ("Source", IntegerValue (-4));
+  NS_TEST_ASSERT_MSG_EQ (m_got, -3, "Trace not disconnected through compiled path");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +954,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
 }
 
 /**
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/wall-clock-synchronizer.h"
+#include "ns3/hybrid-wall-clock-synchronizer.h"
+
+#include <numeric>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup realtime
+ * HybridWallClockSynchronizer test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * Check that the hybrid synchronizer never fires an event early and
+ * accounts every completed wait in its jitter histogram.
+ */
+class HybridWallClockSynchronizerTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  HybridWallClockSynchronizerTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /** Event checking real time against simulation time. */
+  void Event (void);
+  /**
+   * Jitter trace sink.
+   * \param [in] jitter The lateness of a completed wait.
+   */
+  void Jitter (Time jitter);
+
+  uint32_t m_events;     //!< Number of events run.
+  uint32_t m_early;      //!< Number of events run before their real time.
+  uint64_t m_traced;     //!< Number of jitter trace invocations.
+};
+
+HybridWallClockSynchronizerTestCase::HybridWallClockSynchronizerTestCase ()
+  : TestCase ("Check the hybrid sleep and spin wall clock synchronizer")
+{
+}
+
+void
+HybridWallClockSynchronizerTestCase::DoSetup (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType",
+                     StringValue ("ns3::RealtimeSimulatorImpl"));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (HybridWallClockSynchronizer::GetTypeId ()));
+}
+
+void
+HybridWallClockSynchronizerTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (WallClockSynchronizer::GetTypeId ()));
+  Config::SetGlobal ("SimulatorImplementationType",
+                     StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+HybridWallClockSynchronizerTestCase::Event (void)
+{
+  ++m_events;
+  Ptr<RealtimeSimulatorImpl> impl =
+    DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl->RealtimeNow () < Simulator::Now ())
+    {
+      ++m_early;
+    }
+}
+
+void
+HybridWallClockSynchronizerTestCase::Jitter (Time)
+{
+  ++m_traced;
+}
+
+void
+HybridWallClockSynchronizerTestCase::DoRun (void)
+{
+  m_events = 0;
+  m_early = 0;
+  m_traced = 0;
+
+  Ptr<RealtimeSimulatorImpl> impl =
+    DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not running the realtime simulator");
+  Ptr<HybridWallClockSynchronizer> sync =
+    DynamicCast<HybridWallClockSynchronizer> (impl->GetSynchronizer ());
+  NS_TEST_ASSERT_MSG_NE (sync, 0, "SynchronizerType was not honored");
+  sync->TraceConnectWithoutContext
+    ("Jitter", MakeCallback (&HybridWallClockSynchronizerTestCase::Jitter, this));
+
+  for (uint32_t i = 1; i <= 20; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (i),
+                           &HybridWallClockSynchronizerTestCase::Event, this);
+    }
+  Simulator::Stop (MilliSeconds (25));
+  Simulator::Run ();
+
+  std::vector<uint64_t> histogram = sync->GetJitterHistogram ();
+  uint64_t total = std::accumulate (histogram.begin (), histogram.end (), (uint64_t)0);
+  uint64_t samples = sync->GetJitterSamples ();
+  Time maxJitter = sync->GetMaxJitter ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_events, 20, "Not all events ran");
+  NS_TEST_EXPECT_MSG_EQ (m_early, 0, "Events ran before their real time");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (samples, 20, "Missing jitter samples");
+  NS_TEST_EXPECT_MSG_EQ (total, samples, "Histogram does not account all samples");
+  NS_TEST_EXPECT_MSG_EQ (m_traced, samples, "Jitter trace not fired for every sample");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (maxJitter, Seconds (0), "Negative jitter");
+}
+
+
+/**
+ * \ingroup core-tests
+ * HybridWallClockSynchronizer test suite.
+ */
+class HybridWallClockSynchronizerTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  HybridWallClockSynchronizerTestSuite ()
+    : TestSuite ("hybrid-wall-clock-synchronizer")
+  {
+    AddTestCase (new HybridWallClockSynchronizerTestCase ());
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * HybridWallClockSynchronizerTestSuite instance variable.
+ */
+static HybridWallClockSynchronizerTestSuite g_hybridWallClockSynchronizerTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * RandomVariableStream::GetValues test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that RandomVariableStream::GetValues returns exactly the values
+ * of the same number of GetValue calls, and leaves the stream in the
+ * same state.
+ */
+class RandomVariableStreamBatchTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] factory The factory for the random variable to test,
+   *             with its attributes set.
+   * \param [in] name A description of the configuration.
+   */
+  RandomVariableStreamBatchTestCase (ObjectFactory factory, std::string name);
+
+private:
+  virtual void DoRun (void);
+
+  /** The factory for the random variable to test. */
+  ObjectFactory m_factory;
+};
+
+RandomVariableStreamBatchTestCase::RandomVariableStreamBatchTestCase (ObjectFactory factory,
+                                                                      std::string name)
+  : TestCase ("Check GetValues against GetValue for " + name),
+    m_factory (factory)
+{
+}
+
+void
+RandomVariableStreamBatchTestCase::DoRun (void)
+{
+  // Use the same fixed stream for both, so they generate the same sequence.
+  const int64_t stream = 42;
+  Ptr<RandomVariableStream> scalar = m_factory.Create<RandomVariableStream> ();
+  scalar->SetStream (stream);
+  Ptr<RandomVariableStream> batch = m_factory.Create<RandomVariableStream> ();
+  batch->SetStream (stream);
+
+  // Check several block sizes, so that blocks start at different
+  // points in the sequence.
+  const std::size_t sizes[] = { 1, 7, 64, 1000 };
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      std::size_t n = sizes[s];
+      std::vector<double> values (n);
+      batch->GetValues (&values[0], n);
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          double expected = scalar->GetValue ();
+          NS_TEST_ASSERT_MSG_EQ (values[i], expected,
+                                 "Value " << i << " of a block of " << n << " differs");
+        }
+    }
+  batch->GetValues (0, 0);
+  NS_TEST_ASSERT_MSG_EQ (batch->GetValue (), scalar->GetValue (),
+                         "Streams out of step after GetValues");
+}
+
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStream::GetValues test suite.
+ */
+class RandomVariableStreamBatchTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RandomVariableStreamBatchTestSuite ();
+
+private:
+  /**
+   * Add test cases for a random variable, with and without antithetic values.
+   * \param [in] factory The factory for the random variable to test.
+   * \param [in] name A description of the configuration.
+   */
+  void AddBatchTestCases (ObjectFactory factory, std::string name);
+};
+
+RandomVariableStreamBatchTestSuite::RandomVariableStreamBatchTestSuite ()
+  : TestSuite ("random-variable-stream-batch", UNIT)
+{
+  ObjectFactory factory;
+
+  factory.SetTypeId ("ns3::UniformRandomVariable");
+  factory.Set ("Min", DoubleValue (-3.0));
+  factory.Set ("Max", DoubleValue (11.0));
+  AddBatchTestCases (factory, "uniform");
+
+  factory = ObjectFactory ("ns3::ConstantRandomVariable");
+  factory.Set ("Constant", DoubleValue (2.5));
+  AddBatchTestCases (factory, "constant");
+
+  factory = ObjectFactory ("ns3::ExponentialRandomVariable");
+  factory.Set ("Mean", DoubleValue (3.0));
+  AddBatchTestCases (factory, "unbounded exponential");
+  factory.Set ("Bound", DoubleValue (4.0));
+  AddBatchTestCases (factory, "bounded exponential");
+
+  factory = ObjectFactory ("ns3::ParetoRandomVariable");
+  factory.Set ("Scale", DoubleValue (1.0));
+  factory.Set ("Shape", DoubleValue (1.5));
+  AddBatchTestCases (factory, "unbounded pareto");
+  factory.Set ("Bound", DoubleValue (3.0));
+  AddBatchTestCases (factory, "bounded pareto");
+
+  factory = ObjectFactory ("ns3::WeibullRandomVariable");
+  factory.Set ("Scale", DoubleValue (2.0));
+  factory.Set ("Shape", DoubleValue (0.8));
+  AddBatchTestCases (factory, "unbounded weibull");
+  factory.Set ("Bound", DoubleValue (2.0));
+  AddBatchTestCases (factory, "bounded weibull");
+
+  // Distributions without a batch override use the default implementation.
+  factory = ObjectFactory ("ns3::NormalRandomVariable");
+  factory.Set ("Mean", DoubleValue (5.0));
+  factory.Set ("Variance", DoubleValue (2.0));
+  AddBatchTestCases (factory, "normal");
+}
+
+void
+RandomVariableStreamBatchTestSuite::AddBatchTestCases (ObjectFactory factory,
+                                                       std::string name)
+{
+  factory.Set ("Antithetic", BooleanValue (false));
+  AddTestCase (new RandomVariableStreamBatchTestCase (factory, name));
+  factory.Set ("Antithetic", BooleanValue (true));
+  AddTestCase (new RandomVariableStreamBatchTestCase (factory, "antithetic " + name));
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStreamBatchTestSuite instance variable.
+ */
+static RandomVariableStreamBatchTestSuite g_randomVariableStreamBatchTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulation-context.h"
+#include "ns3/config.h"
+#include "ns3/names.h"
+#include "ns3/object.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/system-thread.h"
+
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * SimulationContext test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * Run a small simulation whose outcome depends on the random
+ * number generator run.
+ */
+class Replication
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] run The RngRun to use.
+   */
+  Replication (uint64_t run);
+  /** Run the replication in the current context. */
+  void Run (void);
+  /** Run the replication in a new context. */
+  void RunInContext (void);
+
+  uint64_t m_run;                //!< The RngRun.
+  std::vector<double> m_times;   //!< The times of the events, in s.
+  uint64_t m_stream;             //!< The first automatic stream allocated.
+
+private:
+  /** Record the event time and schedule the next event. */
+  void Event (void);
+
+  /** The event interval. */
+  Ptr<ExponentialRandomVariable> m_interval;
+};
+
+Replication::Replication (uint64_t run)
+  : m_run (run),
+    m_stream (0)
+{
+}
+
+void
+Replication::Run (void)
+{
+  RngSeedManager::SetRun (m_run);
+  m_stream = RngSeedManager::GetNextStreamIndex ();
+  m_interval = CreateObject<ExponentialRandomVariable> ();
+  Simulator::Schedule (Seconds (m_interval->GetValue ()), &Replication::Event, this);
+  Simulator::Stop (Seconds (50));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_interval = 0;
+}
+
+void
+Replication::RunInContext (void)
+{
+  SimulationContext::Enter (Create<SimulationContext> ());
+  Run ();
+  SimulationContext::Leave ();
+}
+
+void
+Replication::Event (void)
+{
+  m_times.push_back (Simulator::Now ().GetSeconds ());
+  Simulator::Schedule (Seconds (m_interval->GetValue ()), &Replication::Event, this);
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that a SimulationContext isolates the simulator, the global
+ * values, the stream allocation, the names and the Config root namespace
+ * from the default context.
+ */
+class SimulationContextIsolationTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  SimulationContextIsolationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SimulationContextIsolationTestCase::SimulationContextIsolationTestCase ()
+  : TestCase ("Check that a simulation context isolates the simulation registries")
+{
+}
+
+void
+SimulationContextIsolationTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+  Ptr<Object> named = CreateObject<Object> ();
+  Names::Add ("/Names/SimulationContextTest", named);
+  std::size_t roots = Config::GetRootNamespaceObjectN ();
+  Simulator::Schedule (Seconds (10), &Simulator::Stop);
+
+  NS_TEST_ASSERT_MSG_EQ (SimulationContext::GetCurrent ()->IsDefault (), true,
+                         "Not in the default context");
+  Ptr<SimulationContext> context = Create<SimulationContext> ();
+  SimulationContext::Enter (context);
+  NS_TEST_ASSERT_MSG_EQ (SimulationContext::GetCurrent (), PeekPointer (context),
+                         "Context not entered");
+
+  // The global values start from those of the default context,
+  // and changes stay in this context.
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::GetRun (), run, "Global value not inherited");
+  RngSeedManager::SetRun (run + 7);
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::GetRun (), run + 7, "Global value not set");
+
+  NS_TEST_EXPECT_MSG_EQ (Names::Find<Object> ("/Names/SimulationContextTest"), 0,
+                         "Name of the default context visible");
+  Names::Add ("/Names/SimulationContextTest", CreateObject<Object> ());
+  NS_TEST_EXPECT_MSG_EQ (Config::GetRootNamespaceObjectN (), 0,
+                         "Config roots of the default context visible");
+  Config::RegisterRootNamespaceObject (CreateObject<Object> ());
+
+  // The simulator of this context has no events.
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsFinished (), true, "Simulator shared");
+  Simulator::Schedule (Seconds (3), &Simulator::Stop);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (3), "Wrong simulator run");
+  Simulator::Destroy ();
+
+  SimulationContext::Leave ();
+  context = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (SimulationContext::GetCurrent ()->IsDefault (), true,
+                         "Default context not restored");
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::GetRun (), run, "Global value leaked");
+  NS_TEST_EXPECT_MSG_EQ (Names::Find<Object> ("/Names/SimulationContextTest"), named,
+                         "Name of the default context lost");
+  NS_TEST_EXPECT_MSG_EQ (Config::GetRootNamespaceObjectN (), roots,
+                         "Config roots leaked");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (0), "Simulator time leaked");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (10), "Default simulator lost its events");
+  Simulator::Destroy ();
+  Names::Clear ();
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that replications run concurrently in separate contexts give
+ * the same results as when run one after the other.
+ */
+class SimulationContextThreadsTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  SimulationContextThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SimulationContextThreadsTestCase::SimulationContextThreadsTestCase ()
+  : TestCase ("Check that concurrent replications in separate contexts are reproducible")
+{
+}
+
+void
+SimulationContextThreadsTestCase::DoRun (void)
+{
+  const uint32_t replications = 4;
+  uint64_t run = RngSeedManager::GetRun ();
+
+  std::vector<Replication *> sequential;
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      sequential.push_back (new Replication (i + 1));
+      sequential[i]->RunInContext ();
+    }
+
+  std::vector<Replication *> concurrent;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      concurrent.push_back (new Replication (i + 1));
+      threads.push_back (Create<SystemThread>
+                           (MakeCallback (&Replication::RunInContext, concurrent[i])));
+    }
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      threads[i]->Start ();
+    }
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      threads[i]->Join ();
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::GetRun (), run, "Replications changed the default run");
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      NS_TEST_EXPECT_MSG_GT (sequential[i]->m_times.size (), 10, "Too few events");
+      NS_TEST_EXPECT_MSG_EQ (concurrent[i]->m_stream, sequential[i]->m_stream,
+                             "Different stream allocation in replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (concurrent[i]->m_times.size (), sequential[i]->m_times.size (),
+                             "Different event count in replication " << i);
+      bool same = concurrent[i]->m_times == sequential[i]->m_times;
+      NS_TEST_EXPECT_MSG_EQ (same, true, "Different event times in replication " << i);
+      if (i > 0)
+        {
+          bool differ = sequential[i]->m_times != sequential[0]->m_times;
+          NS_TEST_EXPECT_MSG_EQ (differ, true, "RngRun not honored in replication " << i);
+        }
+      delete sequential[i];
+      delete concurrent[i];
+    }
+}
+
+
+/**
+ * \ingroup core-tests
+ * SimulationContext test suite.
+ */
+class SimulationContextTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  SimulationContextTestSuite ()
+    : TestSuite ("simulation-context")
+  {
+    AddTestCase (new SimulationContextIsolationTestCase ());
+    AddTestCase (new SimulationContextThreadsTestCase ());
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * SimulationContextTestSuite instance variable.
+ */
+static SimulationContextTestSuite g_simulationContextTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
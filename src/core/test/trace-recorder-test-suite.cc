@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/trace-recorder.h"
+#include "ns3/simulator.h"
+#include "ns3/names.h"
+#include "ns3/log.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/system-thread.h"
+
+#include <cstring>
+#include <string>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup tracing
+ * TraceRecorder test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * An object with trace sources to record.
+ */
+class TraceRecorderTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TracedCallback<uint32_t> m_count;   //!< Count TraceSource target.
+  TracedValue<double> m_value;        //!< Value TraceSource target.
+};
+
+TypeId
+TraceRecorderTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::tests::TraceRecorderTestObject")
+    .SetParent<Object> ()
+    .AddTraceSource ("Count", "A count.",
+                     MakeTraceSourceAccessor (&TraceRecorderTestObject::m_count),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("Value", "A value.",
+                     MakeTraceSourceAccessor (&TraceRecorderTestObject::m_value),
+                     "ns3::TracedValueCallback::Double")
+  ;
+  return tid;
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that traced values and log lines are read back from a recording
+ * with their time and data.
+ */
+class TraceRecorderSourcesTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TraceRecorderSourcesTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Fire the trace sources and log a line.
+   * \param [in] object The object with the trace sources.
+   */
+  static void Fire (Ptr<TraceRecorderTestObject> object);
+};
+
+TraceRecorderSourcesTestCase::TraceRecorderSourcesTestCase ()
+  : TestCase ("Check that trace sources and log lines are recorded")
+{
+}
+
+void
+TraceRecorderSourcesTestCase::Fire (Ptr<TraceRecorderTestObject> object)
+{
+  object->m_count (7);
+  object->m_value = 2.5;
+  NS_LOG_UNCOND ("A log line which is longer than the data of the first slot of a record");
+}
+
+void
+TraceRecorderSourcesTestCase::DoRun (void)
+{
+  Ptr<TraceRecorderTestObject> object = CreateObject<TraceRecorderTestObject> ();
+  Names::Add ("TraceRecorderTest", object);
+  std::string filename = CreateTempDirFilename ("trace-recorder.bin");
+
+  NS_TEST_ASSERT_MSG_EQ (TraceRecorder::Enable (filename), true, "Cannot open " << filename);
+  std::size_t count = TraceRecorder::Connect<uint32_t> ("/Names/TraceRecorderTest/Count");
+  NS_TEST_EXPECT_MSG_EQ (count, 1, "Count not connected");
+  count = TraceRecorder::ConnectTracedValue<double> ("/Names/TraceRecorderTest/Value");
+  NS_TEST_EXPECT_MSG_EQ (count, 1, "Value not connected");
+  TraceRecorder::RecordLog (true);
+  Simulator::Schedule (Seconds (1), &TraceRecorderSourcesTestCase::Fire, object);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  TraceRecorder::Disable ();
+  NS_TEST_EXPECT_MSG_EQ (TraceRecorder::IsEnabled (), false, "Recorder not disabled");
+  Names::Clear ();
+
+  TraceRecording recording (filename);
+  NS_TEST_ASSERT_MSG_EQ (recording.IsOk (), true, "Invalid recording");
+  TraceRecording::Record record;
+  bool count7 = false;
+  bool value = false;
+  bool log = false;
+  while (recording.Next (record))
+    {
+      const struct TraceRecording::Source *source = recording.GetSource (record.source);
+      NS_TEST_ASSERT_MSG_NE (source, 0, "Record of an unknown source");
+      NS_TEST_EXPECT_MSG_EQ (record.time, Seconds (1).GetTimeStep (), "Wrong time");
+      NS_TEST_EXPECT_MSG_EQ (record.data.size (), record.length, "Data not captured");
+      if (source->name == "/Names/TraceRecorderTest/Count")
+        {
+          double v;
+          memcpy (&v, record.data.data (), sizeof (v));
+          count7 = source->type == TraceRecorder::VALUES && v == 7;
+        }
+      else if (source->name == "/Names/TraceRecorderTest/Value")
+        {
+          double v;
+          memcpy (&v, record.data.data (), sizeof (v));
+          value = source->type == TraceRecorder::VALUES && v == 2.5;
+        }
+      else if (source->name == "log")
+        {
+          std::string line (record.data.begin (), record.data.end ());
+          log = source->type == TraceRecorder::TEXT
+            && line == "A log line which is longer than the data of the first slot of a record";
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (recording.IsOk (), true, "Invalid recording");
+  NS_TEST_EXPECT_MSG_EQ (count7, true, "Count not recorded");
+  NS_TEST_EXPECT_MSG_EQ (value, true, "Value not recorded");
+  NS_TEST_EXPECT_MSG_EQ (log, true, "Log line not recorded");
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that the records of several threads, spanning many buffers,
+ * are all written.
+ */
+class TraceRecorderThreadsTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TraceRecorderThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a sequence of values.
+   * \param [in] source The source of the records.
+   */
+  static void RecordSequence (uint16_t source);
+
+  /** The number of records of each thread. */
+  static const uint32_t RECORDS = 20000;
+};
+
+TraceRecorderThreadsTestCase::TraceRecorderThreadsTestCase ()
+  : TestCase ("Check that the records of concurrent threads are all written")
+{
+}
+
+void
+TraceRecorderThreadsTestCase::RecordSequence (uint16_t source)
+{
+  for (uint32_t i = 0; i < RECORDS; ++i)
+    {
+      TraceRecorder::Record (source, reinterpret_cast<const uint8_t *> (&i), sizeof (i));
+    }
+}
+
+void
+TraceRecorderThreadsTestCase::DoRun (void)
+{
+  const uint32_t threads = 3;
+  std::string filename = CreateTempDirFilename ("trace-recorder-threads.bin");
+  NS_TEST_ASSERT_MSG_EQ (TraceRecorder::Enable (filename), true, "Cannot open " << filename);
+
+  std::vector<uint16_t> sources;
+  std::vector<Ptr<SystemThread> > workers;
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      sources.push_back (TraceRecorder::RegisterSource ("thread", TraceRecorder::VALUES));
+      workers.push_back (Create<SystemThread>
+                           (MakeBoundCallback (&TraceRecorderThreadsTestCase::RecordSequence,
+                                               sources[i])));
+    }
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      workers[i]->Start ();
+    }
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      workers[i]->Join ();
+    }
+  TraceRecorder::Disable ();
+
+  std::map<uint16_t, uint32_t> next;
+  bool ordered = true;
+  TraceRecording recording (filename);
+  TraceRecording::Record record;
+  while (recording.Next (record))
+    {
+      uint32_t value;
+      memcpy (&value, record.data.data (), sizeof (value));
+      ordered = ordered && value == next[record.source]++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (recording.IsOk (), true, "Invalid recording");
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Records lost or out of order");
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (next[sources[i]], RECORDS, "Records lost for thread " << i);
+    }
+}
+
+
+/**
+ * \ingroup core-tests
+ * TraceRecorder test suite.
+ */
+class TraceRecorderTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  TraceRecorderTestSuite ()
+    : TestSuite ("trace-recorder")
+  {
+    AddTestCase (new TraceRecorderSourcesTestCase ());
+    AddTestCase (new TraceRecorderThreadsTestCase ());
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * TraceRecorderTestSuite instance variable.
+ */
+static TraceRecorderTestSuite g_traceRecorderTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
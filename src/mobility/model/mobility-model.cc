@@ -22,6 +22,7 @@
 
 #include "mobility-model.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/node-arena.h"
 
 namespace ns3 {
 
@@ -60,6 +61,18 @@ MobilityModel::~MobilityModel ()
 {
 }
 
+void *
+MobilityModel::operator new (std::size_t size)
+{
+  return NodeArena::Allocate (size);
+}
+
+void
+MobilityModel::operator delete (void *object)
+{
+  NodeArena::Deallocate (object);
+}
+
 Vector
 MobilityModel::GetPosition (void) const
 {
@@ -47,6 +47,19 @@ public:
   MobilityModel ();
   virtual ~MobilityModel () = 0;
 
+  /**
+   * Allocate the memory of a mobility model in the NodeArena of the current
+   * simulation.
+   * \param [in] size The size of the mobility model.
+   * \returns The memory of the mobility model.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Release the memory of a mobility model.
+   * \param [in] object The memory of the mobility model.
+   */
+  static void operator delete (void *object);
+
   /**
    * \return the current position
    */
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "trace-recorder-helper.h"
+#include "ns3/pcap-file.h"
+#include "ns3/log.h"
+
+#include <map>
+#include <sstream>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceRecorderHelper");
+
+std::size_t
+TraceRecorderHelper::EnablePackets (std::string path,
+                                    PcapHelper::DataLinkType dataLinkType,
+                                    char event)
+{
+  NS_LOG_FUNCTION (path << dataLinkType << event);
+  return TraceRecorder::Connect<Ptr<const Packet> > (path, dataLinkType, event);
+}
+
+bool
+TraceRecorderHelper::WriteAscii (std::string recording, std::ostream &os)
+{
+  NS_LOG_FUNCTION (recording << &os);
+  TraceRecording reader (recording);
+  double stepsPerSecond = reader.GetStepsPerSecond ();
+  TraceRecording::Record record;
+  while (reader.Next (record))
+    {
+      const struct TraceRecording::Source *source = reader.GetSource (record.source);
+      if (source == 0)
+        {
+          NS_LOG_WARN ("Record of unknown source " << record.source);
+          continue;
+        }
+      double seconds = record.time / stepsPerSecond;
+      switch (source->type)
+        {
+        case TraceRecorder::TEXT:
+          os << std::string (record.data.begin (), record.data.end ()) << std::endl;
+          break;
+        case TraceRecorder::PACKET:
+          os << source->event << " " << seconds << " " << source->name
+             << " length: " << record.length << std::endl;
+          break;
+        case TraceRecorder::VALUES:
+          os << seconds << " " << source->name;
+          for (std::size_t i = 0; i + sizeof (double) <= record.data.size (); i += sizeof (double))
+            {
+              double value;
+              memcpy (&value, &record.data[i], sizeof (double));
+              os << " " << value;
+            }
+          os << std::endl;
+          break;
+        }
+    }
+  return reader.IsOk ();
+}
+
+std::size_t
+TraceRecorderHelper::WritePcap (std::string recording, std::string prefix,
+                                std::ostream &index)
+{
+  NS_LOG_FUNCTION (recording << prefix << &index);
+
+  // The pcap snap length of each source is the largest capture of its
+  // records, which are only known after a first pass.
+  std::map<uint16_t, uint32_t> snapLengths;
+  {
+    TraceRecording reader (recording);
+    TraceRecording::Record record;
+    while (reader.Next (record))
+      {
+        const struct TraceRecording::Source *source = reader.GetSource (record.source);
+        if (source != 0 && source->type == TraceRecorder::PACKET)
+          {
+            uint32_t &snapLength = snapLengths[record.source];
+            snapLength = std::max<uint32_t> (snapLength, record.data.size ());
+          }
+      }
+    if (!reader.IsOk ())
+      {
+        NS_LOG_WARN ("Invalid recording " << recording);
+      }
+  }
+
+  TraceRecording reader (recording);
+  int64_t stepsPerSecond = reader.GetStepsPerSecond ();
+  std::map<uint16_t, PcapFile *> files;
+  TraceRecording::Record record;
+  while (reader.Next (record))
+    {
+      std::map<uint16_t, uint32_t>::const_iterator snap = snapLengths.find (record.source);
+      if (snap == snapLengths.end ())
+        {
+          continue;
+        }
+      PcapFile *&file = files[record.source];
+      if (file == 0)
+        {
+          const struct TraceRecording::Source *source = reader.GetSource (record.source);
+          std::ostringstream filename;
+          filename << prefix << "-" << record.source << ".pcap";
+          file = new PcapFile ();
+          file->Open (filename.str (), std::ios::out);
+          file->Init (source->linkType, std::max<uint32_t> (snap->second, 1));
+          index << record.source << " " << source->name << std::endl;
+        }
+      // The snap length may have changed while recording.
+      record.data.resize (std::min (record.length, snap->second));
+      uint32_t seconds = record.time / stepsPerSecond;
+      uint32_t microSeconds = (record.time % stepsPerSecond) * 1e6 / stepsPerSecond;
+      file->Write (seconds, microSeconds, record.data.data (), record.length);
+    }
+  for (std::map<uint16_t, PcapFile *>::iterator i = files.begin (); i != files.end (); ++i)
+    {
+      i->second->Close ();
+      delete i->second;
+    }
+  return files.size ();
+}
+
+} // namespace ns3
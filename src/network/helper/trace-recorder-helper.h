@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_RECORDER_HELPER_H
+#define TRACE_RECORDER_HELPER_H
+
+#include "ns3/trace-recorder.h"
+#include "ns3/packet.h"
+#include "ns3/trace-helper.h"
+
+#include <ostream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup tracing
+ * TraceRecordTraits specialization recording the bytes of a packet.
+ */
+template <>
+struct TraceRecordTraits<Ptr<const Packet> >
+{
+  /** \copydoc TraceRecordTraits::type */
+  static const enum TraceRecorder::SourceType type = TraceRecorder::PACKET;
+  /** \copydoc TraceRecordTraits::GetLength */
+  static uint32_t GetLength (Ptr<const Packet> packet)
+  {
+    return packet->GetSize ();
+  }
+  /** \copydoc TraceRecordTraits::Copy */
+  static void Copy (Ptr<const Packet> packet, uint8_t *data, uint32_t captured)
+  {
+    packet->CopyData (data, captured);
+  }
+};
+
+/**
+ * \ingroup tracing
+ * \brief Record packet trace sources with the TraceRecorder, and
+ * convert recordings to the ASCII and pcap trace formats.
+ *
+ * Recording packets is much cheaper than writing them to ASCII or pcap
+ * traces while the simulation runs:
+ *
+ * \code
+ *   TraceRecorder::Enable ("trace.bin");
+ *   TraceRecorderHelper::EnablePackets
+ *     ("/NodeList/0/DeviceList/0/$ns3::PointToPointNetDevice/MacRx",
+ *      PcapHelper::DLT_PPP, 'r');
+ *   Simulator::Run ();
+ *   TraceRecorder::Disable ();
+ * \endcode
+ *
+ * The recording is then converted offline, either with this class or
+ * with the trace-recording-decoder program.
+ */
+class TraceRecorderHelper
+{
+public:
+  /**
+   * Record the packets of trace sources with a Ptr<const Packet> argument.
+   *
+   * \param [in] path The Config path of the trace sources.
+   * \param [in] dataLinkType The pcap data link type of the packets.
+   * \param [in] event The ASCII trace event character, such as '+',
+   *             '-', 'd', 'r' or 't'.
+   * \returns The number of trace sources connected.
+   */
+  static std::size_t EnablePackets (std::string path,
+                                    PcapHelper::DataLinkType dataLinkType,
+                                    char event = 't');
+
+  /**
+   * Write a recording in text form.
+   *
+   * Log lines are written as they were logged.  Packets are written as
+   * ASCII trace lines holding the event, the time, the trace source
+   * path and the packet length.  Values are written after the time
+   * and the trace source path.
+   *
+   * \param [in] recording The name of the recording.
+   * \param [in] os The stream to write to.
+   * \returns \c true if the recording was valid.
+   */
+  static bool WriteAscii (std::string recording, std::ostream &os);
+  /**
+   * Write the packets of a recording to pcap files, one for each
+   * recorded trace source.
+   *
+   * The files are named \p prefix-<id>.pcap after the source ids, and
+   * \p index receives one "<id> <trace source path>" line per file.
+   *
+   * \param [in] recording The name of the recording.
+   * \param [in] prefix The prefix of the pcap file names.
+   * \param [in] index The stream receiving the names of the sources.
+   * \returns The number of pcap files written.
+   */
+  static std::size_t WritePcap (std::string recording, std::string prefix,
+                                std::ostream &index);
+};
+
+} // namespace ns3
+
+#endif /* TRACE_RECORDER_HELPER_H */
@@ -20,6 +20,7 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/unused.h"
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -50,139 +51,40 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
-#ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+thread_local PacketAllocator Buffer::g_allocator;
 
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  uint8_t *buf = reinterpret_cast<uint8_t *> (data);
+  g_allocator.Deallocate (buf, data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
-    }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
-  return data;
-}
-#else /* BUFFER_FREE_LIST */
-void
-Buffer::Recycle (struct Buffer::Data *data)
-{
-  NS_LOG_FUNCTION (data);
-  NS_ASSERT (data->m_count == 0);
-  Deallocate (data);
-}
-
-Buffer::Data *
-Buffer::Create (uint32_t size)
-{
-  NS_LOG_FUNCTION (size);
-  return Allocate (size);
-}
-#endif /* BUFFER_FREE_LIST */
-
-struct Buffer::Data *
-Buffer::Allocate (uint32_t reqSize)
-{
-  NS_LOG_FUNCTION (reqSize);
-  if (reqSize == 0) 
+  if (dataSize == 0) 
     {
-      reqSize = 1;
+      dataSize = 1;
     }
-  NS_ASSERT (reqSize >= 1);
-  uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
-  uint8_t *b = new uint8_t [size];
-  struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
-  data->m_size = reqSize;
+  uint32_t size = dataSize - 1 + sizeof (struct Buffer::Data);
+  uint8_t *buf = g_allocator.Allocate (size);
+  struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(buf);
+  // The block may be larger than requested: make all of it usable.
+  data->m_size = size + 1 - sizeof (struct Buffer::Data);
   data->m_count = 1;
   return data;
 }
 
-void
-Buffer::Deallocate (struct Buffer::Data *data)
+struct PacketAllocator::Statistics
+Buffer::GetAllocationStatistics (void)
 {
-  NS_LOG_FUNCTION (data);
-  NS_ASSERT (data->m_count == 0);
-  uint8_t *buf = reinterpret_cast<uint8_t *> (data);
-  delete [] buf;
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_allocator.GetStatistics ();
 }
 
 Buffer::Buffer ()
@@ -400,19 +302,39 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  if (m_end == m_zeroAreaEnd &&
       o.m_start == o.m_zeroAreaStart &&
-      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
+      oZeroSize > 0)
     {
       /**
        * This is an optimization which kicks in when
        * we attempt to aggregate two buffers which contain
        * adjacent zero areas.
        */
-      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
-      m_zeroAreaEnd += zeroSize;
+      if (m_data->m_count > 1 || m_end != m_data->m_dirtyEnd)
+        {
+          /* The data is shared: the zero area can only grow
+           * once the real bytes of this buffer are private.
+           */
+          uint32_t internalSize = GetInternalSize ();
+          struct Buffer::Data *newData = Buffer::Create (internalSize);
+          memcpy (newData->m_data, m_data->m_data + m_start, internalSize);
+          m_data->m_count--;
+          if (m_data->m_count == 0)
+            {
+              Buffer::Recycle (m_data);
+            }
+          m_data = newData;
+
+          int32_t delta = -m_start;
+          m_zeroAreaStart += delta;
+          m_zeroAreaEnd += delta;
+          m_end += delta;
+          m_start += delta;
+          m_data->m_dirtyStart = m_start;
+        }
+      m_zeroAreaEnd += oZeroSize;
       m_end = m_zeroAreaEnd;
       m_data->m_dirtyEnd = m_zeroAreaEnd;
       uint32_t endData = o.m_end - o.m_zeroAreaEnd;
@@ -422,11 +344,29 @@ Buffer::AddAtEnd (const Buffer &o)
       Buffer::Iterator src = o.End ();
       src.Prev (endData);
       dst.Write (src, o.End ());
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
       NS_ASSERT (CheckInternalState ());
       return;
     }
 
-  *this = CreateFullCopy ();
+  /* Otherwise, the result can only hold one of the two zero areas:
+   * keep the larger one, and write the other one as real zeroes.
+   */
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  if (oZeroSize > zeroSize && m_data != o.m_data)
+    {
+      Buffer tmp = o;
+      tmp.AddAtStart (GetSize ());
+      tmp.Begin ().Write (Begin (), End ());
+      *this = tmp;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (m_data == o.m_data)
+    {
+      // Writing o may not read from the data written to.
+      *this = CreateFullCopy ();
+    }
   AddAtEnd (o.GetSize ());
   Buffer::Iterator destStart = End ();
   destStart.Prev (o.GetSize ());
@@ -843,111 +783,171 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // The bytes written may lie after the zero area of this buffer.
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
+}
+
+void
+Buffer::Iterator::WriteLsbFirst (uint64_t data, uint32_t size)
+{
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
+                 GetWriteErrorMessage ());
+  uint8_t *buffer = GetContiguous (size);
+  if (buffer == 0)
+    {
+      for (uint32_t i = 0; i < size; i++)
+        {
+          WriteU8 (data & 0xff);
+          data >>= 8;
+        }
+      return;
+    }
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buffer[i] = data & 0xff;
+      data >>= 8;
+    }
+  m_current += size;
+}
+void
+Buffer::Iterator::WriteMsbFirst (uint64_t data, uint32_t size)
+{
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
+                 GetWriteErrorMessage ());
+  uint8_t *buffer = GetContiguous (size);
+  if (buffer == 0)
+    {
+      for (uint32_t i = size; i > 0; i--)
+        {
+          WriteU8 ((data >> (8 * (i - 1))) & 0xff);
+        }
+      return;
+    }
+  for (uint32_t i = size; i > 0; i--)
+    {
+      buffer[i - 1] = data & 0xff;
+      data >>= 8;
+    }
+  m_current += size;
+}
+uint64_t
+Buffer::Iterator::ReadLsbFirst (uint32_t size)
+{
+  uint64_t data = 0;
+  uint8_t *buffer = GetContiguous (size);
+  if (buffer == 0)
+    {
+      for (uint32_t i = 0; i < size; i++)
+        {
+          data |= static_cast<uint64_t> (ReadU8 ()) << (8 * i);
+        }
+      return data;
+    }
+  NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  for (uint32_t i = size; i > 0; i--)
+    {
+      data <<= 8;
+      data |= buffer[i - 1];
+    }
+  m_current += size;
+  return data;
+}
+uint64_t
+Buffer::Iterator::ReadMsbFirst (uint32_t size)
+{
+  uint64_t data = 0;
+  uint8_t *buffer = GetContiguous (size);
+  if (buffer == 0)
+    {
+      for (uint32_t i = 0; i < size; i++)
+        {
+          data <<= 8;
+          data |= ReadU8 ();
+        }
+      return data;
+    }
+  NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data <<= 8;
+      data |= buffer[i];
+    }
+  m_current += size;
+  return data;
 }
 
 void 
 Buffer::Iterator::WriteU16 (uint16_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
+  WriteLsbFirst (data, 2);
 }
 void 
 Buffer::Iterator::WriteU32 (uint32_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
+  WriteLsbFirst (data, 4);
 }
 void 
 Buffer::Iterator::WriteU64 (uint64_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
+  WriteLsbFirst (data, 8);
 }
 void 
 Buffer::Iterator::WriteHtolsbU16 (uint16_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 0) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
+  WriteLsbFirst (data, 2);
 }
 void 
 Buffer::Iterator::WriteHtolsbU32 (uint32_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 0) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
-  WriteU8 ((data >> 16) & 0xff);
-  WriteU8 ((data >> 24) & 0xff);
+  WriteLsbFirst (data, 4);
 }
 void 
 Buffer::Iterator::WriteHtolsbU64 (uint64_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 0) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
-  WriteU8 ((data >> 16) & 0xff);
-  WriteU8 ((data >> 24) & 0xff);
-  WriteU8 ((data >> 32) & 0xff);
-  WriteU8 ((data >> 40) & 0xff);
-  WriteU8 ((data >> 48) & 0xff);
-  WriteU8 ((data >> 56) & 0xff);
+  WriteLsbFirst (data, 8);
 }
 
 void 
 Buffer::Iterator::WriteHtonU64 (uint64_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 56) & 0xff);
-  WriteU8 ((data >> 48) & 0xff);
-  WriteU8 ((data >> 40) & 0xff);
-  WriteU8 ((data >> 32) & 0xff);
-  WriteU8 ((data >> 24) & 0xff);
-  WriteU8 ((data >> 16) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
-  WriteU8 ((data >> 0) & 0xff);
+  WriteMsbFirst (data, 8);
 }
 void 
 Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
@@ -972,48 +972,13 @@ uint32_t
 Buffer::Iterator::ReadU32 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint32_t data = byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-  return data;
+  return ReadLsbFirst (4);
 }
 uint64_t 
 Buffer::Iterator::ReadU64 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint8_t byte4 = ReadU8 ();
-  uint8_t byte5 = ReadU8 ();
-  uint8_t byte6 = ReadU8 ();
-  uint8_t byte7 = ReadU8 ();
-  uint64_t data = byte7;
-  data <<= 8;
-  data |= byte6;
-  data <<= 8;
-  data |= byte5;
-  data <<= 8;
-  data |= byte4;
-  data <<= 8;
-  data |= byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-
-  return data;
+  return ReadLsbFirst (8);
 }
 uint16_t 
 Buffer::Iterator::SlowReadNtohU16 (void)
@@ -1043,86 +1008,39 @@ uint64_t
 Buffer::Iterator::ReadNtohU64 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint64_t retval = 0;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  return retval;
+  return ReadMsbFirst (8);
 }
 uint16_t 
 Buffer::Iterator::ReadLsbtohU16 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint16_t data = byte1;
-  data <<= 8;
-  data |= byte0;
-  return data;
+  return ReadLsbFirst (2);
 }
 uint32_t 
 Buffer::Iterator::ReadLsbtohU32 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint32_t data = byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-  return data;
+  return ReadLsbFirst (4);
 }
 uint64_t 
 Buffer::Iterator::ReadLsbtohU64 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint8_t byte4 = ReadU8 ();
-  uint8_t byte5 = ReadU8 ();
-  uint8_t byte6 = ReadU8 ();
-  uint8_t byte7 = ReadU8 ();
-  uint64_t data = byte7;
-  data <<= 8;
-  data |= byte6;
-  data <<= 8;
-  data |= byte5;
-  data <<= 8;
-  data |= byte4;
-  data <<= 8;
-  data |= byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-
-  return data;
+  return ReadLsbFirst (8);
 }
 void 
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  uint8_t *from = GetContiguous (size);
+  if (from != 0)
+    {
+      NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                     GetReadErrorMessage ());
+      memcpy (buffer, from, size);
+      m_current += size;
+      return;
+    }
   for (uint32_t i = 0; i < size; i++)
     {
       buffer[i] = ReadU8 ();
@@ -1143,11 +1061,29 @@ Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
   /* see RFC 1071 to understand this code. */
   uint32_t sum = initialChecksum;
 
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
+  uint8_t *buffer = GetContiguous (size);
+  if (buffer != 0)
+    {
+      NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                     GetReadErrorMessage ());
+      for (int j = 0; j < size/2; j++)
+        {
+          sum += buffer[2 * j] | (buffer[2 * j + 1] << 8);
+        }
+      if (size & 1)
+        {
+          sum += buffer[size - 1];
+        }
+      m_current += size;
+    }
+  else
+    {
+      for (int j = 0; j < size/2; j++)
+        sum += ReadU16 ();
 
-  if (size & 1)
-    sum += ReadU8 ();
+      if (size & 1)
+        sum += ReadU8 ();
+    }
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -24,8 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
-
-#define BUFFER_FREE_LIST 1
+#include "packet-allocator.h"
 
 namespace ns3 {
 
@@ -65,10 +64,14 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
- * a pair of integers which describe where in the buffer content
- * the "virtual zero area" starts and ends.
+ * zero bytes of application-level payload: this application-level
+ * payload is kept track of with a pair of integers which describe
+ * where in the buffer content the "virtual zero area" starts and ends.
+ * Removing bytes at either end, creating fragments, copying the data
+ * out and appending a Buffer whose zero area is adjacent to this one
+ * keep the zero area virtual.  Only PeekData, and appending a Buffer
+ * when both hold a zero area which are not adjacent, write real zero
+ * bytes: in the latter case, only the smaller of the two zero areas.
  *
  * \verbatim
  * ***: unused bytes
@@ -438,6 +441,45 @@ private:
      * \warning this is the slow version, please use ReadNtohU32 (void)
      */
     uint32_t SlowReadNtohU32 (void);
+    /**
+     * \param size the number of bytes to access
+     * \returns a pointer to the \p size bytes at the current position
+     *          if they are stored contiguously, that is, entirely before
+     *          or after the "virtual zero area", and 0 otherwise.
+     */
+    inline uint8_t *GetContiguous (uint32_t size) const;
+    /**
+     * Write the \p size lowest bytes of \p data, least significant
+     * byte first, and advance the Iterator by \p size bytes.
+     *
+     * \param data the data to write
+     * \param size the number of bytes to write
+     */
+    void WriteLsbFirst (uint64_t data, uint32_t size);
+    /**
+     * Write the \p size lowest bytes of \p data, most significant
+     * byte first, and advance the Iterator by \p size bytes.
+     *
+     * \param data the data to write
+     * \param size the number of bytes to write
+     */
+    void WriteMsbFirst (uint64_t data, uint32_t size);
+    /**
+     * Read \p size bytes, least significant byte first, and advance
+     * the Iterator by \p size bytes.
+     *
+     * \param size the number of bytes to read
+     * \returns the bytes read
+     */
+    uint64_t ReadLsbFirst (uint32_t size);
+    /**
+     * Read \p size bytes, most significant byte first, and advance
+     * the Iterator by \p size bytes.
+     *
+     * \param size the number of bytes to read
+     * \returns the bytes read
+     */
+    uint64_t ReadMsbFirst (uint32_t size);
     /**
      * \brief Returns an appropriate message indicating a read error
      * \returns the error message
@@ -489,6 +531,12 @@ private:
    */
   inline uint32_t GetSize (void) const;
 
+  /**
+   * \return the number of virtual zero bytes in this buffer, which
+   *          use no memory.
+   */
+  inline uint32_t GetZeroAreaSize (void) const;
+
   /**
    * \return a pointer to the start of the internal 
    * byte buffer.
@@ -642,6 +690,13 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Get the statistics of the allocator of the buffer data
+   * storage of the calling thread.
+   * \returns the allocation statistics
+   */
+  static struct PacketAllocator::Statistics GetAllocationStatistics (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -737,17 +792,6 @@ private:
    * \returns a pointer to the created buffer storage
    */
   static struct Buffer::Data *Create (uint32_t size);
-  /**
-   * \brief Allocate a buffer data storage
-   * \param reqSize the storage size to create
-   * \returns a pointer to the allocated buffer storage
-   */
-  static struct Buffer::Data *Allocate (uint32_t reqSize);
-  /**
-   * \brief Deallocate the buffer memory
-   * \param data the buffer data storage
-   */
-  static void Deallocate (struct Buffer::Data *data);
 
   struct Data *m_data; //!< the buffer data storage
 
@@ -767,7 +811,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -790,18 +834,12 @@ private:
    */
   uint32_t m_end;
 
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
+  /**
+   * The allocator of the buffer data storage.  It is per thread, like
+   * the size heuristics, so that simulations running in separate
+   * SimulationContexts on separate threads do not share it.
+   */
+  static thread_local PacketAllocator g_allocator;
 };
 
 } // namespace ns3
@@ -865,6 +903,20 @@ Buffer::Iterator::Prev (uint32_t delta)
   NS_ASSERT (m_current >= delta);
   m_current -= delta;
 }
+uint8_t *
+Buffer::Iterator::GetContiguous (uint32_t size) const
+{
+  if (m_current + size <= m_zeroStart)
+    {
+      return &m_data[m_current];
+    }
+  else if (m_current >= m_zeroEnd)
+    {
+      return &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  return 0;
+}
+
 void
 Buffer::Iterator::WriteU8 (uint8_t data)
 {
@@ -1065,6 +1117,12 @@ Buffer::GetSize (void) const
   return m_end - m_start;
 }
 
+uint32_t
+Buffer::GetZeroAreaSize (void) const
+{
+  return m_zeroAreaEnd - m_zeroAreaStart;
+}
+
 Buffer::Iterator 
 Buffer::Begin (void) const
 {
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include "ns3/type-id.h"
 #include "tag-buffer.h"
+#include "packet-allocator.h"
 
 namespace ns3 {
 
@@ -231,6 +232,14 @@ private:
    */
   void AddAtStart (int32_t prependOffset);
 
+  /**
+   * \brief Get the allocation statistics of the byte tag buffers of the
+   * calling thread.
+   *
+   * \returns the allocation statistics
+   */
+  static struct PacketAllocator::Statistics GetAllocationStatistics (void);
+
 private:
   /**
    * \brief Returns an iterator pointing to the very first tag in this list.
@@ -252,6 +261,13 @@ private:
    */
   void Deallocate (struct ByteTagListData *data);
 
+  /**
+   * Allocator of the ByteTagListData buffers.  Per thread, so that
+   * simulations running in separate SimulationContexts on separate
+   * threads do not share it.
+   */
+  static thread_local PacketAllocator g_allocator;
+
   int32_t m_minStart; //!< minimal start offset
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
@@ -19,6 +19,7 @@
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/config.h"
+#include "ns3/simulation-context.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "channel-list.h"
@@ -83,7 +84,7 @@ public:
 
 private:
   /**
-   * \brief Get the channel list object
+   * \brief Get the channel list object of the current SimulationContext
    * \returns the channel list
    */
   static Ptr<ChannelListPriv> *DoGet (void);
@@ -128,14 +129,14 @@ Ptr<ChannelListPriv> *
 ChannelListPriv::DoGet (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static Ptr<ChannelListPriv> ptr = 0;
-  if (ptr == 0)
+  Ptr<ChannelListPriv> *ptr = SimulationContext::GetCurrent ()->GetInstance<Ptr<ChannelListPriv> > ();
+  if (*ptr == 0)
     {
-      ptr = CreateObject<ChannelListPriv> ();
-      Config::RegisterRootNamespaceObject (ptr);
+      *ptr = CreateObject<ChannelListPriv> ();
+      Config::RegisterRootNamespaceObject (*ptr);
       Simulator::ScheduleDestroy (&ChannelListPriv::Delete);
     }
-  return &ptr;
+  return ptr;
 }
 
 void 
@@ -176,6 +177,7 @@ ChannelListPriv::Add (Ptr<Channel> channel)
   NS_LOG_FUNCTION (this << channel);
   uint32_t index = m_channels.size ();
   m_channels.push_back (channel);
+  Config::InvalidateMatchCache ();
   return index;
 
 }
@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "net-device.h"
+#include "node-arena.h"
 
 namespace ns3 {
 
@@ -41,4 +42,16 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+void *
+NetDevice::operator new (std::size_t size)
+{
+  return NodeArena::Allocate (size);
+}
+
+void
+NetDevice::operator delete (void *object)
+{
+  NodeArena::Deallocate (object);
+}
+
 } // namespace ns3
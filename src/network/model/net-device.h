@@ -102,6 +102,19 @@ public:
   static TypeId GetTypeId (void);
   virtual ~NetDevice();
 
+  /**
+   * Allocate the memory of a device in the NodeArena of the current
+   * simulation.
+   * \param [in] size The size of the device.
+   * \returns The memory of the device.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Release the memory of a device.
+   * \param [in] object The memory of the device.
+   */
+  static void operator delete (void *object);
+
   /**
    * \param index ifIndex of the device 
    */
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "node-arena.h"
+#include "ns3/simulation-context.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <new>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NodeArena");
+
+NodeArena::NodeArena ()
+  : m_pool (new struct Pool),
+    m_enabled (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_pool->current = 0;
+  m_pool->end = 0;
+  m_pool->statistics.allocations = 0;
+  m_pool->statistics.liveObjects = 0;
+  m_pool->statistics.usedBytes = 0;
+  m_pool->statistics.reservedBytes = 0;
+  m_pool->orphan = false;
+}
+
+NodeArena::~NodeArena ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_pool->statistics.liveObjects == 0)
+    {
+      Reset (m_pool);
+      delete m_pool;
+    }
+  else
+    {
+      // the last object deleted releases the pool.
+      m_pool->orphan = true;
+    }
+  m_pool = 0;
+}
+
+NodeArena *
+NodeArena::GetCurrent (void)
+{
+  return SimulationContext::GetCurrent ()->GetInstance<NodeArena> ();
+}
+
+void
+NodeArena::Enable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetCurrent ()->m_enabled = true;
+}
+
+void
+NodeArena::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetCurrent ()->m_enabled = false;
+}
+
+bool
+NodeArena::IsEnabled (void)
+{
+  return GetCurrent ()->m_enabled;
+}
+
+struct NodeArena::Statistics
+NodeArena::GetStatistics (void)
+{
+  return GetCurrent ()->m_pool->statistics;
+}
+
+void
+NodeArena::Reset (struct Pool *pool)
+{
+  NS_LOG_FUNCTION (pool);
+  NS_ASSERT (pool->statistics.liveObjects == 0);
+  for (std::vector<uint8_t *>::const_iterator i = pool->blocks.begin ();
+       i != pool->blocks.end (); ++i)
+    {
+      delete [] *i;
+    }
+  pool->blocks.clear ();
+  pool->current = 0;
+  pool->end = 0;
+  pool->statistics.usedBytes = 0;
+  pool->statistics.reservedBytes = 0;
+}
+
+void *
+NodeArena::Allocate (std::size_t size)
+{
+  // keep the next object aligned as strictly as the header.
+  std::size_t total = sizeof (union Header)
+    + (size + sizeof (union Header) - 1) / sizeof (union Header) * sizeof (union Header);
+  NodeArena *arena = GetCurrent ();
+  union Header *header;
+  if (!arena->m_enabled || total > BLOCK_SIZE)
+    {
+      header = static_cast<union Header *> (::operator new (sizeof (union Header) + size));
+      header->pool = 0;
+      return header + 1;
+    }
+  struct Pool *pool = arena->m_pool;
+  if (pool->current == 0 || static_cast<std::size_t> (pool->end - pool->current) < total)
+    {
+      NS_LOG_LOGIC ("new block of " << BLOCK_SIZE << " bytes");
+      uint8_t *block = new uint8_t [BLOCK_SIZE];
+      pool->blocks.push_back (block);
+      pool->current = block;
+      pool->end = block + BLOCK_SIZE;
+      pool->statistics.reservedBytes += BLOCK_SIZE;
+    }
+  header = reinterpret_cast<union Header *> (pool->current);
+  header->pool = pool;
+  pool->current += total;
+  pool->statistics.allocations++;
+  pool->statistics.liveObjects++;
+  pool->statistics.usedBytes += total;
+  return header + 1;
+}
+
+void
+NodeArena::Deallocate (void *object)
+{
+  if (object == 0)
+    {
+      return;
+    }
+  union Header *header = static_cast<union Header *> (object) - 1;
+  struct Pool *pool = header->pool;
+  if (pool == 0)
+    {
+      ::operator delete (header);
+      return;
+    }
+  NS_ASSERT (pool->statistics.liveObjects > 0);
+  pool->statistics.liveObjects--;
+  if (pool->statistics.liveObjects == 0)
+    {
+      NS_LOG_LOGIC ("release the " << pool->blocks.size () << " blocks of the arena");
+      Reset (pool);
+      if (pool->orphan)
+        {
+          delete pool;
+        }
+    }
+}
+
+} // namespace ns3
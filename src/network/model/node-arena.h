@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Arena allocator of the nodes, devices and mobility models of
+ * a simulation.
+ *
+ * The nodes of large simulations, their devices and their mobility
+ * models are allocated one at a time and end up scattered across the
+ * heap, so that the loops of the channels over their devices miss the
+ * cache at every step.  When the arena of a simulation is enabled, the
+ * Node, NetDevice and MobilityModel objects created by the simulation
+ * are allocated one after the other in large blocks, in the order in
+ * which they are created, which is the order of the node ids when the
+ * topology is built node by node.
+ *
+ * Each SimulationContext has its own arena, disabled by default, which
+ * must be enabled before the objects are created:
+ * \code
+ *   NodeArena::Enable ();
+ *   NodeContainer nodes;
+ *   nodes.Create (10000);
+ * \endcode
+ *
+ * The memory of the objects is not reused when they are deleted, but
+ * all the blocks of the arena are released when its last object is
+ * deleted, normally by Simulator::Destroy.  The objects must be deleted
+ * by the thread of their simulation.
+ */
+class NodeArena
+{
+public:
+  /**
+   * Statistics of an arena.
+   */
+  struct Statistics
+  {
+    uint64_t allocations;   //!< Number of objects allocated in the arena
+    uint64_t liveObjects;   //!< Number of objects of the arena not deleted yet
+    uint64_t usedBytes;     //!< Number of bytes allocated since the last reset
+    uint64_t reservedBytes; //!< Number of bytes of the blocks of the arena
+  };
+
+  /** The size of the blocks of the arena. */
+  static const uint32_t BLOCK_SIZE = 1 << 16;
+
+  /** Create a disabled arena. */
+  NodeArena ();
+  /**
+   * Release the blocks of the arena, or leave them to its remaining
+   * objects.
+   */
+  ~NodeArena ();
+
+  /**
+   * Allocate the objects created from now on by the current
+   * simulation in its arena.
+   */
+  static void Enable (void);
+  /**
+   * Allocate the objects created from now on by the current
+   * simulation on the heap.
+   */
+  static void Disable (void);
+  /**
+   * \returns true if the arena of the current simulation is enabled.
+   */
+  static bool IsEnabled (void);
+  /**
+   * \returns The statistics of the arena of the current simulation.
+   */
+  static struct Statistics GetStatistics (void);
+
+  /**
+   * Allocate the memory of an object, in the arena of the current
+   * simulation if it is enabled and on the heap otherwise.
+   *
+   * \param [in] size The size of the object.
+   * \returns The memory of the object.
+   */
+  static void *Allocate (std::size_t size);
+  /**
+   * Release the memory of an object returned by Allocate.
+   *
+   * \param [in] object The memory of the object.
+   */
+  static void Deallocate (void *object);
+
+private:
+  /**
+   * The memory of an arena, which outlives the arena while some of
+   * its objects remain.
+   */
+  struct Pool
+  {
+    std::vector<uint8_t *> blocks; //!< The blocks
+    uint8_t *current;              //!< The free space of the last block
+    uint8_t *end;                  //!< The end of the last block
+    struct Statistics statistics;  //!< The statistics
+    bool orphan;                   //!< Whether the arena was deleted
+  };
+
+  /**
+   * The header of each object, which tells the pool of the object, or
+   * 0 if it was allocated on the heap.  It is as large as the strictest
+   * alignment of the platform, so that the objects remain aligned.
+   */
+  union Header
+  {
+    struct Pool *pool;  //!< The pool of the object
+    long double align;  //!< The alignment of the header
+    void *alignPointer; //!< The alignment of the header
+    uint64_t align64;   //!< The alignment of the header
+  };
+
+  /**
+   * \returns The arena of the current simulation.
+   */
+  static NodeArena *GetCurrent (void);
+  /**
+   * Release the blocks of a pool and reset it.
+   * \param [in] pool The pool.
+   */
+  static void Reset (struct Pool *pool);
+
+  struct Pool *m_pool; //!< The memory of the arena
+  bool m_enabled;      //!< Whether the arena is enabled
+};
+
+} // namespace ns3
+
+#endif /* NODE_ARENA_H */
@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/config.h"
+#include "ns3/simulation-context.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "node-list.h"
@@ -86,7 +87,7 @@ public:
 
 private:
   /**
-   * \brief Get the node list object
+   * \brief Get the node list object of the current SimulationContext
    * \returns the node list
    */
   static Ptr<NodeListPriv> *DoGet (void);
@@ -130,14 +131,14 @@ Ptr<NodeListPriv> *
 NodeListPriv::DoGet (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static Ptr<NodeListPriv> ptr = 0;
-  if (ptr == 0)
+  Ptr<NodeListPriv> *ptr = SimulationContext::GetCurrent ()->GetInstance<Ptr<NodeListPriv> > ();
+  if (*ptr == 0)
     {
-      ptr = CreateObject<NodeListPriv> ();
-      Config::RegisterRootNamespaceObject (ptr);
+      *ptr = CreateObject<NodeListPriv> ();
+      Config::RegisterRootNamespaceObject (*ptr);
       Simulator::ScheduleDestroy (&NodeListPriv::Delete);
     }
-  return &ptr;
+  return ptr;
 }
 void 
 NodeListPriv::Delete (void)
@@ -179,6 +180,7 @@ NodeListPriv::Add (Ptr<Node> node)
   uint32_t index = m_nodes.size ();
   m_nodes.push_back (node);
   Simulator::ScheduleWithContext (index, TimeStep (0), &Node::Initialize, node);
+  Config::InvalidateMatchCache ();
   return index;
 
 }
@@ -21,6 +21,7 @@
  
 #include "node.h"
 #include "node-list.h"
+#include "node-arena.h"
 #include "net-device.h"
 #include "application.h"
 #include "ns3/packet.h"
@@ -31,6 +32,7 @@
 #include "ns3/assert.h"
 #include "ns3/global-value.h"
 #include "ns3/boolean.h"
+#include "ns3/config.h"
 
 namespace ns3 {
 
@@ -103,6 +105,18 @@ Node::~Node ()
   NS_LOG_FUNCTION (this);
 }
 
+void *
+Node::operator new (std::size_t size)
+{
+  return NodeArena::Allocate (size);
+}
+
+void
+Node::operator delete (void *object)
+{
+  NodeArena::Deallocate (object);
+}
+
 uint32_t
 Node::GetId (void) const
 {
@@ -136,6 +150,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
+  Config::InvalidateMatchCache ();
   return index;
 }
 Ptr<NetDevice>
@@ -162,6 +177,7 @@ Node::AddApplication (Ptr<Application> application)
   application->SetNode (this);
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &Application::Initialize, application);
+  Config::InvalidateMatchCache ();
   return index;
 }
 Ptr<Application> 
@@ -70,6 +70,19 @@ public:
 
   virtual ~Node();
 
+  /**
+   * Allocate the memory of a node in the NodeArena of the current
+   * simulation.
+   * \param [in] size The size of the node.
+   * \returns The memory of the node.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Release the memory of a node.
+   * \param [in] object The memory of the node.
+   */
+  static void operator delete (void *object);
+
   /**
    * \returns the unique id of this node.
    * 
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-allocator.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+double
+PacketAllocator::Statistics::GetRecycleRate (void) const
+{
+  if (allocations == 0)
+    {
+      return 0;
+    }
+  return static_cast<double> (recycled) / allocations;
+}
+
+PacketAllocator::~PacketAllocator ()
+{
+  for (uint32_t i = 0; i < SIZE_CLASSES; i++)
+    {
+      while (m_freeLists[i] != 0)
+        {
+          struct FreeBlock *block = m_freeLists[i];
+          m_freeLists[i] = block->next;
+          delete [] reinterpret_cast<uint8_t *> (block);
+        }
+      m_cachedBytes[i] = 0;
+    }
+  m_statistics.cachedBytes = 0;
+  m_destroyed = true;
+}
+
+uint32_t
+PacketAllocator::GetSizeClass (uint32_t size)
+{
+  NS_ASSERT (size <= MAX_BLOCK_SIZE);
+  uint32_t sizeClass = 0;
+  while ((MIN_BLOCK_SIZE << sizeClass) < size)
+    {
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+uint8_t *
+PacketAllocator::Allocate (uint32_t &size)
+{
+  m_statistics.allocations++;
+  uint8_t *block;
+  if (size > MAX_BLOCK_SIZE || m_destroyed)
+    {
+      block = new uint8_t [size];
+    }
+  else
+    {
+      uint32_t sizeClass = GetSizeClass (size);
+      size = MIN_BLOCK_SIZE << sizeClass;
+      struct FreeBlock *free = m_freeLists[sizeClass];
+      if (free != 0)
+        {
+          m_freeLists[sizeClass] = free->next;
+          m_cachedBytes[sizeClass] -= size;
+          m_statistics.cachedBytes -= size;
+          m_statistics.recycled++;
+          block = reinterpret_cast<uint8_t *> (free);
+        }
+      else
+        {
+          block = new uint8_t [size];
+        }
+    }
+  m_statistics.liveBytes += size;
+  m_statistics.peakBytes = std::max (m_statistics.peakBytes, m_statistics.liveBytes);
+  return block;
+}
+
+void
+PacketAllocator::Deallocate (uint8_t *block, uint32_t size)
+{
+  m_statistics.liveBytes -= size;
+  if (size > MAX_BLOCK_SIZE || m_destroyed)
+    {
+      delete [] block;
+      return;
+    }
+  uint32_t sizeClass = GetSizeClass (size);
+  NS_ASSERT (size == MIN_BLOCK_SIZE << sizeClass);
+  if (m_cachedBytes[sizeClass] + size > MAX_CACHED_BYTES)
+    {
+      delete [] block;
+      return;
+    }
+  struct FreeBlock *free = reinterpret_cast<struct FreeBlock *> (block);
+  free->next = m_freeLists[sizeClass];
+  m_freeLists[sizeClass] = free;
+  m_cachedBytes[sizeClass] += size;
+  m_statistics.cachedBytes += size;
+}
+
+struct PacketAllocator::Statistics
+PacketAllocator::GetStatistics (void) const
+{
+  return m_statistics;
+}
+
+} // namespace ns3
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Size-class allocator of the memory of Buffer and
+ * PacketMetadata.
+ *
+ * Blocks are rounded up to a power of two between MIN_BLOCK_SIZE and
+ * MAX_BLOCK_SIZE, and released blocks are kept in one free list per
+ * size, so that a block is always reused for a request of the same
+ * size class.  Larger blocks, such as those of jumbo frames, are
+ * neither rounded nor kept.
+ *
+ * Each thread uses its own instance, declared thread_local, so that
+ * simulations running in separate SimulationContexts on separate
+ * threads need no locking.  An instance has no constructor, so that it
+ * can be used before its thread has run any constructor, and blocks
+ * released after its destruction at thread exit are freed directly.
+ */
+class PacketAllocator
+{
+public:
+  /**
+   * Statistics of an allocator.
+   */
+  struct Statistics
+  {
+    uint64_t allocations; //!< Number of blocks allocated
+    uint64_t recycled;    //!< Number of blocks reused from the free lists
+    /**
+     * Number of bytes in blocks in use.  Blocks released by another
+     * thread than the one which allocated them are counted by the
+     * releasing thread, so this may be negative.
+     */
+    int64_t liveBytes;
+    int64_t peakBytes;    //!< Maximum of liveBytes
+    uint64_t cachedBytes; //!< Number of bytes in the free lists
+
+    /**
+     * \returns The fraction of the allocations which reused a
+     *          released block.
+     */
+    double GetRecycleRate (void) const;
+  };
+
+  /** The size of the smallest size class. */
+  static const uint32_t MIN_BLOCK_SIZE = 64;
+  /** The size of the largest size class. */
+  static const uint32_t MAX_BLOCK_SIZE = 8192;
+  /** The maximum number of bytes kept in the free list of a size class. */
+  static const uint32_t MAX_CACHED_BYTES = 1 << 20;
+
+  /** Free the blocks of the free lists. */
+  ~PacketAllocator ();
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in,out] size The requested size, replaced by the usable
+   *                 size of the block.
+   * \returns The block.
+   */
+  uint8_t *Allocate (uint32_t &size);
+  /**
+   * Release a block.
+   *
+   * \param [in] block The block.
+   * \param [in] size The usable size returned by Allocate.
+   */
+  void Deallocate (uint8_t *block, uint32_t size);
+  /**
+   * \returns The statistics of this allocator.
+   */
+  struct Statistics GetStatistics (void) const;
+
+private:
+  /** The number of size classes. */
+  static const uint32_t SIZE_CLASSES = 8;
+
+  /**
+   * \param [in] size A block size, at most MAX_BLOCK_SIZE.
+   * \returns The index of the smallest size class holding \p size bytes.
+   */
+  static uint32_t GetSizeClass (uint32_t size);
+
+  /** A block of a free list. */
+  struct FreeBlock
+  {
+    struct FreeBlock *next; //!< The next block of the list
+  };
+
+  struct FreeBlock *m_freeLists[SIZE_CLASSES]; //!< The free lists
+  uint32_t m_cachedBytes[SIZE_CLASSES];        //!< The bytes of each free list
+  struct Statistics m_statistics;              //!< The statistics
+  bool m_destroyed;                            //!< Whether the destructor ran
+};
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
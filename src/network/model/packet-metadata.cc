@@ -17,6 +17,7 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <algorithm>
 #include <utility>
 #include <list>
 #include "ns3/assert.h"
@@ -26,6 +27,7 @@
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
+#include "tag.h"
 
 namespace ns3 {
 
@@ -34,19 +36,11 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
-
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
+uint64_t PacketMetadata::m_sampleThreshold = static_cast<uint64_t> (1) << 32;
+uint16_t PacketMetadata::m_sampleTag = 0;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketAllocator PacketMetadata::m_allocator;
 
 void 
 PacketMetadata::Enable (void)
@@ -70,6 +64,39 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableSampling (double rate, TypeId tag)
+{
+  NS_LOG_FUNCTION (rate << tag);
+  NS_ASSERT_MSG (rate >= 0 && rate <= 1, "Invalid sample rate " << rate);
+  Enable ();
+  m_sampleThreshold = static_cast<uint64_t> (rate * (static_cast<uint64_t> (1) << 32));
+  m_sampleTag = tag.GetUid ();
+}
+
+void
+PacketMetadata::DoNotifyPacketTag (Tag const &tag, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &tag << size);
+  if (tag.GetInstanceTypeId ().GetUid () != m_sampleTag)
+    {
+      return;
+    }
+  NS_ASSERT (m_head == 0xffff);
+  m_sampled = true;
+  // the bytes of the packet so far are recorded as a payload.
+  if (size > 0)
+    {
+      DoAddHeader (0, size);
+    }
+}
+
+bool
+PacketMetadata::IsSampled (void) const
+{
+  return m_enable && m_sampled;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -575,20 +602,6 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
-    {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
-      PacketMetadata::Deallocate (data);
-    }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
   return PacketMetadata::Allocate (m_maxSize);
 }
 
@@ -596,22 +609,9 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+  NS_LOG_LOGIC ("recycle size="<<data->m_size);
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
-    {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
-    }
+  PacketMetadata::Deallocate (data);
 }
 
 struct PacketMetadata::Data *
@@ -624,8 +624,13 @@ PacketMetadata::Allocate (uint32_t n)
       n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
   size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
+  uint8_t *buf = m_allocator.Allocate (size);
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
+  // The block may be larger than requested: make all of it usable,
+  // within the range of m_size.
+  n = std::min<uint32_t> (size - sizeof (struct Data) + PACKET_METADATA_DATA_M_DATA_SIZE,
+                          std::numeric_limits<uint16_t>::max ());
+  NS_ASSERT (size == sizeof (struct Data) + n - PACKET_METADATA_DATA_M_DATA_SIZE);
   data->m_size = n;
   data->m_count = 1;
   data->m_dirtyEnd = 0;
@@ -636,9 +641,16 @@ PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
   uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  m_allocator.Deallocate (buf, sizeof (struct Data) + data->m_size
+                          - PACKET_METADATA_DATA_M_DATA_SIZE);
 }
 
+struct PacketAllocator::Statistics
+PacketMetadata::GetAllocationStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_allocator.GetStatistics ();
+}
 
 PacketMetadata 
 PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
@@ -668,6 +680,10 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -690,6 +706,10 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -738,6 +758,10 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -760,6 +784,10 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -798,15 +826,38 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
 }
 void
-PacketMetadata::AddAtEnd (PacketMetadata const&o)
+PacketMetadata::AddAtEnd (PacketMetadata const&o, uint32_t size)
 {
-  NS_LOG_FUNCTION (this << &o);
+  NS_LOG_FUNCTION (this << &o << size);
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
+  if (!o.m_sampled)
+    {
+      // The other packet has no items: its bytes are appended
+      // as a payload.
+      if (size > 0)
+        {
+          struct PacketMetadata::SmallItem item;
+          item.next = 0xffff;
+          item.prev = m_tail;
+          item.typeUid = 0;
+          item.size = size;
+          item.chunkUid = m_chunkUid;
+          m_chunkUid++;
+          uint16_t written = AddSmall (&item);
+          UpdateTail (written);
+        }
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -884,6 +935,10 @@ PacketMetadata::AddPaddingAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
 }
 void 
 PacketMetadata::RemoveAtStart (uint32_t start)
@@ -895,6 +950,10 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -958,6 +1017,10 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (!m_sampled)
+    {
+      return;
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -1332,6 +1395,8 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
       uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
       UpdateTail (tmp);
     }
+  // a packet without items was either not sampled, or empty.
+  m_sampled = m_head != 0xffff || IsInSample (m_packetUid);
   NS_ASSERT (desSize == 0);
   return (desSize !=0) ? 0 : 1;
 }
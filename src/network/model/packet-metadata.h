@@ -27,6 +27,7 @@
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#include "packet-allocator.h"
 
 namespace ns3 {
 
@@ -34,6 +35,7 @@ class Chunk;
 class Buffer;
 class Header;
 class Trailer;
+class Tag;
 
 /**
  * \ingroup packet
@@ -74,6 +76,12 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When sampling is enabled with EnableSampling, the metadata is
+ * recorded only for the packets whose uid hashes into the sample, and
+ * for the packets to which a packet tag of the sampling type is added.
+ * The other packets keep an empty list of items, whose operations cost
+ * no more than when the metadata is disabled.
  */
 class PacketMetadata 
 {
@@ -160,6 +168,26 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata of a sample of the packets
+   *
+   * The metadata is recorded for a fraction of the packets chosen by
+   * a hash of their uid, and for the packets to which a packet tag of
+   * type \p tag is added, from the time the tag is added: the bytes
+   * of the packet at that time are then recorded as a payload.
+   * Calling this method with a rate of 1 records the metadata of all
+   * the packets, as Enable does.
+   *
+   * \param rate the fraction of the packets to sample, between 0 and 1
+   * \param tag the type of the tag marking the packets to sample, if any
+   */
+  static void EnableSampling (double rate, TypeId tag = TypeId ());
+  /**
+   * \brief Get the statistics of the allocator of the metadata storage
+   * of the calling thread.
+   * \returns the allocation statistics
+   */
+  static struct PacketAllocator::Statistics GetAllocationStatistics (void);
 
   /**
    * \brief Constructor
@@ -221,8 +249,10 @@ private:
   /**
    * \brief Add a metadata at the metadata start
    * \param o the metadata to add
+   * \param size the size of the packet of \p o, which is recorded as
+   *        a payload if the metadata of \p o is not sampled
    */
-  void AddAtEnd (PacketMetadata const&o);
+  void AddAtEnd (PacketMetadata const&o, uint32_t size);
   /**
    * \brief Add some padding at the end
    * \param end size of padding
@@ -239,6 +269,22 @@ private:
    */
   void RemoveAtEnd (uint32_t end);
 
+  /**
+   * \brief Notify the addition of a packet tag
+   *
+   * If the tag is of the sampling type given to EnableSampling, the
+   * metadata of the packet is recorded from now on.
+   *
+   * \param tag the tag added to the packet
+   * \param size the size of the packet
+   */
+  inline void NotifyPacketTag (Tag const &tag, uint32_t size) const;
+  /**
+   * \brief Tell whether the metadata of the packet is recorded
+   * \return true if the metadata is enabled and the packet is sampled
+   */
+  bool IsSampled (void) const;
+
   /**
    * \brief Get the packet Uid
    * \return the packet Uid
@@ -494,16 +540,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
@@ -638,6 +674,20 @@ public:
    */
   bool IsSharedPointerOk (uint16_t pointer) const;
 
+  /**
+   * \brief Tell whether a packet is in the sample
+   * \param uid the uid of the packet
+   * \returns true if the hash of the uid is below the sample rate
+   */
+  static inline bool IsInSample (uint64_t uid);
+  /**
+   * \brief Start recording the metadata of a packet tagged with the
+   * sampling tag
+   * \param tag the tag added to the packet
+   * \param size the size of the packet
+   */
+  void DoNotifyPacketTag (Tag const &tag, uint32_t size);
+
   /**
    * \brief Recycle the buffer memory
    * \param data the buffer data storage
@@ -661,7 +711,12 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * The allocator of the metadata data storage.  This, m_maxSize and
+   * m_chunkUid are per thread, so that simulations running in separate
+   * SimulationContexts on separate threads do not share them.
+   */
+  static thread_local PacketAllocator m_allocator;
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -672,8 +727,15 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  /**
+   * The packets whose uid hashes below this value, out of 2^32, are
+   * sampled.
+   */
+  static uint64_t m_sampleThreshold;
+  static uint16_t m_sampleTag; //!< The uid of the TypeId of the sampling tag, or 0
+
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -684,6 +746,7 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  bool m_sampled; //!< whether the metadata of the packet is recorded
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -696,6 +759,7 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_sampled (IsInSample (uid)),
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
@@ -709,6 +773,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_sampled (o.m_sampled),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
@@ -734,9 +799,24 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_sampled = o.m_sampled;
   m_packetUid = o.m_packetUid;
   return *this;
 }
+bool
+PacketMetadata::IsInSample (uint64_t uid)
+{
+  // Fibonacci hashing spreads the consecutive uids over the sample.
+  return ((uid * 0x9e3779b97f4a7c15ULL) >> 32) < m_sampleThreshold;
+}
+void
+PacketMetadata::NotifyPacketTag (Tag const &tag, uint32_t size) const
+{
+  if (m_sampleTag != 0 && !m_sampled && m_enable)
+    {
+      const_cast<PacketMetadata *> (this)->DoNotifyPacketTag (tag, size);
+    }
+}
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
@@ -20,7 +20,7 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a flat list of Packet tags, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -28,277 +28,320 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstring>
+#include <limits>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-PacketTagList::TagData *
-PacketTagList::CreateTagData (size_t dataSize)
-{
-  NS_ASSERT_MSG (dataSize
-                 < std::numeric_limits<decltype(TagData::size)>::max (),
-                 "Requested TagData size " << dataSize
-                 << " exceeds maximum "
-                 << std::numeric_limits<decltype(TagData::size)>::max () );
+namespace {
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+/**
+ * \ingroup packet
+ * The tag index plus one of each TypeId uid, or 0 if the type was not
+ * used as a packet tag yet.  Shared by all threads, so that a store
+ * can be read by any of them.
+ */
+std::atomic<uint8_t> g_tagIndices[std::numeric_limits<uint16_t>::max () + 1];
 
-  TagData * tag = new (p) TagData;
-  tag->size = dataSize;
-  return tag;
-}
+/**
+ * \ingroup packet
+ * The next tag index to assign.
+ */
+std::atomic<uint32_t> g_nextTagIndex (0);
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
-{
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+/**
+ * \ingroup packet
+ * The size of a TagStore without its entries.
+ */
+const uint32_t HEADER_SIZE = offsetof (struct PacketTagList::TagStore, tags);
 
-  // trivial case when list is empty
-  if (m_next == 0)
-    {
-      return false;
-    }
+/**
+ * \ingroup packet
+ * The minimal size of a TagStore, which holds the few tags of most
+ * packets without growing.
+ */
+const uint32_t MIN_STORE_SIZE = 128;
 
-  bool found = false;
+/**
+ * \ingroup packet
+ * \param [in] indices A set of tag indices.
+ * \param [in] bit The bit of a tag index.
+ * \returns The number of indices of \p indices below \p bit.
+ */
+inline uint32_t
+Rank (uint64_t indices, uint64_t bit)
+{
+  // Count the bits in parallel: without a hardware instruction,
+  // std::bitset::count is a library call.
+  uint64_t x = indices & (bit - 1);
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<uint32_t> ((x * 0x0101010101010101ULL) >> 56);
+}
+
+} // anonymous namespace
 
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
+thread_local PacketAllocator PacketTagList::g_allocator;
 
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+uint8_t
+PacketTagList::GetTagIndex (TypeId tid)
+{
+  std::atomic<uint8_t> &entry = g_tagIndices[tid.GetUid ()];
+  uint8_t index = entry.load (std::memory_order_relaxed);
+  if (index == 0)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
+      // Another thread using the same type for the first time may win
+      // the race, wasting the index taken here.
+      uint8_t next = std::min<uint32_t> (g_nextTagIndex++, OVERFLOW_INDEX) + 1;
+      if (entry.compare_exchange_strong (index, next))
         {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
+          index = next;
         }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
-
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
-    {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      NS_LOG_INFO ("tag " << tid << " has index " << index - 1U);
     }
+  return index - 1;
+}
 
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
+PacketTagList::TagStore *
+PacketTagList::Allocate (uint32_t size)
+{
+  NS_LOG_FUNCTION (size);
+  NS_ASSERT_MSG (size <= std::numeric_limits<decltype(TagStore::dataStart)>::max (),
+                 "Requested TagStore size " << size
+                 << " exceeds maximum "
+                 << std::numeric_limits<decltype(TagStore::dataStart)>::max () );
+  uint8_t *buf = g_allocator.Allocate (size);
+  // The matching deallocation is in Deallocate.
+  struct TagStore *store = reinterpret_cast<struct TagStore *> (buf);
+  // The block may be larger than requested: make all of it usable.
+  store->size = size;
+  store->count = 1;
+  store->indices = 0;
+  store->nTags = 0;
+  store->dataStart = size;
+  return store;
+}
+
+void
+PacketTagList::Deallocate (struct TagStore *store)
+{
+  NS_LOG_FUNCTION (store);
+  NS_ASSERT (store->count == 0);
+  g_allocator.Deallocate (reinterpret_cast<uint8_t *> (store), store->size);
+}
 
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+struct PacketAllocator::Statistics
+PacketTagList::GetAllocationStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_allocator.GetStatistics ();
+}
+
+int32_t
+PacketTagList::Find (TypeId tid, uint8_t index) const
+{
+  if (m_store == 0)
     {
-      if (it->tid == tid)
-        {
-          break;
-        }
+      return -1;
     }
-  if (it == 0)
+  uint64_t bit = static_cast<uint64_t> (1) << index;
+  if ((m_store->indices & bit) == 0)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      return -1;
     }
-
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+  uint32_t position = Rank (m_store->indices, bit);
+  if (index != OVERFLOW_INDEX)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = CreateTagData (cur->size);
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->size = cur->size;
-      memcpy (copy->data, cur->data, copy->size);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      NS_ASSERT (m_store->tags[position].uid == tid.GetUid ());
+      return position;
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
+  // The overflow types share the last index, so look for the type.
+  for (; position < m_store->nTags; ++position)
+    {
+      if (m_store->tags[position].uid == tid.GetUid ())
+        {
+          return position;
+        }
+    }
+  return -1;
 }
 
-bool
-PacketTagList::Remove (Tag & tag)
+void
+PacketTagList::Reserve (uint32_t nTags, uint32_t dataSize)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  NS_LOG_FUNCTION (this << nTags << dataSize);
+  uint32_t entries = nTags;
+  uint32_t used = dataSize;
+  if (m_store != 0)
+    {
+      entries += m_store->nTags;
+      used += m_store->size - m_store->dataStart;
+    }
+  uint32_t needed = HEADER_SIZE + entries * sizeof (struct TagData) + used;
+  if (m_store != 0 && m_store->count == 1 && needed <= m_store->size)
+    {
+      return;
+    }
+  struct TagStore *store = Allocate (std::max (needed, MIN_STORE_SIZE));
+  if (m_store != 0)
+    {
+      // Copy the entries and the serialized tags, which move to the
+      // end of the new block.
+      uint32_t bytes = m_store->size - m_store->dataStart;
+      store->indices = m_store->indices;
+      store->nTags = m_store->nTags;
+      store->dataStart = store->size - bytes;
+      std::memcpy (store->tags, m_store->tags, m_store->nTags * sizeof (struct TagData));
+      std::memcpy (reinterpret_cast<uint8_t *> (store) + store->dataStart,
+                   reinterpret_cast<uint8_t *> (m_store) + m_store->dataStart,
+                   bytes);
+      int32_t delta = store->dataStart - m_store->dataStart;
+      for (uint32_t i = 0; i < store->nTags; ++i)
+        {
+          store->tags[i].offset += delta;
+        }
+      RemoveAll ();
+    }
+  m_store = store;
 }
 
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
+void
+PacketTagList::Erase (uint32_t position)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
+  NS_LOG_FUNCTION (this << position);
+  NS_ASSERT (m_store->count == 1);
+  NS_ASSERT (position < m_store->nTags);
+  struct TagStore *store = m_store;
+  struct TagData erased = store->tags[position];
+  uint8_t *base = reinterpret_cast<uint8_t *> (store);
+
+  // Close the gap in the serialized tags, which follow the tags
+  // serialized before them.
+  std::memmove (base + store->dataStart + erased.size, base + store->dataStart,
+                erased.offset - store->dataStart);
+  store->dataStart += erased.size;
+  std::memmove (&store->tags[position], &store->tags[position + 1],
+                (store->nTags - position - 1) * sizeof (struct TagData));
+  store->nTags--;
+  for (uint32_t i = 0; i < store->nTags; ++i)
     {
-      // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
-    }
-  else
-    {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
+      if (store->tags[i].offset < erased.offset)
         {
-          // there's a next, so make it a merge
-          cur->next->count++;
+          store->tags[i].offset += erased.size;
         }
     }
-  return found;
+  // The overflow entries are last: keep their bit while one remains.
+  if (erased.index != OVERFLOW_INDEX
+      || store->nTags == 0
+      || store->tags[store->nTags - 1].index != OVERFLOW_INDEX)
+    {
+      store->indices &= ~(static_cast<uint64_t> (1) << erased.index);
+    }
 }
 
 bool
-PacketTagList::Replace (Tag & tag)
+PacketTagList::Remove (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  int32_t position = Find (tid, GetTagIndex (tid));
+  if (position < 0)
     {
-      Add (tag);
+      return false;
     }
-  return found;
+  uint8_t *data = const_cast<uint8_t *> (GetData (m_store, m_store->tags[position]));
+  tag.Deserialize (TagBuffer (data, data + m_store->tags[position].size));
+  if (m_store->nTags == 1)
+    {
+      RemoveAll ();
+      return true;
+    }
+  Reserve (0, 0);
+  Erase (position);
+  return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
+PacketTagList::Replace (Tag & tag)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  int32_t position = Find (tid, GetTagIndex (tid));
+  if (position < 0)
     {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+      Add (tag);
+      return false;
     }
-  else
+  Reserve (0, 0);
+  uint32_t size = tag.GetSerializedSize ();
+  if (size != m_store->tags[position].size)
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
+      Erase (position);
+      Add (tag);
+      return true;
     }
-  return found;
+  uint8_t *data = const_cast<uint8_t *> (GetData (m_store, m_store->tags[position]));
+  tag.Serialize (TagBuffer (data, data + size));
+  return true;
 }
 
 void 
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint8_t index = GetTagIndex (tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
-    {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
-    }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  NS_ASSERT_MSG (Find (tid, index) < 0,
+                 "Error: cannot add the same kind of tag twice.");
+  uint32_t size = tag.GetSerializedSize ();
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  self->Reserve (1, size);
+
+  struct TagStore *store = m_store;
+  uint64_t bit = static_cast<uint64_t> (1) << index;
+  uint32_t position = index == OVERFLOW_INDEX ? store->nTags : Rank (store->indices, bit);
+  std::memmove (&store->tags[position + 1], &store->tags[position],
+                (store->nTags - position) * sizeof (struct TagData));
+  store->nTags++;
+  store->indices |= bit;
+  store->dataStart -= size;
+  struct TagData &entry = store->tags[position];
+  entry.uid = tid.GetUid ();
+  entry.offset = store->dataStart;
+  entry.size = size;
+  entry.index = index;
+  uint8_t *data = reinterpret_cast<uint8_t *> (store) + entry.offset;
+  tag.Serialize (TagBuffer (data, data + size));
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_LOG_FUNCTION (this << tid);
+  int32_t position = Find (tid, GetTagIndex (tid));
+  if (position < 0)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  const struct TagData &entry = m_store->tags[position];
+  uint8_t *data = const_cast<uint8_t *> (GetData (m_store, entry));
+  tag.Deserialize (TagBuffer (data, data + entry.size));
+  return true;
 }
 
-const struct PacketTagList::TagData *
+const struct PacketTagList::TagStore *
 PacketTagList::Head (void) const
 {
-  return m_next;
+  return m_store;
 }
 
 } /* namespace ns3 */
-
@@ -22,12 +22,13 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a flat list of Packet tags, including copy-on-write semantics.
 */
 
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "packet-allocator.h"
 
 namespace ns3 {
 
@@ -43,110 +44,82 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * The tags of a list are stored in serialized form in a single
+ * TagStore block, allocated by a PacketAllocator:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ * \verbatim
+   +--------+------+------+-----+------+ - - - - - +--------+-----+--------+
+   | header | tag0 | tag1 | ... | tagN |   free    | dataN  | ... | data0  |
+   +--------+------+------+-----+------+ - - - - - +--------+-----+--------+
+                                                   ^ dataStart
+   \endverbatim
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
+ *   - The TagData entries grow from the start of the block, and the
+ *     serialized tags from its end.  The serialized tags are kept
+ *     contiguous, so that the free space is all in the middle.  When a
+ *     tag does not fit in the free space, the tags are moved to a block
+ *     of the next size class.
  *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
+ *   - Each tag TypeId is given a dense tag index, in order of first use
+ *     by any PacketTagList of the process.  The entries are sorted by
+ *     tag index, and TagStore::indices has one bit per index present,
+ *     so that the position of a tag is the number of bits set below
+ *     its own, and a missing tag is found in constant time.  The tag
+ *     types used after the first #OVERFLOW_INDEX share the last index
+ *     and bit, and their entries, at the end of the list, are searched
+ *     by TypeId.
  *
  * \par <b> Copy-on-write </b> is implemented as follows:
  *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
  *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
+ *     simply share the TagStore of the original PacketTagList \c o,
+ *     incrementing its \c count.
  *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ *   - #Add, #Remove and #Replace first copy a TagStore shared with other
+ *     lists, then modify their own copy in place.  #Remove and #Replace
+ *     do not copy anything when the tag is not found.
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
-   *
-   * See PacketTagList for a discussion of the data structure.
+   * Entry of a tag in a TagStore.
    *
    * \internal
    * Unfortunately this has to be public, because
    * PacketTagIterator::Item::GetTag() needs the data and size values.
    * The Item nested class can't be forward declared, so friending isn't
    * possible.
-   *
-   * We use placement new so we can allocate enough room for the Tag
-   * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
    */
   struct TagData
   {
-    struct TagData * next;      /**< Pointer to next in list */
-    uint32_t count;             /**< Number of incoming links */
-    TypeId tid;                 /**< Type of the tag serialized into #data */
-    uint32_t size;              /**< Size of the \c data buffer */
-    uint8_t data[1];            /**< Serialization buffer */
+    uint16_t uid;               /**< TypeId uid of the type of the tag */
+    uint16_t offset;            /**< Offset of the serialized tag in the TagStore */
+    uint16_t size;              /**< Size of the serialized tag */
+    uint8_t index;              /**< Dense tag index of #tid */
   };  /* struct TagData */
 
+  /**
+   * Block holding the tags of one or more lists.
+   *
+   * See PacketTagList for a discussion of the data structure.
+   */
+  struct TagStore
+  {
+    uint32_t count;             /**< Number of lists sharing this store */
+    uint32_t size;              /**< Size of the block */
+    uint64_t indices;           /**< Bit set of the tag indices present */
+    uint16_t nTags;             /**< Number of entries in #tags */
+    uint16_t dataStart;         /**< Offset of the first serialized tag */
+    struct TagData tags[1];     /**< The entries, sorted by tag index */
+  };  /* struct TagStore */
+
+  /**
+   * The last tag index, shared by all the tag types used after it.
+   */
+  static const uint8_t OVERFLOW_INDEX = 63;
+
   /**
    * Create a new PacketTagList.
    */
@@ -156,8 +129,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy, sharing the \ref TagStore of
+   * \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -167,18 +140,18 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * sharing the \ref TagStore of \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to the list.
    *
    * \param [in] tag The tag to add
    */
@@ -210,78 +183,85 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the store of the tags, or 0 if there is none
    */
-  const struct PacketTagList::TagData *Head (void) const;
+  const struct PacketTagList::TagStore *Head (void) const;
+  /**
+   * \param [in] store A store of tags.
+   * \param [in] tag An entry of \pname{store}.
+   * \returns pointer to the serialized tag
+   */
+  static inline const uint8_t *GetData (const struct TagStore *store,
+                                        const struct TagData &tag);
+  /**
+   * \brief Get the allocation statistics of the tag stores of the
+   * calling thread.
+   *
+   * \returns the allocation statistics
+   */
+  static struct PacketAllocator::Statistics GetAllocationStatistics (void);
 
 private:
   /**
-   * Allocate and construct a TagData struct, sizing the data area
-   * large enough to serialize dataSize bytes from a Tag.
+   * Get the dense tag index of a tag type, assigning the next one on
+   * first use.
    *
-   * \param [in] dataSize The serialized size of the Tag.
-   * \returns The newly constructed TagData object.
+   * \param [in] tid The type of the tag.
+   * \returns The tag index, at most #OVERFLOW_INDEX.
    */
-  static
-  TagData * CreateTagData (size_t dataSize);
-  
+  static uint8_t GetTagIndex (TypeId tid);
   /**
-   * Typedef of method function pointer for copy-on-write operations
+   * Find the entry of a tag.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] tid The type of the tag.
+   * \param [in] index The tag index of \pname{tid}.
+   * \returns The position of the entry in the store, or -1 if the
+   *          tag is not in the list.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  int32_t Find (TypeId tid, uint8_t index) const;
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * Make sure this list does not share its store, and that the store
+   * has room for more tags.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] nTags The number of tags to make room for.
+   * \param [in] dataSize The serialized size of these tags.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  void Reserve (uint32_t nTags, uint32_t dataSize);
   /**
-   * Copy-on-write implementing Remove.
+   * Remove the entry of a tag from an unshared store.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] position The position of the entry.
    */
-  bool RemoveWriter  (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  void Erase (uint32_t position);
   /**
-   * Copy-on-write implementing Replace
+   * Allocate a TagStore block.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] size The minimal size of the block.
+   * \returns The new store, with no tags.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  static struct TagStore *Allocate (uint32_t size);
+  /**
+   * Release a TagStore block.
+   *
+   * \param [in] store The store, no longer used by any list.
+   */
+  static void Deallocate (struct TagStore *store);
 
   /**
-   * Pointer to first \ref TagData on the list
+   * Allocator of the TagStore blocks.  Per thread, so that
+   * simulations running in separate SimulationContexts on separate
+   * threads do not share it.
    */
-  struct TagData *m_next;
+  static thread_local PacketAllocator g_allocator;
+
+  /**
+   * Pointer to the store of the tags of this list
+   */
+  struct TagStore *m_store;
 };
 
 } // namespace ns3
@@ -293,16 +273,16 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_store ()
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_store (o.m_store)
 {
-  if (m_next != 0)
+  if (m_store != 0)
     {
-      m_next->count++;
+      m_store->count++;
     }
 }
 
@@ -310,15 +290,15 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (m_store == o.m_store) 
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_store = o.m_store;
+  if (m_store != 0) 
     {
-      m_next->count++;
+      m_store->count++;
     }
   return *this;
 }
@@ -331,27 +311,22 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if (m_store != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
+      m_store->count--;
+      if (m_store->count == 0)
         {
-          prev->~TagData ();
-          std::free (prev);
+          Deallocate (m_store);
         }
-      prev = cur;
-    }
-  if (prev != 0) 
-    {
-      prev->~TagData ();
-      std::free (prev);
+      m_store = 0;
     }
-  m_next = 0;
+}
+
+const uint8_t *
+PacketTagList::GetData (const struct TagStore *store,
+                        const struct TagData &tag)
+{
+  return reinterpret_cast<const uint8_t *> (store) + tag.offset;
 }
 
 } // namespace ns3
@@ -21,6 +21,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/simulation-context.h"
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +29,6 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,39 +81,44 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagStore *store)
+  : m_store (store),
+    m_current (0)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_store != 0 && m_current < m_store->nTags;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
-  const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  const struct PacketTagList::TagData *data = &m_store->tags[m_current];
+  m_current++;
+  return PacketTagIterator::Item (m_store, data);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (const struct PacketTagList::TagStore *store,
+                               const struct PacketTagList::TagData *data)
+  : m_store (store),
+    m_data (data)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  TypeId tid;
+  tid.SetUid (m_data->uid);
+  return tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data + m_data->size));
+  NS_ASSERT (tag.GetInstanceTypeId ().GetUid () == m_data->uid);
+  uint8_t *data = const_cast<uint8_t *> (PacketTagList::GetData (m_store, *m_data));
+  tag.Deserialize (TagBuffer (data, data + m_data->size));
 }
 
 
@@ -126,6 +131,30 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+namespace {
+
+/**
+ * \ingroup packet
+ * The counter of packet uids.  There is one per SimulationContext, so
+ * simulations run in separate contexts assign the same uids as they
+ * would in separate processes.
+ */
+struct PacketUidCounter
+{
+  PacketUidCounter ()
+    : next (0)
+  {}
+  uint32_t next;  //!< The next packet uid.
+};
+
+} // anonymous namespace
+
+uint32_t
+Packet::AllocateUid (void)
+{
+  return SimulationContext::GetCurrent ()->GetInstance<PacketUidCounter> ()->next++;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,10 +165,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -178,10 +206,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +231,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -304,6 +330,20 @@ Packet::PeekHeader (Header &header, uint32_t size) const
   return deserialized;
 }
 void
+Packet::ReplaceHeader (const Header &header)
+{
+  uint32_t size = header.GetSerializedSize ();
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  NS_ASSERT (size <= m_buffer.GetSize ());
+  // Removing and adding back the bytes of the header only copies them
+  // when they are shared with another packet.
+  m_buffer.RemoveAtStart (size);
+  m_buffer.AddAtStart (size);
+  header.Serialize (m_buffer.Begin ());
+  m_metadata.RemoveHeader (header, size);
+  m_metadata.AddHeader (header, size);
+}
+void
 Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
@@ -341,7 +381,7 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   copy.Adjust (GetSize ());
   m_byteTagList.Add (copy);
   m_buffer.AddAtEnd (packet->m_buffer);
-  m_metadata.AddAtEnd (packet->m_metadata);
+  m_metadata.AddAtEnd (packet->m_metadata, packet->GetSize ());
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -349,6 +389,10 @@ Packet::AddPaddingAtEnd (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
+  // the bytes added to the buffer are not initialized.
+  Buffer::Iterator i = m_buffer.End ();
+  i.Prev (size);
+  i.WriteU8 (0, size);
   m_metadata.AddPaddingAtEnd (size);
 }
 void 
@@ -374,6 +418,12 @@ Packet::RemoveAllByteTags (void)
   m_byteTagList.RemoveAll ();
 }
 
+uint32_t
+Packet::GetVirtualPayloadSize (void) const
+{
+  return m_buffer.GetZeroAreaSize ();
+}
+
 uint32_t 
 Packet::CopyData (uint8_t *buffer, uint32_t size) const
 {
@@ -575,6 +625,19 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnableSampledPrinting (double rate, TypeId tag)
+{
+  NS_LOG_FUNCTION (rate << tag);
+  PacketMetadata::EnableSampling (rate, tag);
+}
+
+bool
+Packet::IsSampled (void) const
+{
+  return m_metadata.IsSampled ();
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -582,6 +645,18 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+struct Packet::AllocationStatistics
+Packet::GetAllocationStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  struct AllocationStatistics statistics;
+  statistics.buffer = Buffer::GetAllocationStatistics ();
+  statistics.metadata = PacketMetadata::GetAllocationStatistics ();
+  statistics.byteTags = ByteTagList::GetAllocationStatistics ();
+  statistics.packetTags = PacketTagList::GetAllocationStatistics ();
+  return statistics;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -853,6 +928,7 @@ Packet::AddPacketTag (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize ());
   m_packetTagList.Add (tag);
+  m_metadata.NotifyPacketTag (tag, GetSize ());
 }
 
 bool 
@@ -155,9 +155,12 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param store the store of the tag.
+     * \param data the entry of the tag in \p store.
      */
-    Item (const struct PacketTagList::TagData *data);
+    Item (const struct PacketTagList::TagStore *store,
+          const struct PacketTagList::TagData *data);
+    const struct PacketTagList::TagStore *m_store; //!< the store of the tag
     const struct PacketTagList::TagData *m_data; //!< the tag data
   };
   /**
@@ -173,10 +176,11 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param store store of the items, or 0 if there are none
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (const struct PacketTagList::TagStore *store);
+  const struct PacketTagList::TagStore *m_store;  //!< the store of the tags in a packet
+  uint32_t m_current;  //!< actual position over the set of tags in a packet
 };
 
 /**
@@ -199,7 +203,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. To print only some of the packets of a large
+ * simulation, call Packet::EnableSampledPrinting, whose cost is
+ * proportional to the number of packets sampled.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -251,11 +257,14 @@ public:
   /**
    * \brief Create a packet with a zero-filled payload.
    *
-   * The memory necessary for the payload is not allocated:
-   * it will be allocated at any later point if you attempt
-   * to fragment this packet or to access the zero-filled
-   * bytes. The packet is allocated with a new uid (as 
-   * returned by getUid).
+   * The memory necessary for the payload is not allocated, and
+   * stays so when headers are added or removed, when the packet
+   * is fragmented (CreateFragment, RemoveAtStart, RemoveAtEnd),
+   * when fragments are put back together with AddAtEnd, and when
+   * the payload is copied out with CopyData, as done when writing
+   * pcap traces.  GetVirtualPayloadSize tells how much of the packet
+   * is such a virtual payload.  The packet is allocated with a new
+   * uid (as returned by getUid).
    * 
    * \param size the size of the zero-filled payload
    */
@@ -302,6 +311,14 @@ public:
    * \returns the size in bytes of the packet
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \brief Returns the size of the zero-filled payload which uses no memory.
+   *
+   * \returns the number of zero-filled payload bytes of this packet
+   *          which are not allocated.
+   * \sa Packet (uint32_t size)
+   */
+  uint32_t GetVirtualPayloadSize (void) const;
   /**
    * \brief Add header to this packet.
    *
@@ -356,6 +373,20 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header, uint32_t size) const;
+  /**
+   * \brief Replace the header at the start of this packet.
+   *
+   * The header at the start of this packet must be of the same type
+   * and serialized size as \p header, which typically is a copy of it
+   * obtained with PeekHeader and then modified.  This is equivalent to
+   * RemoveHeader followed by AddHeader, but the bytes of the old header
+   * are overwritten in place unless they are shared with another
+   * packet, and the byte tags are left untouched.
+   *
+   * \param header a reference to the header to write in place of the
+   *        old one.
+   */
+  void ReplaceHeader (const Header &header);
   /**
    * \brief Add trailer to this packet.
    *
@@ -519,6 +550,29 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing the metadata of a sample of the packets.
+   *
+   * Like EnablePrinting, but the metadata is only kept for a fraction
+   * of the packets, chosen by a hash of their uid, and for the packets
+   * to which a packet tag of type \p tag is added, from the time the
+   * tag is added.  Print outputs nothing for the other packets, which
+   * cost no more than when printing is disabled.  This method must be
+   * called before any packet is created, like EnablePrinting.
+   *
+   * \param rate the fraction of the packets to sample, between 0 and 1
+   * \param tag the type of the tag marking the packets to sample, if any
+   *
+   * \sa IsSampled
+   */
+  static void EnableSampledPrinting (double rate, TypeId tag = TypeId ());
+  /**
+   * \brief Tell whether the metadata of this packet is kept.
+   *
+   * \returns true if printing is enabled and the packet is sampled,
+   *          that is, if Print describes its headers and trailers.
+   */
+  bool IsSampled (void) const;
   /**
    * \brief Enable packets metadata checking.
    *
@@ -531,6 +585,30 @@ public:
    */
   static void EnableChecking (void);
 
+  /**
+   * \brief The allocation statistics of the packet storage.
+   */
+  struct AllocationStatistics
+  {
+    struct PacketAllocator::Statistics buffer;     //!< The byte buffers
+    struct PacketAllocator::Statistics metadata;   //!< The metadata
+    struct PacketAllocator::Statistics byteTags;   //!< The byte tags
+    struct PacketAllocator::Statistics packetTags; //!< The packet tags
+  };
+  /**
+   * \brief Get the allocation statistics of the packet storage of the
+   * calling thread.
+   *
+   * The byte buffers, the metadata and the tags of packets are
+   * allocated in size classes, and released blocks are kept in
+   * per-thread free lists.
+   * These statistics count the blocks allocated and reused, and the
+   * bytes in use and kept by the calling thread.
+   *
+   * \returns the allocation statistics
+   */
+  static struct AllocationStatistics GetAllocationStatistics (void);
+
   /**
    * \brief Returns number of bytes required for packet
    * serialization.
@@ -758,6 +836,12 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Allocate the uid of a new packet
+   * \returns the next packet uid of the current SimulationContext
+   */
+  static uint32_t AllocateUid (void);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -765,8 +849,6 @@ private:
 
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
-
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -23,6 +23,9 @@
 #include "ns3/double.h"
 #include "ns3/test.h"
 
+#include <sstream>
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -378,6 +381,171 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the virtual zero area survives fragmentation and
+ * concatenation.
+ */
+class BufferZeroAreaTest : public TestCase {
+private:
+  /**
+   * Get the content of a buffer.
+   * \param b The buffer.
+   * \returns The bytes of the buffer.
+   */
+  static std::vector<uint8_t> GetBytes (const Buffer &b);
+  /**
+   * Create a buffer of zeroes with written bytes around them.
+   * \param front The number of bytes before the zero area.
+   * \param zeroes The number of zero bytes.
+   * \param back The number of bytes after the zero area.
+   * \returns The buffer.
+   */
+  static Buffer Make (uint32_t front, uint32_t zeroes, uint32_t back);
+public:
+  virtual void DoRun (void);
+  BufferZeroAreaTest ();
+};
+
+BufferZeroAreaTest::BufferZeroAreaTest ()
+  : TestCase ("Buffer zero area") {
+}
+
+std::vector<uint8_t>
+BufferZeroAreaTest::GetBytes (const Buffer &b)
+{
+  std::vector<uint8_t> bytes (b.GetSize ());
+  if (!bytes.empty ())
+    {
+      b.CopyData (&bytes[0], bytes.size ());
+    }
+  return bytes;
+}
+
+Buffer
+BufferZeroAreaTest::Make (uint32_t front, uint32_t zeroes, uint32_t back)
+{
+  Buffer b (zeroes);
+  b.AddAtStart (front);
+  Buffer::Iterator i = b.Begin ();
+  for (uint32_t j = 0; j < front; ++j)
+    {
+      i.WriteU8 (j + 1);
+    }
+  b.AddAtEnd (back);
+  i = b.End ();
+  i.Prev (back);
+  for (uint32_t j = 0; j < back; ++j)
+    {
+      i.WriteU8 (j + 101);
+    }
+  return b;
+}
+
+void
+BufferZeroAreaTest::DoRun (void)
+{
+  // Adjacent zero areas, with shared data.
+  Buffer a = Make (20, 1000, 0);
+  Buffer shared = a;
+  Buffer b = Make (0, 500, 4);
+  std::vector<uint8_t> expected = GetBytes (a);
+  std::vector<uint8_t> tail = GetBytes (b);
+  expected.insert (expected.end (), tail.begin (), tail.end ());
+  a.AddAtEnd (b);
+  NS_TEST_EXPECT_MSG_EQ (a.GetZeroAreaSize (), 1500, "Zero areas not merged");
+  NS_TEST_EXPECT_MSG_EQ ((GetBytes (a) == expected), true, "Wrong merged content");
+  NS_TEST_EXPECT_MSG_EQ (shared.GetSize (), 1020, "Shared buffer changed");
+  NS_TEST_EXPECT_MSG_EQ (shared.GetZeroAreaSize (), 1000, "Shared buffer changed");
+
+  // Fragments put back together.
+  Buffer whole = Make (28, 1400, 0);
+  Buffer frag0 = whole.CreateFragment (0, 500);
+  Buffer frag1 = whole.CreateFragment (500, 500);
+  Buffer frag2 = whole.CreateFragment (1000, 428);
+  NS_TEST_EXPECT_MSG_EQ (frag1.GetZeroAreaSize (), 500, "Fragment not virtual");
+  frag0.AddAtEnd (frag1);
+  frag0.AddAtEnd (frag2);
+  NS_TEST_EXPECT_MSG_EQ (frag0.GetZeroAreaSize (), 1400, "Fragments not merged");
+  NS_TEST_EXPECT_MSG_EQ ((GetBytes (frag0) == GetBytes (whole)), true, "Wrong reassembly");
+
+  // Real bytes appended to a zero area, and the converse.
+  Buffer c = Make (8, 300, 0);
+  Buffer d = Make (10, 0, 0);
+  expected = GetBytes (c);
+  tail = GetBytes (d);
+  expected.insert (expected.end (), tail.begin (), tail.end ());
+  c.AddAtEnd (d);
+  NS_TEST_EXPECT_MSG_EQ (c.GetZeroAreaSize (), 300, "Zero area lost");
+  NS_TEST_EXPECT_MSG_EQ ((GetBytes (c) == expected), true, "Wrong content");
+  d = Make (10, 0, 0);
+  expected = GetBytes (d);
+  tail = GetBytes (Make (8, 300, 2));
+  expected.insert (expected.end (), tail.begin (), tail.end ());
+  d.AddAtEnd (Make (8, 300, 2));
+  NS_TEST_EXPECT_MSG_EQ (d.GetZeroAreaSize (), 300, "Zero area lost");
+  NS_TEST_EXPECT_MSG_EQ ((GetBytes (d) == expected), true, "Wrong content");
+
+  // Zero areas which are not adjacent: the larger one stays virtual.
+  Buffer e = Make (8, 100, 3);
+  Buffer f = Make (8, 400, 3);
+  expected = GetBytes (e);
+  tail = GetBytes (f);
+  expected.insert (expected.end (), tail.begin (), tail.end ());
+  e.AddAtEnd (f);
+  NS_TEST_EXPECT_MSG_EQ (e.GetZeroAreaSize (), 400, "Larger zero area not kept");
+  NS_TEST_EXPECT_MSG_EQ ((GetBytes (e) == expected), true, "Wrong content");
+  e = Make (8, 400, 3);
+  expected = GetBytes (e);
+  tail = GetBytes (Make (8, 100, 3));
+  expected.insert (expected.end (), tail.begin (), tail.end ());
+  e.AddAtEnd (Make (8, 100, 3));
+  NS_TEST_EXPECT_MSG_EQ (e.GetZeroAreaSize (), 400, "Larger zero area not kept");
+  NS_TEST_EXPECT_MSG_EQ ((GetBytes (e) == expected), true, "Wrong content");
+
+  // Copying the data out does not allocate the zero area.
+  std::ostringstream os;
+  whole.CopyData (&os, whole.GetSize ());
+  NS_TEST_EXPECT_MSG_EQ (os.str ().size (), 1428, "Wrong stream copy");
+  NS_TEST_EXPECT_MSG_EQ (whole.GetZeroAreaSize (), 1400, "Zero area allocated");
+
+  // Multi-byte fields on either side of the zero area, and across it.
+  Buffer fields (4);
+  fields.AddAtStart (10);
+  fields.AddAtEnd (10);
+  Buffer::Iterator i = fields.Begin ();
+  i.WriteHtolsbU64 (0x0102030405060708ULL);
+  i.WriteU16 (0x090a);
+  i.Next (4);
+  i.WriteHtonU64 (0x1112131415161718ULL);
+  i.WriteHtolsbU16 (0x191a);
+  NS_TEST_EXPECT_MSG_EQ (fields.GetZeroAreaSize (), 4, "Zero area allocated");
+  i = fields.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.ReadLsbtohU64 (), 0x0102030405060708ULL, "Wrong field");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadLsbtohU32 (), 0x0000090a, "Wrong field across zero area");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU32 (), 0x12110000, "Wrong field across zero area");
+  i.Prev (2);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU64 (), 0x1112131415161718ULL, "Wrong field");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadLsbtohU16 (), 0x191a, "Wrong field");
+  uint8_t raw[14];
+  i = fields.Begin ();
+  i.Next (8);
+  i.Read (raw, sizeof (raw));
+  uint8_t expectedRaw[14] = { 0x0a, 0x09, 0, 0, 0, 0, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18 };
+  NS_TEST_EXPECT_MSG_EQ (memcmp (raw, expectedRaw, sizeof (raw)), 0, "Wrong bytes across zero area");
+
+  // The checksum is the same whether the bytes are contiguous or not.
+  Buffer real;
+  real.AddAtStart (fields.GetSize ());
+  real.Begin ().Write (fields.Begin (), fields.End ());
+  NS_TEST_EXPECT_MSG_EQ (fields.Begin ().CalculateIpChecksum (24),
+                         real.Begin ().CalculateIpChecksum (24), "Wrong checksum");
+  NS_TEST_EXPECT_MSG_EQ (fields.Begin ().CalculateIpChecksum (13),
+                         real.Begin ().CalculateIpChecksum (13), "Wrong odd checksum");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +562,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferZeroAreaTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
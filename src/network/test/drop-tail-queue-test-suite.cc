@@ -19,6 +19,9 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/string.h"
+#include "ns3/ring-buffer.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -83,6 +86,163 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * DropTailQueue growth and wrap-around of the item storage.
+ */
+class DropTailQueueWrapTestCase : public TestCase
+{
+public:
+  DropTailQueueWrapTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueWrapTestCase::DropTailQueueWrapTestCase ()
+  : TestCase ("Check the order of the packets as the queue grows and wraps around")
+{
+}
+void
+DropTailQueueWrapTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetAttribute ("MaxSize", StringValue ("100p"));
+
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      packets.push_back (Create<Packet> (i));
+    }
+
+  // Bursts of varying sizes move the head and tail around the buffer.
+  uint32_t next = 0;
+  uint32_t expected = 0;
+  for (uint32_t round = 0; round < 50; round++)
+    {
+      uint32_t burst = (round * 7) % 30 + 1;
+      for (uint32_t i = 0; i < burst; i++)
+        {
+          queue->Enqueue (packets[next++ % packets.size ()]);
+        }
+      uint32_t drain = queue->GetNPackets () - (round % 5);
+      for (uint32_t i = 0; i < drain; i++)
+        {
+          Ptr<Packet> packet = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (packet, packets[expected++ % packets.size ()],
+                                 "The packets should be dequeued in order");
+        }
+    }
+  while (!queue->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue->Dequeue (), packets[expected++ % packets.size ()],
+                             "The packets should be dequeued in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (expected, next, "All the packets should have been dequeued");
+
+  // A full queue drops the packets beyond its maximum size.
+  for (uint32_t i = 0; i < 150; i++)
+    {
+      queue->Enqueue (packets[i % packets.size ()]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 100, "The queue should hold 100 packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 50, "50 packets should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), packets[0], "The first packet should be at the head");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer insertion in the middle and erasure while iterating.
+ */
+class RingBufferTestCase : public TestCase
+{
+public:
+  RingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferTestCase::RingBufferTestCase ()
+  : TestCase ("Check the insertions and erasures of the ring buffer")
+{
+}
+void
+RingBufferTestCase::DoRun (void)
+{
+  typedef RingBuffer<Ptr<Packet> > Ring;
+  Ring ring;
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      packets.push_back (Create<Packet> (i));
+    }
+
+  // Insert at the tail, at the head and in the middle: the packets end
+  // up sorted by size.
+  for (uint32_t i = 10; i < 20; i++)
+    {
+      ring.insert (ring.cend (), packets[i]);
+    }
+  for (uint32_t i = 10; i > 0; i--)
+    {
+      ring.insert (ring.cbegin (), packets[i - 1]);
+    }
+  for (uint32_t i = 20; i < 40; i += 2)
+    {
+      ring.insert (ring.cend (), packets[i]);
+    }
+  Ring::const_iterator it = ring.cbegin ();
+  while ((*it)->GetSize () < 21)
+    {
+      ++it;
+    }
+  for (uint32_t i = 21; i < 40; i += 2)
+    {
+      it = ring.insert (it, packets[i]);
+      NS_TEST_ASSERT_MSG_EQ (*it, packets[i], "The iterator should refer to the inserted packet");
+      ++it;
+      ++it;
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.size (), 40, "The ring should hold 40 packets");
+  uint32_t size = 0;
+  for (it = ring.cbegin (); it != ring.cend (); ++it)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((*it)->GetSize (), size, "The packets should be sorted");
+      size++;
+    }
+
+  // Erase the packets of odd sizes while iterating, as WifiMacQueue does
+  // with the expired packets.
+  for (it = ring.cbegin (); it != ring.cend (); )
+    {
+      Ring::const_iterator curr = it++;
+      if ((*curr)->GetSize () % 2 == 1)
+        {
+          ring.erase (curr);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.size (), 20, "The ring should hold 20 packets");
+  size = 0;
+  for (it = ring.cbegin (); it != ring.cend (); ++it)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((*it)->GetSize (), size, "The packets of even sizes should remain");
+      size += 2;
+    }
+
+  // The holes are reclaimed rather than growing the ring.
+  uint32_t capacity = ring.capacity ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ring.insert (ring.cend (), packets[i % packets.size ()]);
+      ring.erase (ring.cbegin ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.size (), 20, "The ring should still hold 20 packets");
+  NS_TEST_EXPECT_MSG_EQ (ring.capacity (), capacity, "The ring should not have grown");
+  ring.clear ();
+  NS_TEST_EXPECT_MSG_EQ (ring.empty (), true, "The ring should be empty");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +256,8 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueWrapTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferTestCase (), TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/node-arena.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulation-context.h"
+#include "ns3/simulator.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the nodes and devices of a simulation are allocated one
+ * after the other in its arena, and that the arena is released by
+ * Simulator::Destroy.
+ */
+class NodeArenaAllocationTestCase : public TestCase
+{
+public:
+  NodeArenaAllocationTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+NodeArenaAllocationTestCase::NodeArenaAllocationTestCase ()
+  : TestCase ("Check the allocation of the nodes and devices in the arena")
+{
+}
+
+void
+NodeArenaAllocationTestCase::DoRun (void)
+{
+  SimulationContext::Enter (Create<SimulationContext> ());
+  NS_TEST_ASSERT_MSG_EQ (NodeArena::IsEnabled (), false, "The arena should be disabled by default");
+  NodeArena::Enable ();
+  NS_TEST_ASSERT_MSG_EQ (NodeArena::IsEnabled (), true, "The arena should be enabled");
+
+  const uint32_t nNodes = 8;
+  std::vector<const void *> objects;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      node->AddDevice (device);
+      objects.push_back (PeekPointer (node));
+      objects.push_back (PeekPointer (device));
+    }
+  for (uint32_t i = 1; i < objects.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_LT (objects[i - 1], objects[i], "The objects should be allocated in creation order");
+    }
+  NodeArena::Statistics statistics = NodeArena::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (statistics.allocations, 2 * nNodes, "Wrong number of allocations");
+  NS_TEST_EXPECT_MSG_EQ (statistics.liveObjects, 2 * nNodes, "Wrong number of live objects");
+  NS_TEST_EXPECT_MSG_EQ (statistics.reservedBytes, static_cast<uint64_t> (NodeArena::BLOCK_SIZE), "The objects should fit in one block");
+  NS_TEST_EXPECT_MSG_GT (statistics.usedBytes, nNodes * (sizeof (Node) + sizeof (SimpleNetDevice)), "Wrong number of used bytes");
+
+  // the objects created while the arena is disabled come from the heap.
+  NodeArena::Disable ();
+  Ptr<Node> heapNode = CreateObject<Node> ();
+  statistics = NodeArena::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (statistics.allocations, 2 * nNodes, "The node should not be allocated in the arena");
+  heapNode = 0;
+
+  Simulator::Destroy ();
+  statistics = NodeArena::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (statistics.liveObjects, 0U, "Simulator::Destroy should delete the objects");
+  NS_TEST_EXPECT_MSG_EQ (statistics.reservedBytes, 0U, "The blocks should be released");
+  SimulationContext::Leave ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a node can outlive the arena of its simulation.
+ */
+class NodeArenaOrphanTestCase : public TestCase
+{
+public:
+  NodeArenaOrphanTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+NodeArenaOrphanTestCase::NodeArenaOrphanTestCase ()
+  : TestCase ("Check the objects which outlive their arena")
+{
+}
+
+void
+NodeArenaOrphanTestCase::DoRun (void)
+{
+  SimulationContext::Enter (Create<SimulationContext> ());
+  NodeArena::Enable ();
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  NS_TEST_EXPECT_MSG_EQ (NodeArena::GetStatistics ().liveObjects, 2U, "Wrong number of live objects");
+  // deletes the arena while the node and the device are alive.
+  SimulationContext::Leave ();
+
+  NS_TEST_EXPECT_MSG_EQ (node->GetId (), 0U, "The node should remain usable");
+  NS_TEST_EXPECT_MSG_EQ ((device->GetNode () == 0), true, "The device should remain usable");
+  // the last object releases the blocks of the arena.
+  device = 0;
+  node = 0;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * NodeArena test suite.
+ */
+class NodeArenaTestSuite : public TestSuite
+{
+public:
+  NodeArenaTestSuite ();
+};
+
+NodeArenaTestSuite::NodeArenaTestSuite ()
+  : TestSuite ("node-arena", UNIT)
+{
+  AddTestCase (new NodeArenaAllocationTestCase, TestCase::QUICK);
+  AddTestCase (new NodeArenaOrphanTestCase, TestCase::QUICK);
+}
+
+static NodeArenaTestSuite g_nodeArenaTestSuite; //!< Static variable for test initialization
@@ -20,11 +20,13 @@
 #include <cstdarg>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/header.h"
 #include "ns3/trailer.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/flow-id-tag.h"
 
 using namespace ns3;
 
@@ -903,6 +905,102 @@ PacketMetadataTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet metadata sampling unit tests.
+ */
+class PacketMetadataSamplingTest : public TestCase {
+public:
+  PacketMetadataSamplingTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param p The packet
+   * \return The sizes of the metadata items of the packet.
+   */
+  std::string GetHistory (Ptr<Packet> p);
+};
+
+PacketMetadataSamplingTest::PacketMetadataSamplingTest ()
+  : TestCase ("Packet metadata sampling")
+{
+}
+
+std::string
+PacketMetadataSamplingTest::GetHistory (Ptr<Packet> p)
+{
+  std::ostringstream oss;
+  PacketMetadata::ItemIterator k = p->BeginItem ();
+  while (k.HasNext ())
+    {
+      oss << k.Next ().currentSize;
+      if (k.HasNext ())
+        {
+          oss << " ";
+        }
+    }
+  return oss.str ();
+}
+
+void
+PacketMetadataSamplingTest::DoRun (void)
+{
+  Packet::EnableSampledPrinting (0.25, FlowIdTag::GetTypeId ());
+
+  const uint32_t nPackets = 4000;
+  uint32_t nSampled = 0;
+  Ptr<Packet> sampled;
+  Ptr<Packet> unsampled;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (10);
+      ADD_HEADER (p, 2);
+      if (p->IsSampled ())
+        {
+          nSampled++;
+          sampled = p;
+          NS_TEST_EXPECT_MSG_EQ (GetHistory (p), "2 10", "Wrong metadata of a sampled packet");
+        }
+      else
+        {
+          unsampled = p;
+          NS_TEST_EXPECT_MSG_EQ (GetHistory (p), "", "Metadata of a packet not sampled");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (nSampled, nPackets / 4, nPackets / 40, "Wrong sample rate");
+  NS_TEST_ASSERT_MSG_NE (sampled, 0, "No packet sampled");
+  NS_TEST_ASSERT_MSG_NE (unsampled, 0, "All the packets sampled");
+
+  // The metadata of a tagged packet is recorded from the time of the tag.
+  unsampled->AddPacketTag (FlowIdTag (1));
+  ADD_HEADER (unsampled, 3);
+  NS_TEST_EXPECT_MSG_EQ (unsampled->IsSampled (), true, "Tagged packet not sampled");
+  NS_TEST_EXPECT_MSG_EQ (GetHistory (unsampled), "3 12", "Wrong metadata of a tagged packet");
+
+  // A packet not sampled is appended as a payload.
+  Ptr<Packet> other = Create<Packet> (5);
+  while (other->IsSampled ())
+    {
+      other = Create<Packet> (5);
+    }
+  ADD_HEADER (other, 4);
+  sampled->AddAtEnd (other);
+  NS_TEST_EXPECT_MSG_EQ (GetHistory (sampled), "2 10 9", "Wrong metadata of a concatenation");
+
+  // The serialized metadata keeps the sample.
+  uint32_t size = sampled->GetSerializedSize ();
+  std::vector<uint8_t> buffer (size);
+  sampled->Serialize (&buffer[0], size);
+  Ptr<Packet> deserialized = Create<Packet> (&buffer[0], size, true);
+  NS_TEST_EXPECT_MSG_EQ (deserialized->IsSampled (), true, "Deserialized packet not sampled");
+  NS_TEST_EXPECT_MSG_EQ (GetHistory (deserialized), "2 10 9", "Wrong deserialized metadata");
+
+  Packet::EnableSampledPrinting (1);
+  NS_TEST_EXPECT_MSG_EQ (Create<Packet> (10)->IsSampled (), true, "Packet not sampled");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -919,6 +1017,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataSamplingTest, TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
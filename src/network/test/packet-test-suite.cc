@@ -19,6 +19,7 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/llc-snap-header.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -27,6 +28,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <vector>
 
 using namespace ns3;
 
@@ -637,6 +639,17 @@ PacketTest::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (copy.PeekPacketTag (a), true, "trivial");
     NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (c), false, "trivial");
     NS_TEST_EXPECT_MSG_EQ (copy.PeekPacketTag (c), true, "trivial");
+    uint32_t nTags = 0;
+    PacketTagIterator i = copy.GetPacketTagIterator ();
+    while (i.HasNext ())
+      {
+        PacketTagIterator::Item item = i.Next ();
+        NS_TEST_EXPECT_MSG_EQ ((item.GetTypeId () == a.GetInstanceTypeId ()
+                                || item.GetTypeId () == c.GetInstanceTypeId ()),
+                               true, "iterator");
+        nTags++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (nTags, 2, "iterator");
     p.RemoveAllPacketTags ();
     NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (b), false, "trivial");
   }
@@ -737,6 +750,118 @@ PacketTest::DoRun (void)
     ALargeTestTag a;
     tmp->AddPacketTag (a); 
   }
+
+  /* Test that a zero-filled payload stays virtual through
+   * fragmentation and reassembly
+   */
+  {
+    Ptr<Packet> tmp = Create<Packet> (1000);
+    tmp->AddHeader (ATestHeader<10> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetVirtualPayloadSize (), 1000, "Payload not virtual");
+    Ptr<Packet> frag0 = tmp->CreateFragment (0, 400);
+    Ptr<Packet> frag1 = tmp->CreateFragment (400, 610);
+    frag1->RemoveAtStart (10);
+    NS_TEST_EXPECT_MSG_EQ (frag1->GetVirtualPayloadSize (), 600, "Fragment not virtual");
+    frag0->AddAtEnd (tmp->CreateFragment (400, 10));
+    frag0->AddAtEnd (frag1);
+    NS_TEST_EXPECT_MSG_EQ (frag0->GetSize (), 1010, "Wrong reassembled size");
+    NS_TEST_EXPECT_MSG_EQ (frag0->GetVirtualPayloadSize (), 1000, "Reassembly not virtual");
+  }
+
+  {
+    // ReplaceHeader does not modify the copies of a packet.
+    LlcSnapHeader llc;
+    llc.SetType (0x0800);
+    Ptr<Packet> original = Create<Packet> (100);
+    original->AddHeader (llc);
+    Ptr<Packet> copy = original->Copy ();
+    llc.SetType (0x86dd);
+    copy->ReplaceHeader (llc);
+    LlcSnapHeader peeked;
+    original->PeekHeader (peeked);
+    NS_TEST_EXPECT_MSG_EQ (peeked.GetType (), 0x0800, "Copy modified");
+    copy->PeekHeader (peeked);
+    NS_TEST_EXPECT_MSG_EQ (peeked.GetType (), 0x86dd, "Header not replaced");
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), original->GetSize (), "Wrong size");
+    llc.SetType (0x0806);
+    copy->ReplaceHeader (llc);
+    copy->PeekHeader (peeked);
+    NS_TEST_EXPECT_MSG_EQ (peeked.GetType (), 0x0806, "Header not replaced in place");
+    NS_TEST_EXPECT_MSG_EQ (copy->GetVirtualPayloadSize (), 100, "Payload allocated");
+  }
+}
+
+/**
+ * Add the tags ATestTag<1> to ATestTag<N> to a list.
+ * \param ptl The list.
+ * \param data The data of the tags.
+ */
+template <int N>
+void
+AddTestTags (PacketTagList & ptl, uint8_t data)
+{
+  AddTestTags<N - 1> (ptl, data);
+  ptl.Add (ATestTag<N> (data));
+}
+
+/**
+ * Add no tag to a list.
+ */
+template <>
+void
+AddTestTags<0> (PacketTagList &, uint8_t)
+{
+}
+
+/**
+ * Count the tags ATestTag<1> to ATestTag<N> found in a list.
+ * \param ptl The list.
+ * \param data The expected data of the tags.
+ * \return the number of tags found with the expected data.
+ */
+template <int N>
+int
+CountTestTags (const PacketTagList & ptl, uint8_t data)
+{
+  ATestTag<N> t;
+  bool found = ptl.Peek (t) && t.GetData () == data && !t.m_error;
+  return CountTestTags<N - 1> (ptl, data) + (found ? 1 : 0);
+}
+
+/**
+ * Count no tag.
+ * \return 0
+ */
+template <>
+int
+CountTestTags<0> (const PacketTagList &, uint8_t)
+{
+  return 0;
+}
+
+/**
+ * Remove the tags ATestTag<n> with an even n up to N from a list.
+ * \param ptl The list.
+ */
+template <int N>
+void
+RemoveEvenTestTags (PacketTagList & ptl)
+{
+  if (N % 2 == 0)
+    {
+      ATestTag<N> t;
+      ptl.Remove (t);
+    }
+  RemoveEvenTestTags<N - 1> (ptl);
+}
+
+/**
+ * Remove no tag.
+ */
+template <>
+void
+RemoveEvenTestTags<0> (PacketTagList &)
+{
 }
 
 /**
@@ -994,6 +1119,30 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // More tag types than tag indices
+    std::cout << GetName () << "check many tag types" << std::endl;
+    const int nTypes = PacketTagList::OVERFLOW_INDEX + 16;
+    PacketTagList ptl;
+    AddTestTags<nTypes> (ptl, 1);
+    NS_TEST_EXPECT_MSG_EQ (CountTestTags<nTypes> (ptl, 1), nTypes, "many tags");
+
+    PacketTagList odd = ptl;
+    RemoveEvenTestTags<nTypes> (odd);
+    NS_TEST_EXPECT_MSG_EQ (CountTestTags<nTypes> (ptl, 1), nTypes, "many tags orig");
+    NS_TEST_EXPECT_MSG_EQ (CountTestTags<nTypes> (odd, 1), (nTypes + 1) / 2,
+                           "many tags without even ones");
+
+    ATestTag<nTypes> last (2);
+    odd.Replace (last);
+    CheckRef (odd, last, "replace last tag type");
+    odd.Remove (last);
+    CheckRef (odd, last, "remove last tag type", true);
+    ATestTag<nTypes> orig (1);
+    CheckRef (ptl, orig, "last tag type orig");
+    NS_TEST_EXPECT_MSG_EQ (CountTestTags<nTypes> (odd, 1), (nTypes + 1) / 2 - 1,
+                           "many tags without even and last ones");
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
@@ -1035,6 +1184,70 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet allocation statistics test
+ */
+class PacketAllocationTest : public TestCase
+{
+public:
+  PacketAllocationTest ();
+  virtual void DoRun (void);
+};
+
+PacketAllocationTest::PacketAllocationTest ()
+  : TestCase ("Packet allocation statistics")
+{
+}
+
+void
+PacketAllocationTest::DoRun (void)
+{
+  Packet::AllocationStatistics before = Packet::GetAllocationStatistics ();
+  {
+    Ptr<Packet> packet = Create<Packet> (100);
+    packet->AddHeader (ATestHeader<10> ());
+    Packet::AllocationStatistics live = Packet::GetAllocationStatistics ();
+    NS_TEST_EXPECT_MSG_GT (live.buffer.allocations, before.buffer.allocations,
+                           "Buffer not allocated");
+    NS_TEST_EXPECT_MSG_GT (live.buffer.liveBytes, before.buffer.liveBytes,
+                           "Buffer not counted");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ (live.buffer.peakBytes, live.buffer.liveBytes,
+                                 "Wrong peak");
+  }
+  Packet::AllocationStatistics released = Packet::GetAllocationStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (released.buffer.liveBytes, before.buffer.liveBytes,
+                         "Buffer not released");
+  NS_TEST_EXPECT_MSG_GT (released.buffer.cachedBytes, 0, "Buffer not kept");
+
+  {
+    Ptr<Packet> packet = Create<Packet> (100);
+    packet->AddHeader (ATestHeader<10> ());
+  }
+  Packet::AllocationStatistics reused = Packet::GetAllocationStatistics ();
+  NS_TEST_EXPECT_MSG_GT (reused.buffer.recycled, released.buffer.recycled,
+                         "Buffer not reused");
+  NS_TEST_EXPECT_MSG_EQ (reused.buffer.cachedBytes, released.buffer.cachedBytes,
+                         "Wrong size class");
+  NS_TEST_EXPECT_MSG_GT (reused.buffer.GetRecycleRate (), 0, "Wrong recycle rate");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (reused.buffer.GetRecycleRate (), 1, "Wrong recycle rate");
+
+  // Jumbo buffers are not kept in the free lists.
+  uint64_t cachedBytes;
+  {
+    std::vector<uint8_t> jumbo (3 * PacketAllocator::MAX_BLOCK_SIZE, 1);
+    Ptr<Packet> packet = Create<Packet> (jumbo.data (), jumbo.size ());
+    cachedBytes = Packet::GetAllocationStatistics ().buffer.cachedBytes;
+    NS_TEST_EXPECT_MSG_GT_OR_EQ (Packet::GetAllocationStatistics ().buffer.peakBytes,
+                                 static_cast<int64_t> (3 * PacketAllocator::MAX_BLOCK_SIZE),
+                                 "Wrong peak");
+  }
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetAllocationStatistics ().buffer.cachedBytes, cachedBytes,
+                         "Jumbo buffer kept");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1265,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketAllocationTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,454 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pcap-writer.h"
+#include "ns3/pcap-reader.h"
+#include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Fill a buffer with the bytes of the test packets.
+ * \param [out] buffer The buffer.
+ * \param [in] size The number of bytes.
+ */
+static void
+Fill (uint8_t *buffer, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      buffer[i] = i * 7;
+    }
+}
+
+/**
+ * \param [in] size The size of the packet.
+ * \returns A test packet.
+ */
+static Ptr<Packet>
+MakePacket (uint32_t size)
+{
+  std::vector<uint8_t> buffer (size);
+  Fill (buffer.data (), size);
+  return Create<Packet> (buffer.data (), size);
+}
+
+/**
+ * \param [in] filename The name of a file.
+ * \returns The bytes of the file.
+ */
+static std::vector<uint8_t>
+ReadFile (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  return std::vector<uint8_t> (std::istreambuf_iterator<char> (file),
+                               std::istreambuf_iterator<char> ());
+}
+
+/**
+ * \param [in] data The bytes of a file.
+ * \param [in] offset The position of a value.
+ * \returns The 32 bit value at \p offset.
+ */
+static uint32_t
+Get32 (const std::vector<uint8_t> &data, uint32_t offset)
+{
+  uint32_t value = 0;
+  if (offset + 4 <= data.size ())
+    {
+      std::memcpy (&value, &data[offset], 4);
+    }
+  return value;
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a batched pcap file reads back, with its records
+ * truncated to the snap length.
+ */
+class PcapWriterPcapTestCase : public TestCase
+{
+public:
+  PcapWriterPcapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapWriterPcapTestCase::PcapWriterPcapTestCase ()
+  : TestCase ("Check that batched pcap files read back")
+{
+}
+
+void
+PcapWriterPcapTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("pcap-writer.pcap");
+  // Enough packets to fill several blocks.
+  const uint32_t nPackets = 300;
+  {
+    PcapWriter writer;
+    NS_TEST_ASSERT_MSG_EQ (writer.Open (filename), true, "Cannot open " << filename);
+    NS_TEST_EXPECT_MSG_EQ (writer.AddInterface (1, 500), 0, "Wrong interface index");
+    for (uint32_t i = 0; i < nPackets; ++i)
+      {
+        writer.Write (0, MicroSeconds (1500 * i), MakePacket (60 + i * 3));
+      }
+    writer.Flush ();
+    NS_TEST_EXPECT_MSG_EQ (writer.Fail (), false, "Cannot write " << filename);
+  }
+
+  PcapFile pcap;
+  pcap.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "Cannot read " << filename);
+  NS_TEST_EXPECT_MSG_EQ (pcap.GetDataLinkType (), 1, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (pcap.GetSnapLen (), 500, "Wrong snap length");
+  NS_TEST_EXPECT_MSG_EQ (pcap.IsNanoSecMode (), false, "Wrong time stamp resolution");
+
+  uint8_t expected[1000];
+  Fill (expected, sizeof (expected));
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      uint8_t data[1000];
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      pcap.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "Cannot read packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (tsSec * 1000000ULL + tsUsec, 1500ULL * i, "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, 60 + i * 3, "Wrong length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (inclLen, std::min<uint32_t> (origLen, 500),
+                             "Wrong captured length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (data, expected, inclLen), 0,
+                             "Wrong bytes in packet " << i);
+    }
+  uint8_t data[1];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  pcap.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (pcap.Eof (), true, "Too many packets");
+  pcap.Close ();
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the blocks of a pcapng file with two interfaces.
+ */
+class PcapWriterPcapNgTestCase : public TestCase
+{
+public:
+  PcapWriterPcapNgTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapWriterPcapNgTestCase::PcapWriterPcapNgTestCase ()
+  : TestCase ("Check the blocks of pcapng files")
+{
+}
+
+void
+PcapWriterPcapNgTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("pcap-writer.pcapng");
+  PcapWriter writer;
+  NS_TEST_ASSERT_MSG_EQ (writer.Open (filename, PcapWriter::PCAPNG, PcapWriter::NONE, true),
+                         true, "Cannot open " << filename);
+  NS_TEST_EXPECT_MSG_EQ (writer.AddInterface (105, 100, "wifi0"), 0, "Wrong interface index");
+  NS_TEST_EXPECT_MSG_EQ (writer.AddInterface (1, 65535), 1, "Wrong interface index");
+  writer.Write (0, NanoSeconds (1234567890123ULL), MakePacket (150));
+  uint8_t bytes[7];
+  Fill (bytes, sizeof (bytes));
+  writer.Write (1, Seconds (2), bytes, sizeof (bytes));
+  writer.Close ();
+
+  std::vector<uint8_t> data = ReadFile (filename);
+  // The section header.
+  NS_TEST_ASSERT_MSG_EQ (Get32 (data, 0), 0x0a0d0d0a, "Wrong section header block");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, 4), 28, "Wrong section header length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, 8), 0x1a2b3c4d, "Wrong byte order magic");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, 24), 28, "Wrong section header trailer");
+
+  // The first interface, with its name and nanosecond resolution.
+  uint32_t offset = 28;
+  NS_TEST_ASSERT_MSG_EQ (Get32 (data, offset), 1, "Wrong interface block");
+  uint32_t length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 20 + 4 + 8 + 8 + 4, "Wrong interface block length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 8), 105, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 12), 100, "Wrong snap length");
+  NS_TEST_EXPECT_MSG_EQ (std::string (data.begin () + offset + 20, data.begin () + offset + 25),
+                         "wifi0", "Wrong interface name");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + length - 4), length, "Wrong interface trailer");
+  offset += length;
+  NS_TEST_ASSERT_MSG_EQ (Get32 (data, offset), 1, "Wrong interface block");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 8), 1, "Wrong data link type");
+  offset += length;
+
+  // The packet of the first interface, truncated to its snap length.
+  NS_TEST_ASSERT_MSG_EQ (Get32 (data, offset), 6, "Wrong packet block");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 32 + 100, "Wrong packet block length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 8), 0, "Wrong interface of packet");
+  uint64_t stamp = (static_cast<uint64_t> (Get32 (data, offset + 12)) << 32) + Get32 (data, offset + 16);
+  NS_TEST_EXPECT_MSG_EQ (stamp, 1234567890123ULL, "Wrong time stamp");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 20), 100, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 24), 150, "Wrong original length");
+  uint8_t expected[100];
+  Fill (expected, sizeof (expected));
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (&data[offset + 28], expected, 100), 0, "Wrong packet bytes");
+  offset += length;
+
+  // The packet of the second interface, padded to 32 bits.
+  NS_TEST_ASSERT_MSG_EQ (Get32 (data, offset), 6, "Wrong packet block");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 32 + 8, "Wrong packet block length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 8), 1, "Wrong interface of packet");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 16), 2000000000, "Wrong time stamp");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 20), 7, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (data[offset + 28 + 7], 0, "Wrong padding");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + length - 4), length, "Wrong packet trailer");
+  offset += length;
+  NS_TEST_EXPECT_MSG_EQ (offset, data.size (), "Wrong file size");
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that PcapFileWrapper writes through a PcapWriter when asked to.
+ */
+class PcapWriterWrapperTestCase : public TestCase
+{
+public:
+  PcapWriterWrapperTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapWriterWrapperTestCase::PcapWriterWrapperTestCase ()
+  : TestCase ("Check batched PcapFileWrapper files")
+{
+}
+
+void
+PcapWriterWrapperTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("pcap-writer-wrapper.pcap");
+  Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  file->SetAttribute ("Batched", BooleanValue (true));
+  file->SetAttribute ("CaptureSize", UintegerValue (64));
+  file->Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Cannot open " << filename);
+  file->Init (1);
+  NS_TEST_EXPECT_MSG_EQ (file->GetSnapLen (), 64, "Wrong snap length");
+  file->Write (MilliSeconds (3), MakePacket (100));
+  file->Close ();
+
+  PcapFile pcap;
+  pcap.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "Cannot read " << filename);
+  NS_TEST_EXPECT_MSG_EQ (pcap.GetSnapLen (), 64, "Wrong snap length");
+  uint8_t data[100];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  pcap.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "Cannot read the packet");
+  NS_TEST_EXPECT_MSG_EQ (tsUsec, 3000, "Wrong time stamp");
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 64, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 100, "Wrong original length");
+  pcap.Close ();
+
+  if (PcapWriter::IsSupported (PcapWriter::GZIP))
+    {
+      file = CreateObject<PcapFileWrapper> ();
+      file->SetAttribute ("Compression", StringValue ("Gzip"));
+      file->Open (filename, std::ios::out);
+      NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Cannot open " << filename << ".gz");
+      file->Init (1);
+      file->Write (MilliSeconds (3), MakePacket (100));
+      file->Close ();
+      std::vector<uint8_t> compressed = ReadFile (filename + ".gz");
+      NS_TEST_ASSERT_MSG_GT (compressed.size (), 2, "Empty gzip file");
+      NS_TEST_EXPECT_MSG_EQ (compressed[0], 0x1f, "Wrong gzip magic");
+      NS_TEST_EXPECT_MSG_EQ (compressed[1], 0x8b, "Wrong gzip magic");
+    }
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that PcapReader reads back the files of PcapWriter, mapped or
+ * not, compressed or not.
+ */
+class PcapReaderTestCase : public TestCase
+{
+public:
+  PcapReaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write a file and read it back.
+   * \param [in] format The format of the file.
+   * \param [in] compression The compression of the file.
+   * \param [in] nanosecMode Whether the time stamps are in nanoseconds.
+   * \param [in] map Whether to memory-map the file.
+   */
+  void Check (PcapWriter::Format format, PcapWriter::Compression compression,
+              bool nanosecMode, bool map);
+};
+
+PcapReaderTestCase::PcapReaderTestCase ()
+  : TestCase ("Check that PcapReader reads back PcapWriter files")
+{
+}
+
+void
+PcapReaderTestCase::Check (PcapWriter::Format format, PcapWriter::Compression compression,
+                           bool nanosecMode, bool map)
+{
+  std::string filename = CreateTempDirFilename ("pcap-reader");
+  // A large packet, beyond the buffer of unmapped files, between small ones.
+  const uint32_t nPackets = 200;
+  const uint32_t sizes[] = { 60, 1500, 100000 };
+  uint32_t nInterfaces = format == PcapWriter::PCAPNG ? 2 : 1;
+  {
+    PcapWriter writer;
+    NS_TEST_ASSERT_MSG_EQ (writer.Open (filename, format, compression, nanosecMode), true,
+                           "Cannot open " << filename);
+    writer.AddInterface (1, 65535);
+    if (nInterfaces == 2)
+      {
+        writer.AddInterface (101, 1000);
+      }
+    for (uint32_t i = 0; i < nPackets; ++i)
+      {
+        writer.Write (i % nInterfaces, NanoSeconds (1000000123ULL * i), MakePacket (sizes[i % 3]));
+      }
+    writer.Flush ();
+    NS_TEST_ASSERT_MSG_EQ (writer.Fail (), false, "Cannot write " << filename);
+    writer.Close ();
+  }
+
+  PcapReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename, map), true, "Cannot read " << filename);
+  NS_TEST_EXPECT_MSG_EQ (reader.GetFormat (), format, "Wrong format");
+  NS_TEST_EXPECT_MSG_EQ (reader.IsMapped () && compression == PcapWriter::GZIP, false,
+                         "Compressed files cannot be mapped");
+  std::vector<uint8_t> expected (100000);
+  Fill (expected.data (), expected.size ());
+  PcapReader::Record record;
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Cannot read packet " << i);
+      uint32_t interface = i % nInterfaces;
+      uint32_t snapLen = interface == 0 ? 65535 : 1000;
+      int64_t time = 1000000123LL * i;
+      if (!nanosecMode)
+        {
+          time -= time % 1000;
+        }
+      NS_TEST_EXPECT_MSG_EQ (record.time, NanoSeconds (time), "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.interface, interface, "Wrong interface of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.dataLinkType, (interface == 0 ? 1U : 101U),
+                             "Wrong data link type of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.origLen, sizes[i % 3], "Wrong length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.inclLen, std::min (record.origLen, snapLen),
+                             "Wrong captured length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.data, expected.data (), record.inclLen), 0,
+                             "Wrong bytes in packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.GetNInterfaces (), nInterfaces, "Wrong number of interfaces");
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Too many packets");
+  NS_TEST_EXPECT_MSG_EQ (reader.Fail (), false, "The file should not be malformed");
+}
+
+void
+PcapReaderTestCase::DoRun (void)
+{
+  for (uint32_t map = 0; map < 2; ++map)
+    {
+      Check (PcapWriter::PCAP, PcapWriter::NONE, false, map);
+      Check (PcapWriter::PCAP, PcapWriter::NONE, true, map);
+      Check (PcapWriter::PCAPNG, PcapWriter::NONE, true, map);
+      if (PcapWriter::IsSupported (PcapWriter::GZIP))
+        {
+          Check (PcapWriter::PCAPNG, PcapWriter::GZIP, true, map);
+        }
+    }
+
+  // A truncated file is malformed.
+  std::string filename = CreateTempDirFilename ("pcap-reader-truncated.pcap");
+  {
+    PcapWriter writer;
+    writer.Open (filename);
+    writer.AddInterface (1);
+    writer.Write (0, Seconds (1), MakePacket (100));
+    writer.Close ();
+  }
+  std::vector<uint8_t> data = ReadFile (filename);
+  std::ofstream truncated (filename.c_str (), std::ios::binary | std::ios::trunc);
+  truncated.write (reinterpret_cast<const char *> (data.data ()), data.size () - 10);
+  truncated.close ();
+  PcapReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Cannot read " << filename);
+  PcapReader::Record record;
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "The record is truncated");
+  NS_TEST_EXPECT_MSG_EQ (reader.Fail (), true, "The file should be malformed");
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PcapWriter test suite.
+ */
+class PcapWriterTestSuite : public TestSuite
+{
+public:
+  PcapWriterTestSuite ();
+};
+
+PcapWriterTestSuite::PcapWriterTestSuite ()
+  : TestSuite ("pcap-writer", UNIT)
+{
+  AddTestCase (new PcapWriterPcapTestCase, TestCase::QUICK);
+  AddTestCase (new PcapWriterPcapNgTestCase, TestCase::QUICK);
+  AddTestCase (new PcapWriterWrapperTestCase, TestCase::QUICK);
+  AddTestCase (new PcapReaderTestCase, TestCase::QUICK);
+}
+
+static PcapWriterTestSuite g_pcapWriterTestSuite; //!< Static variable for test initialization
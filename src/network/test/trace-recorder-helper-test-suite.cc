@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/trace-recorder-helper.h"
+#include "ns3/pcap-file.h"
+#include "ns3/simulator.h"
+#include "ns3/names.h"
+#include "ns3/traced-callback.h"
+#include "ns3/trace-source-accessor.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * An object with a packet trace source to record.
+ */
+class TraceRecorderHelperTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TracedCallback<Ptr<const Packet> > m_tx;  //!< Tx TraceSource target.
+};
+
+TypeId
+TraceRecorderHelperTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("TraceRecorderHelperTestObject")
+    .SetParent<Object> ()
+    .AddTraceSource ("Tx", "A packet.",
+                     MakeTraceSourceAccessor (&TraceRecorderHelperTestObject::m_tx),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that recorded packets are converted to pcap and ASCII traces.
+ */
+class TraceRecorderHelperTestCase : public TestCase
+{
+public:
+  TraceRecorderHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Fire the packet trace source.
+   * \param [in] object The object with the trace source.
+   * \param [in] size The size of the packet.
+   */
+  static void Send (Ptr<TraceRecorderHelperTestObject> object, uint32_t size);
+  /**
+   * Fill a buffer with the bytes of the test packets.
+   * \param [out] buffer The buffer.
+   * \param [in] size The number of bytes.
+   */
+  static void Fill (uint8_t *buffer, uint32_t size);
+};
+
+TraceRecorderHelperTestCase::TraceRecorderHelperTestCase ()
+  : TestCase ("Check the conversion of recorded packets")
+{
+}
+
+void
+TraceRecorderHelperTestCase::Fill (uint8_t *buffer, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      buffer[i] = i * 7;
+    }
+}
+
+void
+TraceRecorderHelperTestCase::Send (Ptr<TraceRecorderHelperTestObject> object, uint32_t size)
+{
+  uint8_t buffer[1000];
+  Fill (buffer, size);
+  object->m_tx (Create<Packet> (buffer, size));
+}
+
+void
+TraceRecorderHelperTestCase::DoRun (void)
+{
+  Ptr<TraceRecorderHelperTestObject> object = CreateObject<TraceRecorderHelperTestObject> ();
+  Names::Add ("TraceRecorderHelperTest", object);
+  std::string recording = CreateTempDirFilename ("trace-recorder-helper.bin");
+
+  TraceRecorder::SetSnapLength (100);
+  NS_TEST_ASSERT_MSG_EQ (TraceRecorder::Enable (recording), true, "Cannot open " << recording);
+  std::size_t connected = TraceRecorderHelper::EnablePackets
+      ("/Names/TraceRecorderHelperTest/Tx", PcapHelper::DLT_RAW, '+');
+  NS_TEST_EXPECT_MSG_EQ (connected, 1, "Trace source not connected");
+  Simulator::Schedule (MicroSeconds (1500), &TraceRecorderHelperTestCase::Send, object, 60);
+  Simulator::Schedule (Seconds (2), &TraceRecorderHelperTestCase::Send, object, 1000);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  TraceRecorder::Disable ();
+  TraceRecorder::SetSnapLength (256);
+  Names::Clear ();
+
+  std::ostringstream ascii;
+  NS_TEST_EXPECT_MSG_EQ (TraceRecorderHelper::WriteAscii (recording, ascii), true,
+                         "Invalid recording");
+  NS_TEST_EXPECT_MSG_EQ (ascii.str (),
+                         "+ 0.0015 /Names/TraceRecorderHelperTest/Tx length: 60\n"
+                         "+ 2 /Names/TraceRecorderHelperTest/Tx length: 1000\n",
+                         "Wrong ASCII trace");
+
+  std::string prefix = CreateTempDirFilename ("trace-recorder-helper");
+  std::ostringstream index;
+  std::size_t files = TraceRecorderHelper::WritePcap (recording, prefix, index);
+  NS_TEST_ASSERT_MSG_EQ (files, 1, "Wrong number of pcap files");
+  std::string name;
+  uint32_t id;
+  std::istringstream (index.str ()) >> id >> name;
+  NS_TEST_EXPECT_MSG_EQ (name, "/Names/TraceRecorderHelperTest/Tx", "Wrong index");
+
+  std::ostringstream filename;
+  filename << prefix << "-" << id << ".pcap";
+  PcapFile pcap;
+  pcap.Open (filename.str (), std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "Cannot open " << filename.str ());
+  NS_TEST_EXPECT_MSG_EQ (pcap.GetDataLinkType (), PcapHelper::DLT_RAW, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (pcap.GetSnapLen (), 100, "Wrong snap length");
+
+  uint8_t expected[1000];
+  Fill (expected, sizeof (expected));
+  uint32_t sizes[2] = { 60, 1000 };
+  uint32_t secs[2] = { 0, 2 };
+  uint32_t usecs[2] = { 1500, 0 };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      uint8_t data[1000];
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      pcap.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "Cannot read packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (tsSec, secs[i], "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (tsUsec, usecs[i], "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, sizes[i], "Wrong length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (inclLen, std::min<uint32_t> (sizes[i], 100),
+                             "Wrong captured length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (memcmp (data, expected, inclLen), 0,
+                             "Wrong bytes in packet " << i);
+    }
+  pcap.Close ();
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * TraceRecorderHelper test suite.
+ */
+class TraceRecorderHelperTestSuite : public TestSuite
+{
+public:
+  TraceRecorderHelperTestSuite ();
+};
+
+TraceRecorderHelperTestSuite::TraceRecorderHelperTestSuite ()
+  : TestSuite ("trace-recorder-helper", UNIT)
+{
+  AddTestCase (new TraceRecorderHelperTestCase, TestCase::QUICK);
+}
+
+static TraceRecorderHelperTestSuite g_traceRecorderHelperTestSuite; //!< Static variable for test initialization
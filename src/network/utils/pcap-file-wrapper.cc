@@ -17,8 +17,10 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
+#include "ns3/enum.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "pcap-file-wrapper.h"
@@ -46,12 +48,33 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("Batched",
+                   "Whether files opened for writing batch their records and "
+                   "leave the file writes to a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_batched),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Format",
+                   "The format of files opened for writing.  pcapng files are "
+                   "always batched.",
+                   EnumValue (PcapWriter::PCAP),
+                   MakeEnumAccessor (&PcapFileWrapper::m_format),
+                   MakeEnumChecker (PcapWriter::PCAP, "Pcap",
+                                    PcapWriter::PCAPNG, "PcapNg"))
+    .AddAttribute ("Compression",
+                   "The compression of files opened for writing, which get a .gz "
+                   "suffix if gzip compressed.  Compressed files are always batched.",
+                   EnumValue (PcapWriter::NONE),
+                   MakeEnumAccessor (&PcapFileWrapper::m_compression),
+                   MakeEnumChecker (PcapWriter::NONE, "None",
+                                    PcapWriter::GZIP, "Gzip"))
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_useWriter (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +89,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_useWriter)
+    {
+      return m_writer.Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -73,6 +100,10 @@ bool
 PcapFileWrapper::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_useWriter)
+    {
+      return false;
+    }
   return m_file.Eof ();
 }
 void 
@@ -86,6 +117,7 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  m_writer.Close ();
   m_file.Close ();
 }
 
@@ -93,6 +125,19 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  m_useWriter = (mode & std::ios::in) == 0
+    && (m_batched || m_format != PcapWriter::PCAP || m_compression != PcapWriter::NONE);
+  if (m_useWriter)
+    {
+      std::string name = filename;
+      if (m_compression == PcapWriter::GZIP
+          && (name.size () < 3 || name.compare (name.size () - 3, 3, ".gz") != 0))
+        {
+          name += ".gz";
+        }
+      m_writer.Open (name, m_format, m_compression, m_nanosecMode);
+      return;
+    }
   m_file.Open (filename, mode);
 }
 
@@ -105,20 +150,27 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   // a snaplen, we use the one provided.
   //
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
-  if (snapLen != std::numeric_limits<uint32_t>::max ())
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
     {
-      m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
-    } 
-  else
+      snapLen = m_snapLen;
+    }
+  if (m_useWriter)
     {
-      m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
-    } 
+      m_writer.AddInterface (dataLinkType, snapLen);
+      return;
+    }
+  m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
 }
 
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_useWriter)
+    {
+      m_writer.Write (0, t, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +191,11 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_useWriter)
+    {
+      m_writer.Write (0, t, header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +216,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_useWriter)
+    {
+      m_writer.Write (0, t, buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -178,6 +240,7 @@ PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 Ptr<Packet> 
 PcapFileWrapper::Read (Time &t)
 {
+  NS_ASSERT_MSG (!m_useWriter, "The file is open for writing");
   uint32_t tsSec;
   uint32_t tsUsec;
   uint32_t inclLen;
@@ -246,6 +309,10 @@ uint32_t
 PcapFileWrapper::GetSnapLen (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_useWriter)
+    {
+      return m_writer.GetSnapLen (0);
+    }
   return m_file.GetSnapLen ();
 }
 
@@ -253,6 +320,10 @@ uint32_t
 PcapFileWrapper::GetDataLinkType (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_useWriter)
+    {
+      return m_writer.GetDataLinkType (0);
+    }
   return m_file.GetDataLinkType ();
 }
 
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcap-writer.h"
 
 namespace ns3 {
 
@@ -35,6 +36,12 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * When the "Batched" attribute is set, or the "Format" or "Compression"
+ * attributes ask for pcapng or compressed output, files opened for
+ * writing only are written by a PcapWriter, which batches the records
+ * and hands them to a background thread.  The file header accessors
+ * other than GetSnapLen and GetDataLinkType are then not meaningful.
  */
 class PcapFileWrapper : public Object
 {
@@ -224,6 +231,11 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_batched; //!< Whether written files use a PcapWriter
+  PcapWriter::Format m_format; //!< Format of written files
+  PcapWriter::Compression m_compression; //!< Compression of written files
+  PcapWriter m_writer; //!< Batched writer of the file
+  bool     m_useWriter; //!< Whether the file is written by m_writer
 };
 
 } // namespace ns3
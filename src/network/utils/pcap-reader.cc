@@ -0,0 +1,568 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-reader.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#ifdef NS3_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* NS3_MMAP */
+#ifdef NS3_ZLIB
+#include <zlib.h>
+#endif /* NS3_ZLIB */
+
+#include <cmath>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReader");
+
+namespace {
+
+const uint32_t PCAP_MAGIC = 0xa1b2c3d4;    //!< Magic number of pcap files
+const uint32_t PCAP_NS_MAGIC = 0xa1b23c4d; //!< Magic number of nanosecond pcap files
+
+const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;  //!< Section Header Block type
+const uint32_t PCAPNG_INTERFACE = 1;                //!< Interface Description Block type
+const uint32_t PCAPNG_ENHANCED_PACKET = 6;          //!< Enhanced Packet Block type
+const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d; //!< Byte order magic of sections
+const uint16_t PCAPNG_OPT_END = 0;                  //!< End of options
+const uint16_t PCAPNG_IF_TSRESOL = 9;               //!< Time stamp resolution option
+const uint8_t PCAPNG_MICROSECONDS = 6;              //!< The default time stamp resolution
+
+/** Records and blocks larger than this are taken as a sign of corruption. */
+const uint32_t MAX_RECORD_SIZE = 1 << 28;
+
+/**
+ * \param [in] value A value.
+ * \returns The value with its bytes in the other order.
+ */
+uint32_t
+Swap32 (uint32_t value)
+{
+  return ((value & 0xff) << 24) | ((value & 0xff00) << 8)
+         | ((value >> 8) & 0xff00) | (value >> 24);
+}
+
+/**
+ * \param [in] ticks A pcapng time stamp.
+ * \param [in] resolution The time stamp resolution, as in if_tsresol.
+ * \returns The time stamp.
+ */
+Time
+PcapNgTime (uint64_t ticks, uint8_t resolution)
+{
+  uint8_t exponent = resolution & 0x7f;
+  if (resolution & 0x80)
+    {
+      // A negative power of two.
+      return NanoSeconds (static_cast<int64_t> (std::ldexp (ticks * 1e9, -exponent)));
+    }
+  uint64_t scale = 1;
+  for (uint8_t i = exponent; i < 9; ++i)
+    {
+      scale *= 10;
+    }
+  for (uint8_t i = 9; i < exponent; ++i)
+    {
+      ticks /= 10;
+    }
+  return NanoSeconds (static_cast<int64_t> (ticks * scale));
+}
+
+} // anonymous namespace
+
+PcapReader::PcapReader ()
+  : m_format (PcapWriter::PCAP),
+    m_swap (false),
+    m_nanosecMode (false),
+    m_open (false),
+    m_failed (false),
+    m_map (0),
+    m_mapSize (0),
+    m_offset (0),
+    m_gzFile (0),
+    m_begin (0),
+    m_end (0),
+    m_eof (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReader::~PcapReader ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapReader::Open (std::string const &filename, bool map)
+{
+  NS_LOG_FUNCTION (this << filename << map);
+  Close ();
+  m_filename = filename;
+  m_failed = false;
+
+#ifdef NS3_MMAP
+  if (map)
+    {
+      int fd = open (filename.c_str (), O_RDONLY);
+      struct stat st;
+      if (fd >= 0 && fstat (fd, &st) == 0 && st.st_size > 0)
+        {
+          void *address = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (address != MAP_FAILED)
+            {
+              m_map = static_cast<const uint8_t *> (address);
+              m_mapSize = st.st_size;
+              madvise (address, st.st_size, MADV_SEQUENTIAL);
+            }
+        }
+      if (fd >= 0)
+        {
+          close (fd);
+        }
+      // Compressed files are read through zlib.
+      if (m_map != 0 && m_mapSize >= 2 && m_map[0] == 0x1f && m_map[1] == 0x8b)
+        {
+          munmap (const_cast<uint8_t *> (m_map), m_mapSize);
+          m_map = 0;
+          m_mapSize = 0;
+        }
+    }
+#endif /* NS3_MMAP */
+
+  if (m_map == 0)
+    {
+#ifdef NS3_ZLIB
+      // zlib reads uncompressed files as they are.
+      m_gzFile = gzopen (filename.c_str (), "rb");
+      if (m_gzFile == 0)
+        {
+          NS_LOG_WARN ("Cannot open " << filename);
+          m_failed = true;
+          return false;
+        }
+      gzbuffer (m_gzFile, BUFFER_SIZE);
+#else /* NS3_ZLIB */
+      m_file.clear ();
+      m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+      if (!m_file.is_open ())
+        {
+          NS_LOG_WARN ("Cannot open " << filename);
+          m_failed = true;
+          return false;
+        }
+#endif /* NS3_ZLIB */
+      m_buffer.resize (BUFFER_SIZE);
+    }
+  m_open = true;
+
+  if (!ReadFileHeader ())
+    {
+      Close ();
+      m_failed = true;
+      return false;
+    }
+  return true;
+}
+
+void
+PcapReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef NS3_MMAP
+  if (m_map != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_map), m_mapSize);
+    }
+#endif /* NS3_MMAP */
+  m_map = 0;
+  m_mapSize = 0;
+  m_offset = 0;
+#ifdef NS3_ZLIB
+  if (m_gzFile != 0)
+    {
+      gzclose (m_gzFile);
+      m_gzFile = 0;
+    }
+#endif /* NS3_ZLIB */
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  std::vector<uint8_t> ().swap (m_buffer);
+  m_begin = 0;
+  m_end = 0;
+  m_eof = false;
+  m_interfaces.clear ();
+  m_open = false;
+}
+
+bool
+PcapReader::Fail (void) const
+{
+  return !m_open || m_failed;
+}
+
+bool
+PcapReader::IsMapped (void) const
+{
+  return m_map != 0;
+}
+
+PcapWriter::Format
+PcapReader::GetFormat (void) const
+{
+  return m_format;
+}
+
+uint32_t
+PcapReader::GetNInterfaces (void) const
+{
+  return m_interfaces.size ();
+}
+
+uint32_t
+PcapReader::GetDataLinkType (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].dataLinkType;
+}
+
+uint32_t
+PcapReader::GetSnapLen (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].snapLen;
+}
+
+uint32_t
+PcapReader::ReadFile (uint8_t *data, uint32_t size)
+{
+#ifdef NS3_ZLIB
+  int read = gzread (m_gzFile, data, size);
+  if (read < 0)
+    {
+      Malformed ("cannot decompress");
+      return 0;
+    }
+  return read;
+#else /* NS3_ZLIB */
+  m_file.read (reinterpret_cast<char *> (data), size);
+  return m_file.gcount ();
+#endif /* NS3_ZLIB */
+}
+
+const uint8_t *
+PcapReader::Peek (uint32_t size)
+{
+  if (m_map != 0)
+    {
+      if (m_mapSize - m_offset < size)
+        {
+          return 0;
+        }
+      return m_map + m_offset;
+    }
+
+  if (m_end - m_begin < size)
+    {
+      // Move the remaining bytes to the start of the buffer and refill it.
+      std::memmove (&m_buffer[0], &m_buffer[m_begin], m_end - m_begin);
+      m_end -= m_begin;
+      m_begin = 0;
+      if (m_buffer.size () < size)
+        {
+          m_buffer.resize (size);
+        }
+      while (m_end < size && !m_eof)
+        {
+          uint32_t read = ReadFile (&m_buffer[m_end], m_buffer.size () - m_end);
+          m_eof = read == 0;
+          m_end += read;
+        }
+      if (m_end < size)
+        {
+          return 0;
+        }
+    }
+  return &m_buffer[m_begin];
+}
+
+void
+PcapReader::Skip (uint32_t size)
+{
+  if (m_map != 0)
+    {
+      NS_ASSERT (m_mapSize - m_offset >= size);
+      m_offset += size;
+    }
+  else
+    {
+      NS_ASSERT (m_end - m_begin >= size);
+      m_begin += size;
+    }
+}
+
+uint16_t
+PcapReader::Get16 (const uint8_t *data) const
+{
+  uint16_t value;
+  std::memcpy (&value, data, 2);
+  return m_swap ? static_cast<uint16_t> ((value << 8) | (value >> 8)) : value;
+}
+
+uint32_t
+PcapReader::Get32 (const uint8_t *data) const
+{
+  uint32_t value;
+  std::memcpy (&value, data, 4);
+  return m_swap ? Swap32 (value) : value;
+}
+
+bool
+PcapReader::Malformed (std::string const &reason)
+{
+  NS_LOG_WARN ("Malformed file " << m_filename << ": " << reason);
+  m_failed = true;
+  return false;
+}
+
+bool
+PcapReader::ReadFileHeader (void)
+{
+  const uint8_t *data = Peek (4);
+  if (data == 0)
+    {
+      return Malformed ("no file header");
+    }
+  m_swap = false;
+  uint32_t magic = Get32 (data);
+  if (magic == PCAPNG_SECTION_HEADER)
+    {
+      m_format = PcapWriter::PCAPNG;
+      return ReadSectionHeader ();
+    }
+
+  m_format = PcapWriter::PCAP;
+  if (magic == Swap32 (PCAP_MAGIC) || magic == Swap32 (PCAP_NS_MAGIC))
+    {
+      m_swap = true;
+      magic = Swap32 (magic);
+    }
+  if (magic != PCAP_MAGIC && magic != PCAP_NS_MAGIC)
+    {
+      return Malformed ("not a pcap or pcapng file");
+    }
+  m_nanosecMode = magic == PCAP_NS_MAGIC;
+  data = Peek (24);
+  if (data == 0)
+    {
+      return Malformed ("truncated file header");
+    }
+  struct Interface interface;
+  interface.snapLen = Get32 (data + 16);
+  interface.dataLinkType = Get32 (data + 20);
+  interface.resolution = m_nanosecMode ? 9 : PCAPNG_MICROSECONDS;
+  m_interfaces.push_back (interface);
+  Skip (24);
+  return true;
+}
+
+bool
+PcapReader::ReadSectionHeader (void)
+{
+  // The byte order of the section follows its block type and length.
+  const uint8_t *data = Peek (12);
+  if (data == 0)
+    {
+      return Malformed ("truncated section header");
+    }
+  m_swap = false;
+  uint32_t magic = Get32 (data + 8);
+  if (magic == Swap32 (PCAPNG_BYTE_ORDER_MAGIC))
+    {
+      m_swap = true;
+    }
+  else if (magic != PCAPNG_BYTE_ORDER_MAGIC)
+    {
+      return Malformed ("wrong byte order magic");
+    }
+  uint32_t length = Get32 (data + 4);
+  if (length < 28 || length % 4 != 0 || length > MAX_RECORD_SIZE || Peek (length) == 0)
+    {
+      return Malformed ("wrong section header length");
+    }
+  m_interfaces.clear ();
+  Skip (length);
+  return true;
+}
+
+void
+PcapReader::ReadInterfaceOptions (const uint8_t *options, uint32_t size,
+                                  struct Interface &interface)
+{
+  uint32_t offset = 0;
+  while (offset + 4 <= size)
+    {
+      uint16_t code = Get16 (options + offset);
+      uint16_t length = Get16 (options + offset + 2);
+      offset += 4;
+      if (code == PCAPNG_OPT_END || offset + length > size)
+        {
+          break;
+        }
+      if (code == PCAPNG_IF_TSRESOL && length >= 1)
+        {
+          interface.resolution = options[offset];
+        }
+      offset += (length + 3) & ~3U;
+    }
+}
+
+bool
+PcapReader::Read (struct Record &record)
+{
+  if (!m_open || m_failed)
+    {
+      return false;
+    }
+  if (m_format == PcapWriter::PCAP)
+    {
+      return ReadPcapRecord (record);
+    }
+  return ReadPcapNgRecord (record);
+}
+
+bool
+PcapReader::ReadPcapRecord (struct Record &record)
+{
+  const uint8_t *data = Peek (16);
+  if (data == 0)
+    {
+      if (Peek (1) != 0)
+        {
+          return Malformed ("truncated record header");
+        }
+      return false;
+    }
+  uint32_t tsSec = Get32 (data);
+  uint32_t tsFraction = Get32 (data + 4);
+  uint32_t inclLen = Get32 (data + 8);
+  uint32_t origLen = Get32 (data + 12);
+  if (inclLen > MAX_RECORD_SIZE)
+    {
+      return Malformed ("wrong record length");
+    }
+  data = Peek (16 + inclLen);
+  if (data == 0)
+    {
+      return Malformed ("truncated record");
+    }
+  record.time = NanoSeconds (tsSec * 1000000000LL
+                             + (m_nanosecMode ? tsFraction : tsFraction * 1000LL));
+  record.interface = 0;
+  record.dataLinkType = m_interfaces[0].dataLinkType;
+  record.inclLen = inclLen;
+  record.origLen = origLen;
+  record.data = data + 16;
+  Skip (16 + inclLen);
+  return true;
+}
+
+bool
+PcapReader::ReadPcapNgRecord (struct Record &record)
+{
+  while (true)
+    {
+      const uint8_t *data = Peek (8);
+      if (data == 0)
+        {
+          if (Peek (1) != 0)
+            {
+              return Malformed ("truncated block header");
+            }
+          return false;
+        }
+      uint32_t type = Get32 (data);
+      if (type == PCAPNG_SECTION_HEADER)
+        {
+          if (!ReadSectionHeader ())
+            {
+              return false;
+            }
+          continue;
+        }
+      uint32_t length = Get32 (data + 4);
+      if (length < 12 || length % 4 != 0 || length > MAX_RECORD_SIZE)
+        {
+          return Malformed ("wrong block length");
+        }
+      data = Peek (length);
+      if (data == 0)
+        {
+          return Malformed ("truncated block");
+        }
+
+      if (type == PCAPNG_INTERFACE)
+        {
+          if (length < 20)
+            {
+              return Malformed ("wrong interface block length");
+            }
+          struct Interface interface;
+          interface.dataLinkType = Get16 (data + 8);
+          interface.snapLen = Get32 (data + 12);
+          interface.resolution = PCAPNG_MICROSECONDS;
+          ReadInterfaceOptions (data + 16, length - 20, interface);
+          m_interfaces.push_back (interface);
+        }
+      else if (type == PCAPNG_ENHANCED_PACKET)
+        {
+          if (length < 32)
+            {
+              return Malformed ("wrong packet block length");
+            }
+          uint32_t interface = Get32 (data + 8);
+          uint32_t inclLen = Get32 (data + 20);
+          if (interface >= m_interfaces.size () || inclLen > length - 32)
+            {
+              return Malformed ("wrong packet block");
+            }
+          uint64_t ticks = (static_cast<uint64_t> (Get32 (data + 12)) << 32) | Get32 (data + 16);
+          record.time = PcapNgTime (ticks, m_interfaces[interface].resolution);
+          record.interface = interface;
+          record.dataLinkType = m_interfaces[interface].dataLinkType;
+          record.inclLen = inclLen;
+          record.origLen = Get32 (data + 24);
+          record.data = data + 28;
+          Skip (length);
+          return true;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Skip block of type " << type);
+        }
+      Skip (length);
+    }
+}
+
+} // namespace ns3
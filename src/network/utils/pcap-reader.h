@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_READER_H
+#define PCAP_READER_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/nstime.h"
+#include "ns3/pcap-writer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief A streaming reader of pcap and pcapng files.
+ *
+ * Unlike PcapFile::Read, which copies each record into a buffer of the
+ * caller, a PcapReader hands out the captured bytes of one record at a
+ * time in place: the file is memory-mapped when possible, and read
+ * through a buffer holding a few records otherwise, so that files much
+ * larger than the memory can be read.  Gzip compressed files, such as
+ * those of PcapWriter, are decompressed on the fly if zlib was found at
+ * configuration.
+ *
+ * Both byte orders and the microsecond and nanosecond variants of pcap
+ * are read.  Of the pcapng blocks, the Section Header, Interface
+ * Description and Enhanced Packet Blocks are read and the others are
+ * skipped.
+ */
+class PcapReader
+{
+public:
+  /** A record of the file. */
+  struct Record
+  {
+    Time time;              //!< The time stamp of the packet.
+    uint32_t interface;     //!< The index of the interface, 0 in pcap files.
+    uint32_t dataLinkType;  //!< The data link type of the interface.
+    uint32_t inclLen;       //!< The number of captured bytes.
+    uint32_t origLen;       //!< The number of bytes of the packet.
+    const uint8_t *data;    //!< The captured bytes, valid until the next Read.
+  };
+
+  PcapReader ();
+  /** Close the file. */
+  ~PcapReader ();
+
+  /**
+   * Open a file and read its header.
+   *
+   * \param [in] filename The name of the file.
+   * \param [in] map Whether to memory-map the file, if it is not
+   *             compressed and memory mapping is supported.
+   * \returns false if the file cannot be opened or is not a pcap or
+   *          pcapng file.
+   */
+  bool Open (std::string const &filename, bool map = true);
+  /**
+   * Read the next record.
+   *
+   * \param [out] record The record.
+   * \returns false at the end of the file, or if the file is malformed,
+   *          which Fail then tells.
+   */
+  bool Read (struct Record &record);
+  /**
+   * Close the file.
+   */
+  void Close (void);
+  /**
+   * \returns true if the file is not open or is malformed.
+   */
+  bool Fail (void) const;
+
+  /**
+   * \returns true if the file is memory-mapped.
+   */
+  bool IsMapped (void) const;
+  /**
+   * \returns The format of the file.
+   */
+  PcapWriter::Format GetFormat (void) const;
+  /**
+   * \returns The number of interfaces described so far.
+   */
+  uint32_t GetNInterfaces (void) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The data link type of the interface.
+   */
+  uint32_t GetDataLinkType (uint32_t interface) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The snap length of the interface.
+   */
+  uint32_t GetSnapLen (uint32_t interface) const;
+
+private:
+  /** The size of the buffer of unmapped files. */
+  static const uint32_t BUFFER_SIZE = 1 << 16;
+
+  /** An interface of the file. */
+  struct Interface
+  {
+    uint32_t dataLinkType; //!< The data link type.
+    uint32_t snapLen;      //!< The snap length.
+    uint8_t resolution;    //!< The time stamp resolution, as in if_tsresol.
+  };
+
+  /**
+   * \param [in] size A number of bytes.
+   * \returns The next \p size bytes of the file, or 0 if the file is
+   *          shorter.  The bytes are valid until the next call.
+   */
+  const uint8_t *Peek (uint32_t size);
+  /**
+   * Move past bytes returned by Peek.
+   * \param [in] size The number of bytes.
+   */
+  void Skip (uint32_t size);
+  /**
+   * Read bytes of an unmapped file.
+   * \param [out] data The place of the bytes.
+   * \param [in] size The maximum number of bytes.
+   * \returns The number of bytes read.
+   */
+  uint32_t ReadFile (uint8_t *data, uint32_t size);
+  /**
+   * Read the pcap file header, or the pcapng section header.
+   * \returns false if the file is not a pcap or pcapng file.
+   */
+  bool ReadFileHeader (void);
+  /**
+   * Read a pcapng section header.
+   * \returns false if the block is malformed.
+   */
+  bool ReadSectionHeader (void);
+  /**
+   * Read the options of a pcapng interface.
+   * \param [in] options The options.
+   * \param [in] size The size of the options.
+   * \param [in,out] interface The interface.
+   */
+  void ReadInterfaceOptions (const uint8_t *options, uint32_t size,
+                             struct Interface &interface);
+  /**
+   * Read a pcap record.
+   * \param [out] record The record.
+   * \returns false at the end of the file.
+   */
+  bool ReadPcapRecord (struct Record &record);
+  /**
+   * Read pcapng blocks up to the next packet.
+   * \param [out] record The record.
+   * \returns false at the end of the file.
+   */
+  bool ReadPcapNgRecord (struct Record &record);
+  /**
+   * \param [in] data Two bytes of the file.
+   * \returns The value of the bytes, in the byte order of the file.
+   */
+  uint16_t Get16 (const uint8_t *data) const;
+  /**
+   * \param [in] data Four bytes of the file.
+   * \returns The value of the bytes, in the byte order of the file.
+   */
+  uint32_t Get32 (const uint8_t *data) const;
+  /**
+   * Mark the file as malformed.
+   * \param [in] reason The reason.
+   * \returns false.
+   */
+  bool Malformed (std::string const &reason);
+
+  std::string m_filename;          //!< The name of the file.
+  PcapWriter::Format m_format;     //!< The format of the file.
+  bool m_swap;                     //!< Whether the file is in the other byte order.
+  bool m_nanosecMode;              //!< Whether pcap time stamps are in nanoseconds.
+  bool m_open;                     //!< Whether the file is open.
+  bool m_failed;                   //!< Whether the file is malformed.
+  std::vector<struct Interface> m_interfaces; //!< The interfaces of the section.
+  const uint8_t *m_map;            //!< The mapped file, or 0.
+  uint64_t m_mapSize;              //!< The size of the mapped file.
+  uint64_t m_offset;               //!< The position in the mapped file.
+  std::ifstream m_file;            //!< The unmapped, uncompressed file.
+  struct gzFile_s *m_gzFile;       //!< The compressed file.
+  std::vector<uint8_t> m_buffer;   //!< The buffered bytes of an unmapped file.
+  uint32_t m_begin;                //!< The position of the next byte in the buffer.
+  uint32_t m_end;                  //!< The end of the buffered bytes.
+  bool m_eof;                      //!< Whether the unmapped file was read to its end.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_READER_H */
@@ -0,0 +1,690 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-writer.h"
+#include "ns3/core-config.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif /* HAVE_PTHREAD_H */
+#ifdef NS3_ZLIB
+#include <zlib.h>
+#endif /* NS3_ZLIB */
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapWriter");
+
+namespace {
+
+const uint32_t PCAP_MAGIC = 0xa1b2c3d4;    //!< Magic number of pcap files
+const uint32_t PCAP_NS_MAGIC = 0xa1b23c4d; //!< Magic number of nanosecond pcap files
+const uint16_t PCAP_VERSION_MAJOR = 2;     //!< Major version of pcap files
+const uint16_t PCAP_VERSION_MINOR = 4;     //!< Minor version of pcap files
+
+const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;  //!< Section Header Block type
+const uint32_t PCAPNG_INTERFACE = 1;                //!< Interface Description Block type
+const uint32_t PCAPNG_ENHANCED_PACKET = 6;          //!< Enhanced Packet Block type
+const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d; //!< Byte order magic of sections
+const uint16_t PCAPNG_OPT_END = 0;                  //!< End of options
+const uint16_t PCAPNG_IF_NAME = 2;                  //!< Interface name option
+const uint16_t PCAPNG_IF_TSRESOL = 9;               //!< Time stamp resolution option
+
+/** The maximum number of blocks waiting to be written, before writers wait. */
+const uint32_t MAX_QUEUED = 64;
+
+/**
+ * \param [in] p Where to write.
+ * \param [in] value The value to write in host byte order.
+ * \returns The byte following the value.
+ */
+inline uint8_t *
+Put16 (uint8_t *p, uint16_t value)
+{
+  std::memcpy (p, &value, 2);
+  return p + 2;
+}
+
+/**
+ * \param [in] p Where to write.
+ * \param [in] value The value to write in host byte order.
+ * \returns The byte following the value.
+ */
+inline uint8_t *
+Put32 (uint8_t *p, uint32_t value)
+{
+  std::memcpy (p, &value, 4);
+  return p + 4;
+}
+
+/**
+ * \param [in] size A number of bytes.
+ * \returns \p size rounded up to the 32 bit boundary of pcapng blocks.
+ */
+inline uint32_t
+Pad4 (uint32_t size)
+{
+  return (size + 3) & ~3U;
+}
+
+} // unnamed namespace
+
+
+/**
+ * The writer thread, shared by all the PcapWriter of the process, and
+ * the blocks it recycles.
+ */
+class PcapWriter::Thread
+{
+public:
+  Thread ();
+  /**
+   * \param [in] size The number of bytes needed.
+   * \returns An empty block of at least \p size bytes.
+   */
+  struct Block *Get (uint32_t size);
+  /**
+   * Queue a block to write.
+   * \param [in] writer The writer of the block.
+   * \param [in] block The block.
+   */
+  void Put (PcapWriter *writer, struct Block *block);
+  /**
+   * Wait until the blocks of a writer are written.
+   * \param [in] writer The writer.
+   */
+  void Wait (PcapWriter *writer);
+  /**
+   * \param [in] writer A writer.
+   * \returns true if a block of \p writer could not be written.
+   */
+  bool HasFailed (const PcapWriter *writer);
+  /** Register an open writer, starting the thread if needed. */
+  void Attach (void);
+  /** Unregister a closed writer, stopping the thread after the last one. */
+  void Detach (void);
+
+private:
+  /**
+   * Keep or free a written block.  Called with the mutex held.
+   * \param [in] block The block.
+   */
+  void Recycle (struct Block *block);
+  /** Write the queued blocks, until stopped. */
+  void Run (void);
+
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_mutex;          //!< Protects the members below and the writers' state.
+  SystemMutex m_life;           //!< Serializes the start and stop of the thread.
+  SystemCondition m_ready;      //!< Blocks are waiting to be written.
+  SystemCondition m_written;    //!< A block was written.
+  std::deque<std::pair<PcapWriter *, struct Block *> > m_full; //!< Blocks to write.
+  Ptr<SystemThread> m_thread;   //!< The thread.
+  uint32_t m_users;             //!< The number of open writers.
+  bool m_stopping;              //!< Whether the thread should stop.
+#endif /* HAVE_PTHREAD_H */
+  std::vector<struct Block *> m_free; //!< Written blocks.
+};
+
+PcapWriter::Thread *
+PcapWriter::GetThread (void)
+{
+  // Never deleted: writers may be closed by static destructors.
+  static PcapWriter::Thread *thread = new PcapWriter::Thread ();
+  return thread;
+}
+
+PcapWriter::Thread::Thread ()
+#ifdef HAVE_PTHREAD_H
+  : m_users (0),
+    m_stopping (false)
+#endif /* HAVE_PTHREAD_H */
+{
+}
+
+struct PcapWriter::Block *
+PcapWriter::Thread::Get (uint32_t size)
+{
+  struct Block *block = 0;
+  if (size <= BLOCK_SIZE)
+    {
+#ifdef HAVE_PTHREAD_H
+      CriticalSection critical (m_mutex);
+#endif /* HAVE_PTHREAD_H */
+      if (!m_free.empty ())
+        {
+          block = m_free.back ();
+          m_free.pop_back ();
+        }
+    }
+  if (block == 0)
+    {
+      block = new Block ();
+      block->capacity = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+      block->data = new uint8_t [block->capacity];
+    }
+  block->used = 0;
+  return block;
+}
+
+void
+PcapWriter::Thread::Recycle (struct Block *block)
+{
+  if (block->capacity == BLOCK_SIZE && m_free.size () < MAX_QUEUED)
+    {
+      m_free.push_back (block);
+    }
+  else
+    {
+      delete [] block->data;
+      delete block;
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+void
+PcapWriter::Thread::Put (PcapWriter *writer, struct Block *block)
+{
+  CriticalSection critical (m_mutex);
+  while (m_full.size () >= MAX_QUEUED)
+    {
+      // The file lags behind: wait rather than grow without bound.
+      m_written.SetCondition (false);
+      m_mutex.Unlock ();
+      m_written.TimedWait (1000000);
+      m_mutex.Lock ();
+    }
+  ++writer->m_pending;
+  m_full.push_back (std::make_pair (writer, block));
+  m_ready.SetCondition (true);
+  m_ready.Signal ();
+}
+
+void
+PcapWriter::Thread::Wait (PcapWriter *writer)
+{
+  CriticalSection critical (m_mutex);
+  while (writer->m_pending > 0)
+    {
+      m_written.SetCondition (false);
+      m_mutex.Unlock ();
+      m_written.TimedWait (1000000);
+      m_mutex.Lock ();
+    }
+}
+
+bool
+PcapWriter::Thread::HasFailed (const PcapWriter *writer)
+{
+  CriticalSection critical (m_mutex);
+  return writer->m_failed;
+}
+
+void
+PcapWriter::Thread::Attach (void)
+{
+  CriticalSection life (m_life);
+  CriticalSection critical (m_mutex);
+  if (m_users++ == 0)
+    {
+      m_stopping = false;
+      m_thread = Create<SystemThread> (MakeCallback (&PcapWriter::Thread::Run, this));
+      m_thread->Start ();
+    }
+}
+
+void
+PcapWriter::Thread::Detach (void)
+{
+  CriticalSection life (m_life);
+  {
+    CriticalSection critical (m_mutex);
+    NS_ASSERT (m_users > 0);
+    if (--m_users > 0)
+      {
+        return;
+      }
+    m_stopping = true;
+    m_ready.SetCondition (true);
+    m_ready.Signal ();
+  }
+  m_thread->Join ();
+  m_thread = 0;
+}
+
+void
+PcapWriter::Thread::Run (void)
+{
+  while (true)
+    {
+      PcapWriter *writer = 0;
+      struct Block *block = 0;
+      {
+        CriticalSection critical (m_mutex);
+        if (!m_full.empty ())
+          {
+            writer = m_full.front ().first;
+            block = m_full.front ().second;
+            m_full.pop_front ();
+          }
+        else if (m_stopping)
+          {
+            break;
+          }
+        else
+          {
+            m_ready.SetCondition (false);
+          }
+      }
+      if (block == 0)
+        {
+          // Polling bounds the delay of a missed signal.
+          m_ready.TimedWait (10000000);
+          continue;
+        }
+      bool ok = writer->WriteBlock (block);
+      {
+        CriticalSection critical (m_mutex);
+        writer->m_failed |= !ok;
+        --writer->m_pending;
+        Recycle (block);
+        m_written.SetCondition (true);
+      }
+      m_written.Broadcast ();
+    }
+}
+
+#else /* HAVE_PTHREAD_H */
+
+void
+PcapWriter::Thread::Put (PcapWriter *writer, struct Block *block)
+{
+  writer->m_failed |= !writer->WriteBlock (block);
+  Recycle (block);
+}
+
+void
+PcapWriter::Thread::Wait (PcapWriter *writer)
+{
+}
+
+bool
+PcapWriter::Thread::HasFailed (const PcapWriter *writer)
+{
+  return writer->m_failed;
+}
+
+void
+PcapWriter::Thread::Attach (void)
+{
+}
+
+void
+PcapWriter::Thread::Detach (void)
+{
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+
+PcapWriter::PcapWriter ()
+  : m_format (PCAP),
+    m_compression (NONE),
+    m_nanosecMode (false),
+    m_gzFile (0),
+    m_open (false),
+    m_failed (false),
+    m_block (0),
+    m_pending (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapWriter::~PcapWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapWriter::IsSupported (Compression compression)
+{
+#ifdef NS3_ZLIB
+  return true;
+#else /* NS3_ZLIB */
+  return compression == NONE;
+#endif /* NS3_ZLIB */
+}
+
+bool
+PcapWriter::Open (std::string const &filename, Format format,
+                  Compression compression, bool nanosecMode)
+{
+  NS_LOG_FUNCTION (this << filename << format << compression << nanosecMode);
+  NS_ASSERT_MSG (!m_open, "File " << m_filename << " is already open");
+  m_filename = filename;
+  m_format = format;
+  m_compression = compression;
+  m_nanosecMode = nanosecMode;
+  m_failed = false;
+  m_interfaces.clear ();
+
+  if (compression == GZIP)
+    {
+#ifdef NS3_ZLIB
+      m_gzFile = gzopen (filename.c_str (), "wb");
+      m_open = m_gzFile != 0;
+#else /* NS3_ZLIB */
+      NS_LOG_WARN ("Cannot write " << filename << ": ns-3 was configured without zlib");
+#endif /* NS3_ZLIB */
+    }
+  else
+    {
+      m_file.clear ();
+      m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      m_open = m_file.is_open ();
+    }
+  if (!m_open)
+    {
+      return false;
+    }
+  GetThread ()->Attach ();
+
+  if (m_format == PCAPNG)
+    {
+      uint8_t *p = Reserve (28);
+      p = Put32 (p, PCAPNG_SECTION_HEADER);
+      p = Put32 (p, 28);
+      p = Put32 (p, PCAPNG_BYTE_ORDER_MAGIC);
+      p = Put16 (p, 1);
+      p = Put16 (p, 0);
+      // The section length is unknown.
+      p = Put32 (p, 0xffffffff);
+      p = Put32 (p, 0xffffffff);
+      Put32 (p, 28);
+    }
+  return true;
+}
+
+uint32_t
+PcapWriter::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name);
+  NS_ASSERT (m_open);
+  NS_ABORT_MSG_IF (m_format == PCAP && !m_interfaces.empty (),
+                   "The pcap file " << m_filename << " has a single interface");
+  struct Interface interface;
+  interface.dataLinkType = dataLinkType;
+  interface.snapLen = snapLen;
+  m_interfaces.push_back (interface);
+
+  if (m_format == PCAP)
+    {
+      uint8_t *p = Reserve (24);
+      p = Put32 (p, m_nanosecMode ? PCAP_NS_MAGIC : PCAP_MAGIC);
+      p = Put16 (p, PCAP_VERSION_MAJOR);
+      p = Put16 (p, PCAP_VERSION_MINOR);
+      p = Put32 (p, 0);
+      p = Put32 (p, 0);
+      p = Put32 (p, snapLen);
+      Put32 (p, dataLinkType);
+      return 0;
+    }
+
+  uint32_t options = 0;
+  if (!name.empty ())
+    {
+      options += 4 + Pad4 (name.size ());
+    }
+  if (m_nanosecMode)
+    {
+      options += 4 + 4;
+    }
+  if (options != 0)
+    {
+      options += 4;
+    }
+  uint32_t blockLength = 20 + options;
+  uint8_t *p = Reserve (blockLength);
+  std::memset (p, 0, blockLength);
+  p = Put32 (p, PCAPNG_INTERFACE);
+  p = Put32 (p, blockLength);
+  p = Put16 (p, dataLinkType);
+  p = Put16 (p, 0);
+  p = Put32 (p, snapLen);
+  if (!name.empty ())
+    {
+      p = Put16 (p, PCAPNG_IF_NAME);
+      p = Put16 (p, name.size ());
+      std::memcpy (p, name.data (), name.size ());
+      p += Pad4 (name.size ());
+    }
+  if (m_nanosecMode)
+    {
+      p = Put16 (p, PCAPNG_IF_TSRESOL);
+      p = Put16 (p, 1);
+      *p = 9;
+      p += 4;
+    }
+  if (options != 0)
+    {
+      p = Put16 (p, PCAPNG_OPT_END);
+      p = Put16 (p, 0);
+    }
+  Put32 (p, blockLength);
+  return m_interfaces.size () - 1;
+}
+
+uint8_t *
+PcapWriter::Reserve (uint32_t size)
+{
+  if (m_block != 0 && m_block->used + size > m_block->capacity)
+    {
+      Submit ();
+    }
+  if (m_block == 0)
+    {
+      m_block = GetThread ()->Get (size);
+    }
+  uint8_t *start = m_block->data + m_block->used;
+  m_block->used += size;
+  return start;
+}
+
+uint8_t *
+PcapWriter::WriteRecordHeader (uint32_t interface, Time t, uint32_t totalLen,
+                               uint32_t &inclLen)
+{
+  NS_ASSERT (m_open);
+  NS_ASSERT_MSG (interface < m_interfaces.size (), "Unknown interface " << interface);
+  inclLen = std::min (totalLen, m_interfaces[interface].snapLen);
+  uint64_t stamp = m_nanosecMode ? t.GetNanoSeconds () : t.GetMicroSeconds ();
+  uint8_t *p;
+  if (m_format == PCAP)
+    {
+      uint64_t perSecond = m_nanosecMode ? 1000000000 : 1000000;
+      p = Reserve (16 + inclLen);
+      p = Put32 (p, stamp / perSecond);
+      p = Put32 (p, stamp % perSecond);
+      p = Put32 (p, inclLen);
+      p = Put32 (p, totalLen);
+    }
+  else
+    {
+      uint32_t blockLength = 32 + Pad4 (inclLen);
+      p = Reserve (blockLength);
+      std::memset (p + 28 + inclLen, 0, Pad4 (inclLen) - inclLen);
+      Put32 (p + blockLength - 4, blockLength);
+      p = Put32 (p, PCAPNG_ENHANCED_PACKET);
+      p = Put32 (p, blockLength);
+      p = Put32 (p, interface);
+      p = Put32 (p, stamp >> 32);
+      p = Put32 (p, stamp & 0xffffffff);
+      p = Put32 (p, inclLen);
+      p = Put32 (p, totalLen);
+    }
+  return p;
+}
+
+void
+PcapWriter::Write (uint32_t interface, Time t, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << p);
+  uint32_t inclLen;
+  uint8_t *data = WriteRecordHeader (interface, t, p->GetSize (), inclLen);
+  p->CopyData (data, inclLen);
+}
+
+void
+PcapWriter::Write (uint32_t interface, Time t, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << &header << p);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t inclLen;
+  uint8_t *data = WriteRecordHeader (interface, t, headerSize + p->GetSize (), inclLen);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.CopyData (data, toCopy);
+  p->CopyData (data + toCopy, inclLen - toCopy);
+}
+
+void
+PcapWriter::Write (uint32_t interface, Time t, uint8_t const *data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << t << &data << totalLen);
+  uint32_t inclLen;
+  uint8_t *start = WriteRecordHeader (interface, t, totalLen, inclLen);
+  std::memcpy (start, data, inclLen);
+}
+
+void
+PcapWriter::Submit (void)
+{
+  if (m_block != 0)
+    {
+      GetThread ()->Put (this, m_block);
+      m_block = 0;
+    }
+}
+
+bool
+PcapWriter::WriteBlock (const struct Block *block)
+{
+#ifdef NS3_ZLIB
+  if (m_gzFile != 0)
+    {
+      return gzwrite (m_gzFile, block->data, block->used) == static_cast<int> (block->used);
+    }
+#endif /* NS3_ZLIB */
+  m_file.write (reinterpret_cast<const char *> (block->data), block->used);
+  return !m_file.fail ();
+}
+
+void
+PcapWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_open)
+    {
+      return;
+    }
+  Submit ();
+  GetThread ()->Wait (this);
+  // The writer thread is done with the file until the next block.
+  bool ok;
+#ifdef NS3_ZLIB
+  if (m_gzFile != 0)
+    {
+      ok = gzflush (m_gzFile, Z_SYNC_FLUSH) == Z_OK;
+    }
+  else
+#endif /* NS3_ZLIB */
+    {
+      m_file.flush ();
+      ok = !m_file.fail ();
+    }
+  m_failed |= !ok;
+}
+
+void
+PcapWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_open)
+    {
+      return;
+    }
+  Submit ();
+  GetThread ()->Wait (this);
+#ifdef NS3_ZLIB
+  if (m_gzFile != 0)
+    {
+      m_failed |= gzclose (m_gzFile) != Z_OK;
+      m_gzFile = 0;
+    }
+#endif /* NS3_ZLIB */
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+      m_failed |= m_file.fail ();
+    }
+  m_open = false;
+  GetThread ()->Detach ();
+}
+
+bool
+PcapWriter::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return !m_open || GetThread ()->HasFailed (this);
+}
+
+uint32_t
+PcapWriter::GetNInterfaces (void) const
+{
+  return m_interfaces.size ();
+}
+
+uint32_t
+PcapWriter::GetSnapLen (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].snapLen;
+}
+
+uint32_t
+PcapWriter::GetDataLinkType (uint32_t interface) const
+{
+  NS_ASSERT (interface < m_interfaces.size ());
+  return m_interfaces[interface].dataLinkType;
+}
+
+} // namespace ns3
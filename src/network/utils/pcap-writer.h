@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_WRITER_H
+#define PCAP_WRITER_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+
+/** The zlib compressed file handle, see gzFile. */
+struct gzFile_s;
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \ingroup network
+ *
+ * \brief A batched, write-only pcap or pcapng file.
+ *
+ * Unlike PcapFile, which writes each record to its stream in the
+ * calling thread, a PcapWriter assembles its records in blocks of
+ * BLOCK_SIZE bytes and hands the full blocks to a background thread,
+ * shared by all the writers of the process, which writes them to the
+ * file, compressing them if asked to.  The simulation thread thus only
+ * pays for copying the captured bytes, which are truncated to the snap
+ * length before any copy.  Without threading support, the blocks are
+ * written in the calling thread.
+ *
+ * A pcap file has a single interface; a pcapng file has one Interface
+ * Description Block per call to AddInterface, and its records are
+ * Enhanced Packet Blocks referring to their interface.  Both are
+ * written in the byte order of the host.
+ *
+ * The file is complete once Flush or Close returned.
+ */
+class PcapWriter
+{
+public:
+  /** The file formats. */
+  enum Format
+  {
+    PCAP,   //!< The classic libpcap format, with a single interface
+    PCAPNG  //!< The pcapng format, with any number of interfaces
+  };
+
+  /** The compressions of the file. */
+  enum Compression
+  {
+    NONE,   //!< No compression
+    GZIP    //!< gzip compression, if zlib was found at configuration
+  };
+
+  /** The size of the blocks handed to the writer thread. */
+  static const uint32_t BLOCK_SIZE = 1 << 16;
+
+  PcapWriter ();
+  /** Close the file. */
+  ~PcapWriter ();
+
+  /**
+   * \param [in] compression A compression.
+   * \returns true if files can be written with \p compression.
+   */
+  static bool IsSupported (Compression compression);
+
+  /**
+   * Create a file, replacing any file of the same name.
+   *
+   * \param [in] filename The name of the file.
+   * \param [in] format The format of the file.
+   * \param [in] compression The compression of the file.
+   * \param [in] nanosecMode Whether the time stamps are in nanoseconds
+   *             rather than microseconds.
+   * \returns false if the file cannot be created.
+   */
+  bool Open (std::string const &filename, Format format = PCAP,
+             Compression compression = NONE, bool nanosecMode = false);
+  /**
+   * Add an interface to the file.  A pcap file has a single interface.
+   *
+   * \param [in] dataLinkType The data link type of the packets of the
+   *             interface, see PcapHelper::DataLinkType.
+   * \param [in] snapLen The maximum number of bytes of each packet
+   *             written to the file.
+   * \param [in] name The name of the interface, written to pcapng files
+   *             only.
+   * \returns The index of the interface, to pass to Write.
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen = 65535,
+                         std::string const &name = "");
+
+  /**
+   * \brief Write a packet.
+   *
+   * \param [in] interface The index of the interface of the packet.
+   * \param [in] t The time stamp of the packet.
+   * \param [in] p The packet.
+   */
+  void Write (uint32_t interface, Time t, Ptr<const Packet> p);
+  /**
+   * \brief Write a packet preceded by a header.
+   *
+   * \param [in] interface The index of the interface of the packet.
+   * \param [in] t The time stamp of the packet.
+   * \param [in] header The header to write in front of the packet.
+   * \param [in] p The packet.
+   */
+  void Write (uint32_t interface, Time t, const Header &header, Ptr<const Packet> p);
+  /**
+   * \brief Write the bytes of a packet.
+   *
+   * \param [in] interface The index of the interface of the packet.
+   * \param [in] t The time stamp of the packet.
+   * \param [in] data The bytes of the packet.
+   * \param [in] totalLen The number of bytes of the packet.
+   */
+  void Write (uint32_t interface, Time t, uint8_t const *data, uint32_t totalLen);
+
+  /**
+   * Wait until all the records written so far are in the file.
+   */
+  void Flush (void);
+  /**
+   * Flush and close the file.
+   */
+  void Close (void);
+  /**
+   * \returns true if the file is not open or could not be written.
+   */
+  bool Fail (void) const;
+
+  /**
+   * \returns The number of interfaces of the file.
+   */
+  uint32_t GetNInterfaces (void) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The snap length of the interface.
+   */
+  uint32_t GetSnapLen (uint32_t interface) const;
+  /**
+   * \param [in] interface The index of an interface.
+   * \returns The data link type of the interface.
+   */
+  uint32_t GetDataLinkType (uint32_t interface) const;
+
+private:
+  class Thread;
+  friend class Thread;
+
+  /** A block of records. */
+  struct Block
+  {
+    uint8_t *data;      //!< The records.
+    uint32_t used;      //!< The number of bytes of records.
+    uint32_t capacity;  //!< The size of the data.
+  };
+
+  /** An interface of the file. */
+  struct Interface
+  {
+    uint32_t dataLinkType; //!< The data link type.
+    uint32_t snapLen;      //!< The snap length.
+  };
+
+  /**
+   * \param [in] size A number of bytes.
+   * \returns The place of \p size bytes at the end of the current block.
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * Start a record, reserving its header and captured bytes.
+   *
+   * \param [in] interface The index of the interface of the packet.
+   * \param [in] t The time stamp of the packet.
+   * \param [in] totalLen The number of bytes of the packet.
+   * \param [out] inclLen The number of bytes to capture.
+   * \returns The place of the \p inclLen captured bytes.
+   */
+  uint8_t *WriteRecordHeader (uint32_t interface, Time t, uint32_t totalLen,
+                              uint32_t &inclLen);
+  /**
+   * Hand the current block to the writer thread.
+   */
+  void Submit (void);
+  /**
+   * Write a block to the file.  Called by the writer thread.
+   * \param [in] block The block.
+   * \returns false if the block could not be written.
+   */
+  bool WriteBlock (const struct Block *block);
+  /**
+   * \returns The writer thread.
+   */
+  static Thread *GetThread (void);
+
+  std::string m_filename;                 //!< The name of the file.
+  Format m_format;                        //!< The format of the file.
+  Compression m_compression;              //!< The compression of the file.
+  bool m_nanosecMode;                     //!< Whether time stamps are in nanoseconds.
+  std::ofstream m_file;                   //!< The uncompressed file.
+  struct gzFile_s *m_gzFile;              //!< The compressed file.
+  bool m_open;                            //!< Whether the file is open.
+  bool m_failed;                          //!< Whether a write failed.
+  std::vector<struct Interface> m_interfaces; //!< The interfaces.
+  struct Block *m_block;                  //!< The current block, or 0.
+  uint32_t m_pending;                     //!< The blocks waiting to be written.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_WRITER_H */
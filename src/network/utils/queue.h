@@ -30,6 +30,7 @@
 #include "ns3/unused.h"
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
+#include "ns3/ring-buffer.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -222,6 +223,34 @@ private:
 };
 
 
+/**
+ * \ingroup queue
+ * \brief The container of the items of a Queue.
+ *
+ * The items are kept in a RingBuffer, so that enqueuing and dequeuing
+ * at either end of a queue allocate no memory once the buffer has grown
+ * to the largest backlog, which is bounded by the maximum size of the
+ * queue in packets.  The container may be replaced for a given type of
+ * items by specializing this template, with any type having the
+ * cbegin, cend, insert and erase methods of std::list:
+ *
+ * \code
+ *   template <>
+ *   struct QueueContainer<MyItem>
+ *   {
+ *     typedef std::list<Ptr<MyItem> > Type;
+ *   };
+ * \endcode
+ *
+ * The specialization must be visible wherever Queue<MyItem> is.
+ */
+template <typename Item>
+struct QueueContainer
+{
+  typedef RingBuffer<Ptr<Item> > Type;  //!< The container type
+};
+
+
 /**
  * \ingroup queue
  * \brief Template class for packet Queues
@@ -237,6 +266,11 @@ private:
  * methods in doing so, to ensure that appropriate trace sources are called
  * and statistics are maintained.
  *
+ * The items are stored in a QueueContainer<Item>::Type, a RingBuffer by
+ * default.  As with std::list, removing an item invalidates the
+ * iterators to this item only, but enqueuing an item in a RingBuffer
+ * invalidates all the iterators.
+ *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
  * of the templates included in this file. Thus, do not include queue.h but add
@@ -296,8 +330,10 @@ public:
 
 protected:
 
+  /// The container of the items.
+  typedef typename QueueContainer<Item>::Type Container;
   /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  typedef typename Container::const_iterator ConstIterator;
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -381,7 +417,7 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  Container m_packets;                      //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
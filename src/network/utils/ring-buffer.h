@@ -0,0 +1,336 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A growable ring buffer of pointers with list-like iterators.
+ *
+ * The items are stored contiguously in a power of two array, which is
+ * doubled when full, so that inserting at either end and erasing the
+ * first item cost no allocation.  Inserting in the middle moves the
+ * following items.
+ *
+ * Erasing an item other than the first one leaves a hole, skipped by
+ * the iterators and reclaimed by a later insertion.  Hence, as with
+ * std::list, erasing an item invalidates the iterators to this item
+ * only, which lets a loop erase the item it just stepped over.
+ * Inserting an item invalidates all the iterators.
+ *
+ * \tparam T A pointer type, such as Ptr<Packet>.  Null pointers mark
+ *           the holes and cannot be stored.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /** An iterator over the items of a RingBuffer. */
+  class ConstIterator
+  {
+  public:
+    ConstIterator ()
+      : m_ring (0),
+        m_position (0)
+    {}
+    /** \returns The item. */
+    const T &operator* (void) const
+    {
+      return m_ring->At (m_position);
+    }
+    /** \returns The item. */
+    const T *operator-> (void) const
+    {
+      return &m_ring->At (m_position);
+    }
+    /** \returns This iterator, moved to the next item. */
+    ConstIterator &operator++ (void)
+    {
+      m_position = m_ring->Next (m_position + 1);
+      return *this;
+    }
+    /** \returns A copy of this iterator, before moving it to the next item. */
+    ConstIterator operator++ (int)
+    {
+      ConstIterator previous = *this;
+      ++*this;
+      return previous;
+    }
+    /**
+     * \param [in] other Another iterator.
+     * \returns true if both iterators refer to the same item.
+     */
+    bool operator== (const ConstIterator &other) const
+    {
+      return m_position == other.m_position;
+    }
+    /**
+     * \param [in] other Another iterator.
+     * \returns true if the iterators refer to different items.
+     */
+    bool operator!= (const ConstIterator &other) const
+    {
+      return m_position != other.m_position;
+    }
+
+  private:
+    friend class RingBuffer<T>;
+    /**
+     * \param [in] ring The ring buffer.
+     * \param [in] position The position of the item.
+     */
+    ConstIterator (const RingBuffer<T> *ring, uint32_t position)
+      : m_ring (ring),
+        m_position (position)
+    {}
+
+    const RingBuffer<T> *m_ring;  //!< The ring buffer.
+    uint32_t m_position;          //!< The position of the item.
+  };
+
+  /** The iterator type, as named by the standard containers. */
+  typedef ConstIterator const_iterator;
+
+  RingBuffer ();
+
+  /** \returns An iterator to the first item. */
+  const_iterator cbegin (void) const;
+  /** \returns An iterator past the last item. */
+  const_iterator cend (void) const;
+  /** \returns The number of items. */
+  uint32_t size (void) const;
+  /** \returns true if there is no item. */
+  bool empty (void) const;
+  /** \returns The number of items which fit without growing. */
+  uint32_t capacity (void) const;
+
+  /**
+   * Insert an item.
+   * \param [in] pos The item before which to insert.
+   * \param [in] item The item, not null.
+   * \returns An iterator to the inserted item.
+   */
+  const_iterator insert (const_iterator pos, const T &item);
+  /**
+   * Erase an item.
+   * \param [in] pos The item.
+   * \returns An iterator to the next item.
+   */
+  const_iterator erase (const_iterator pos);
+  /** Erase all the items. */
+  void clear (void);
+
+private:
+  /** The capacity of the first array. */
+  static const uint32_t MIN_CAPACITY = 8;
+
+  /**
+   * \param [in] position A position.
+   * \returns The item at \p position.
+   */
+  const T &At (uint32_t position) const
+  {
+    return m_slots[position & m_mask];
+  }
+  /**
+   * \param [in] position A position.
+   * \returns The position of the first item at or after \p position.
+   */
+  uint32_t Next (uint32_t position) const
+  {
+    while (position != m_tail && At (position) == 0)
+      {
+        ++position;
+      }
+    return position;
+  }
+  /**
+   * Move the items without holes to the start of an array of a new
+   * capacity.
+   * \param [in] capacity The new capacity, a power of two.
+   * \param [in] position A position.
+   * \returns The new position of the item at \p position.
+   */
+  uint32_t Rebuild (uint32_t capacity, uint32_t position);
+
+  std::vector<T> m_slots;  //!< The items and holes.
+  uint32_t m_mask;         //!< The capacity minus one.
+  uint32_t m_head;         //!< The position of the first item.
+  uint32_t m_tail;         //!< The position past the last item.
+  uint32_t m_holes;        //!< The number of holes between head and tail.
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+RingBuffer<T>::RingBuffer ()
+  : m_mask (0),
+    m_head (0),
+    m_tail (0),
+    m_holes (0)
+{
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::cbegin (void) const
+{
+  return const_iterator (this, m_head);
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::cend (void) const
+{
+  return const_iterator (this, m_tail);
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::size (void) const
+{
+  return m_tail - m_head - m_holes;
+}
+
+template <typename T>
+bool
+RingBuffer<T>::empty (void) const
+{
+  return size () == 0;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::capacity (void) const
+{
+  return m_slots.size ();
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::Rebuild (uint32_t capacity, uint32_t position)
+{
+  std::vector<T> slots (capacity);
+  uint32_t count = 0;
+  uint32_t newPosition = 0;
+  for (uint32_t i = m_head; i != m_tail; ++i)
+    {
+      if (i == position)
+        {
+          newPosition = count;
+        }
+      T &item = m_slots[i & m_mask];
+      if (item != 0)
+        {
+          slots[count++] = item;
+        }
+    }
+  if (position == m_tail)
+    {
+      newPosition = count;
+    }
+  m_slots.swap (slots);
+  m_mask = capacity - 1;
+  m_head = 0;
+  m_tail = count;
+  m_holes = 0;
+  return newPosition;
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::insert (const_iterator pos, const T &item)
+{
+  NS_ASSERT (item != 0);
+  uint32_t position = pos.m_position;
+  // The iterators are invalidated: drop the holes at the end.
+  if (position == m_tail)
+    {
+      while (m_tail != m_head && At (m_tail - 1) == 0)
+        {
+          --m_tail;
+          --m_holes;
+        }
+      position = m_tail;
+    }
+  uint32_t used = m_tail - m_head;
+  if (used == m_slots.size ())
+    {
+      // Reclaim the holes, or grow if they are too few.
+      uint32_t capacity = m_slots.size () > MIN_CAPACITY ? m_slots.size () : MIN_CAPACITY;
+      if (used - m_holes >= capacity / 2)
+        {
+          capacity *= 2;
+        }
+      position = Rebuild (capacity, position);
+    }
+
+  if (position == m_head)
+    {
+      --m_head;
+      m_slots[m_head & m_mask] = item;
+      return const_iterator (this, m_head);
+    }
+  for (uint32_t i = m_tail; i != position; --i)
+    {
+      m_slots[i & m_mask] = m_slots[(i - 1) & m_mask];
+    }
+  m_slots[position & m_mask] = item;
+  ++m_tail;
+  return const_iterator (this, position);
+}
+
+template <typename T>
+typename RingBuffer<T>::const_iterator
+RingBuffer<T>::erase (const_iterator pos)
+{
+  uint32_t position = pos.m_position;
+  NS_ASSERT (position != m_tail && At (position) != 0);
+  m_slots[position & m_mask] = T ();
+  ++m_holes;
+  // The tail is kept, since iterators may refer to it.
+  while (m_head != m_tail && At (m_head) == 0)
+    {
+      ++m_head;
+      --m_holes;
+    }
+  return const_iterator (this, Next (position));
+}
+
+template <typename T>
+void
+RingBuffer<T>::clear (void)
+{
+  while (!empty ())
+    {
+      erase (cbegin ());
+    }
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Benchmark of the bursts of the point-to-point devices.
+//
+// A dumbbell: nLeaves senders are connected to a left router, the left
+// router to a right router by a bottleneck link, and the right router to
+// nLeaves receivers.  Each sender sends a UDP flow to a receiver, at a
+// rate which overloads the bottleneck, so that its queue stays busy.
+//
+//   s0 --+                        +-- r0
+//   s1 --+-- left ========= right +-- r1
+//   ...  |                        |   ...
+//
+// The program prints the number of events executed, the wall clock time
+// and the number of events per second, for a given "MaxBurstSize" of all
+// the devices:
+//
+//   ./waf --run "point-to-point-burst-benchmark --maxBurstSize=1"
+//   ./waf --run "point-to-point-burst-benchmark --maxBurstSize=16"
+//
+
+#include <iostream>
+#include <sstream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointBurstBenchmark");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nLeaves = 4;
+  uint32_t maxBurstSize = 16;
+  uint32_t packetSize = 1472;
+  std::string bottleneckRate = "10Gbps";
+  std::string accessRate = "40Gbps";
+  double load = 1.2;
+  double stopTime = 0.05;
+
+  CommandLine cmd;
+  cmd.AddValue ("nLeaves", "Number of senders and of receivers", nLeaves);
+  cmd.AddValue ("maxBurstSize", "MaxBurstSize of the devices (1 disables bursts)", maxBurstSize);
+  cmd.AddValue ("packetSize", "Size of the UDP payloads", packetSize);
+  cmd.AddValue ("bottleneckRate", "Data rate of the bottleneck link", bottleneckRate);
+  cmd.AddValue ("accessRate", "Data rate of the access links", accessRate);
+  cmd.AddValue ("load", "Offered load, relative to the bottleneck rate", load);
+  cmd.AddValue ("stopTime", "Simulated time, in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::PointToPointNetDevice::MaxBurstSize", UintegerValue (maxBurstSize));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer senders;
+  senders.Create (nLeaves);
+  NodeContainer receivers;
+  receivers.Create (nLeaves);
+
+  InternetStackHelper stack;
+  stack.InstallAll ();
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (bottleneckRate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue (accessRate));
+  access.SetChannelAttribute ("Delay", StringValue ("10us"));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (bottleneck.Install (routers));
+  Ipv4InterfaceContainer receiverInterfaces;
+  for (uint32_t i = 0; i < nLeaves; ++i)
+    {
+      address.NewNetwork ();
+      address.Assign (access.Install (senders.Get (i), routers.Get (0)));
+      address.NewNetwork ();
+      receiverInterfaces.Add (address.Assign (access.Install (receivers.Get (i), routers.Get (1))).Get (0));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // The flows share the offered load evenly.
+  DataRate rate (bottleneckRate);
+  Time interval = Seconds ((packetSize + 28) * 8.0 * nLeaves / (rate.GetBitRate () * load));
+  uint16_t port = 9;
+  ApplicationContainer servers;
+  for (uint32_t i = 0; i < nLeaves; ++i)
+    {
+      UdpServerHelper server (port);
+      servers.Add (server.Install (receivers.Get (i)));
+      UdpClientHelper client (receiverInterfaces.GetAddress (i), port);
+      client.SetAttribute ("MaxPackets", UintegerValue (0xffffffff));
+      client.SetAttribute ("Interval", TimeValue (interval));
+      client.SetAttribute ("PacketSize", UintegerValue (packetSize));
+      ApplicationContainer app = client.Install (senders.Get (i));
+      app.Start (Seconds (0));
+      app.Stop (Seconds (stopTime));
+    }
+
+  Simulator::Stop (Seconds (stopTime + 0.01));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  uint64_t nEvents = Simulator::GetEventCount ();
+
+  uint64_t nReceived = 0;
+  for (uint32_t i = 0; i < servers.GetN (); ++i)
+    {
+      nReceived += DynamicCast<UdpServer> (servers.Get (i))->GetReceived ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << "MaxBurstSize " << maxBurstSize << ": "
+            << nReceived << " packets received, "
+            << nEvents << " events, "
+            << elapsed << " ms, "
+            << (elapsed > 0 ? nEvents * 1000 / elapsed : 0) << " events/s, "
+            << (elapsed > 0 ? nReceived * 1000 / elapsed : 0) << " packets/s"
+            << std::endl;
+  return 0;
+}
@@ -20,6 +20,7 @@
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -106,6 +107,44 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  std::vector<Time> const &txTimes,
+  Time interframeGap)
+{
+  NS_LOG_FUNCTION (this << burst << src << interframeGap);
+  NS_ASSERT (burst->GetNPackets () == txTimes.size () && !txTimes.empty ());
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+
+  // The arrival times of the last bits of the packets.
+  std::vector<Time> rxTimes;
+  rxTimes.reserve (txTimes.size ());
+  Time now = Simulator::Now ();
+  Time txStart = Seconds (0);
+  std::vector<Time>::const_iterator txTime = txTimes.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin ();
+       i != burst->End (); ++i, ++txTime)
+    {
+      NS_LOG_LOGIC ("UID is " << (*i)->GetUid () << ")");
+      Time txEnd = txStart + *txTime;
+      rxTimes.push_back (now + txEnd + m_delay);
+      // Call the tx anim callback on the net device
+      m_txrxPointToPoint (*i, src, m_link[wire].m_dst, *txTime, txEnd + m_delay);
+      txStart = txEnd + interframeGap;
+    }
+
+  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                  rxTimes.back () - now, &PointToPointNetDevice::ReceiveBurst,
+                                  m_link[wire].m_dst, burst->Copy (), rxTimes);
+  return true;
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -30,6 +31,7 @@ namespace ns3 {
 
 class PointToPointNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup point-to-point
@@ -80,6 +82,24 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a burst of back-to-back packets over this channel
+   *
+   * The packets are sent one after the other, separated by the
+   * interframe gap, and delivered to the destination device by a single
+   * event, when the last bit of the last packet arrives, along with the
+   * arrival times of the last bits of all the packets.
+   *
+   * \param burst Packets to transmit
+   * \param src Source PointToPointNetDevice
+   * \param txTimes Transmit time of each packet
+   * \param interframeGap Time between the end of a packet and the start
+   *        of the next one
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurst (Ptr<const PacketBurst> burst, Ptr<PointToPointNetDevice> src,
+                              std::vector<Time> const &txTimes, Time interframeGap);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
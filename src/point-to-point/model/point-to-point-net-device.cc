@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +68,13 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxBurstSize",
+                   "The maximum number of back-to-back packets of the queue "
+                   "sent, and delivered to the peer device, as a single burst. "
+                   "The value 1 disables bursts.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxBurstSize),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -151,6 +159,12 @@ PointToPointNetDevice::GetTypeId (void)
                      "dropped by the device during reception",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxDropTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PhyRxArrival",
+                     "Trace source indicating the time at which the last bit "
+                     "of a packet arrived at the device, which precedes its "
+                     "reception if it was part of a burst",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxArrivalTrace),
+                     "ns3::PointToPointNetDevice::ArrivalTracedCallback")
 
     //
     // Trace sources designed to simulate a packet sniffer facility (tcpdump).
@@ -177,7 +191,9 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_currentBurst (0),
+    m_maxBurstSize (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -214,6 +230,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_currentBurst = 0;
   m_queue = 0;
   NetDevice::DoDispose ();
 }
@@ -242,7 +259,13 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   // This function is called to start the process of transmitting a packet.
   // We need to tell the channel that we've started wiggling the wire and
   // schedule an event that will be executed when the transmission is complete.
+  // If more packets are waiting in the queue and bursts are enabled, they
+  // are all sent back to back as a burst.
   //
+  if (m_maxBurstSize > 1 && !m_queue->IsEmpty ())
+    {
+      return TransmitBurst (p);
+    }
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
   m_currentPkt = p;
@@ -262,6 +285,57 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitBurst (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  m_txMachineState = BUSY;
+  m_currentBurst = Create<PacketBurst> ();
+
+  //
+  // Pull the packets of the burst off the queue.  They are sent back to back,
+  // each followed by the interframe gap, as if they were sent one by one.
+  //
+  std::vector<Time> txTimes;
+  Time txCompleteTime = Seconds (0);
+  while (p != 0)
+    {
+      NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
+      m_phyTxBeginTrace (p);
+      Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+      txTimes.push_back (txTime);
+      txCompleteTime += txTime + m_tInterframeGap;
+      m_currentBurst->AddPacket (p);
+      if (m_currentBurst->GetNPackets () == m_maxBurstSize)
+        {
+          break;
+        }
+      p = m_queue->Dequeue ();
+      if (p != 0)
+        {
+          m_snifferTrace (p);
+          m_promiscSnifferTrace (p);
+        }
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec"
+                << " for " << txTimes.size () << " packets");
+  Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitBurst (m_currentBurst, this, txTimes, m_tInterframeGap);
+  if (result == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = m_currentBurst->Begin ();
+           i != m_currentBurst->End (); ++i)
+        {
+          m_phyTxDropTrace (*i);
+        }
+    }
+  return result;
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -276,10 +350,22 @@ PointToPointNetDevice::TransmitComplete (void)
   NS_ASSERT_MSG (m_txMachineState == BUSY, "Must be BUSY if transmitting");
   m_txMachineState = READY;
 
-  NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
+  if (m_currentBurst != 0)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = m_currentBurst->Begin ();
+           i != m_currentBurst->End (); ++i)
+        {
+          m_phyTxEndTrace (*i);
+        }
+      m_currentBurst = 0;
+    }
+  else
+    {
+      NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
-  m_currentPkt = 0;
+      m_phyTxEndTrace (m_currentPkt);
+      m_currentPkt = 0;
+    }
 
   Ptr<Packet> p = m_queue->Dequeue ();
   if (p == 0)
@@ -332,8 +418,30 @@ void
 PointToPointNetDevice::Receive (Ptr<Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet);
+  DoReceive (packet, Simulator::Now ());
+}
+
+void
+PointToPointNetDevice::ReceiveBurst (Ptr<PacketBurst> burst, std::vector<Time> const &rxTimes)
+{
+  NS_LOG_FUNCTION (this << burst);
+  NS_ASSERT (burst->GetNPackets () == rxTimes.size ());
+  std::vector<Time>::const_iterator rxTime = rxTimes.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin ();
+       i != burst->End (); ++i, ++rxTime)
+    {
+      DoReceive (*i, *rxTime);
+    }
+}
+
+void
+PointToPointNetDevice::DoReceive (Ptr<Packet> packet, Time rxTime)
+{
+  NS_LOG_FUNCTION (this << packet << rxTime);
   uint16_t protocol = 0;
 
+  m_phyRxArrivalTrace (packet, rxTime);
+
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) ) 
     {
       // 
@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -36,6 +37,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class PacketBurst;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -58,6 +60,16 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * When the "MaxBurstSize" attribute is greater than one, the packets
+ * waiting in the queue when a transmission starts are sent back to back
+ * as a single burst of at most that many packets: the transmission of
+ * the burst ends with a single event, and the burst is delivered to the
+ * peer device by a single event, at the arrival time of the last packet.
+ * The exact arrival time of each packet is carried along and reported by
+ * the "PhyRxArrival" trace source, but the packets of a burst are
+ * dequeued, traced and passed up the stack together, which delays them
+ * by at most the duration of the burst.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -149,6 +161,28 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * Receive a burst of packets from a connected PointToPointChannel.
+   *
+   * This is the method used by the channel to deliver the packets of a
+   * burst when the last bit of the last packet has arrived at the device.
+   *
+   * \param burst The received packets.
+   * \param rxTimes The times at which the last bit of each packet arrived.
+   */
+  void ReceiveBurst (Ptr<PacketBurst> burst, std::vector<Time> const &rxTimes);
+
+  /**
+   * TracedCallback signature for the arrival of a packet.
+   *
+   * \param [in] packet The packet.
+   * \param [in] rxTime The time at which the last bit of the packet
+   *             arrived, which precedes the current time if the packet
+   *             was part of a burst.
+   */
+  typedef void (* ArrivalTracedCallback)
+    (Ptr<const Packet> packet, Time rxTime);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -267,6 +301,28 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start sending a burst of back-to-back packets down the wire.
+   *
+   * The packet given and the packets following it in the queue, up to
+   * "MaxBurstSize" packets, are sent by a single call to the channel, and
+   * a single event is scheduled for the time at which the bits of the
+   * last packet have been completely transmitted.
+   *
+   * \see PointToPointChannel::TransmitBurst ()
+   * \param p the first packet of the burst
+   * \returns true if success, false on failure
+   */
+  bool TransmitBurst (Ptr<Packet> p);
+
+  /**
+   * Process a packet received from the channel.
+   *
+   * \param packet the received packet
+   * \param rxTime the time at which its last bit arrived
+   */
+  void DoReceive (Ptr<Packet> packet, Time rxTime);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -398,6 +454,14 @@ private:
    */
   TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
 
+  /**
+   * The trace source fired for each packet received from the medium, with
+   * the time its last bit arrived.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<Ptr<const Packet>, Time> m_phyRxArrivalTrace;
+
   /**
    * A trace source that emulates a non-promiscuous protocol sniffer connected 
    * to the device.  Unlike your average everyday sniffer, this trace source 
@@ -456,6 +520,8 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  Ptr<PacketBurst> m_currentBurst; //!< Current burst processed, if any
+  uint32_t m_maxBurstSize; //!< The maximum number of packets of a burst
 
   /**
    * \brief PPP to Ethernet protocol number mapping
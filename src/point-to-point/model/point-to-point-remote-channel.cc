@@ -23,6 +23,7 @@
 #include "point-to-point-remote-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/mpi-interface.h"
@@ -77,4 +78,27 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  std::vector<Time> const &txTimes,
+  Time interframeGap)
+{
+  NS_LOG_FUNCTION (this << burst << src << interframeGap);
+  NS_ASSERT (burst->GetNPackets () == txTimes.size ());
+
+  // Each packet is sent with the time its transmission ends, relative
+  // to now, so that it arrives on time.
+  Time txStart = Seconds (0);
+  std::vector<Time>::const_iterator txTime = txTimes.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin ();
+       i != burst->End (); ++i, ++txTime)
+    {
+      TransmitStart (*i, src, txStart + *txTime);
+      txStart += *txTime + interframeGap;
+    }
+  return true;
+}
+
 } // namespace ns3
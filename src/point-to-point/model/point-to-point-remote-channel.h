@@ -68,6 +68,21 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a burst of packets
+   *
+   * The packets are sent to the remote system one by one.
+   *
+   * \param burst Packets to transmit
+   * \param src Source PointToPointNetDevice
+   * \param txTimes Transmit time of each packet
+   * \param interframeGap Time between the end of a packet and the start
+   *        of the next one
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurst (Ptr<const PacketBurst> burst, Ptr<PointToPointNetDevice> src,
+                              std::vector<Time> const &txTimes, Time interframeGap);
 };
 
 } // namespace ns3
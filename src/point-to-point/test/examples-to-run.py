@@ -9,6 +9,7 @@
 # See test.py for more information.
 cpp_examples = [
     ("main-attribute-value", "True", "True"),
+    ("point-to-point-burst-benchmark --stopTime=0.001", "True", "False"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
@@ -24,6 +24,9 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -94,6 +97,160 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the bursts of PointToPointNetDevice
+ *
+ * It sends packets back to back, one by one and in bursts, and checks
+ * that the bursts take fewer events while preserving the arrival times
+ * of the packets.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /** The outcome of a run. */
+  struct Result
+  {
+    std::vector<Time> arrivals;   //!< The arrival times of the packets.
+    std::vector<Time> receptions; //!< The reception times of the packets.
+    std::vector<uint32_t> sizes;  //!< The sizes of the received packets.
+    uint64_t nEvents;             //!< The number of events executed.
+  };
+
+  /**
+   * \brief Send the packets to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device);
+  /**
+   * \brief Send the packets with a maximum burst size
+   *
+   * \param maxBurstSize The maximum number of packets of a burst.
+   * \returns The outcome of the run.
+   */
+  struct Result Run (uint32_t maxBurstSize);
+  /**
+   * \brief Record the arrival of a packet
+   *
+   * \param packet The packet.
+   * \param rxTime The arrival time of the packet.
+   */
+  void Arrival (Ptr<const Packet> packet, Time rxTime);
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param packet The packet.
+   */
+  void Reception (Ptr<const Packet> packet);
+
+  static const uint32_t N_PACKETS = 10; //!< The number of packets sent
+  struct Result m_result; //!< The outcome of the current run
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint bursts")
+{
+}
+
+void
+PointToPointBurstTest::SendPackets (Ptr<PointToPointNetDevice> device)
+{
+  for (uint32_t i = 0; i < N_PACKETS; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (100 + 10 * i);
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointBurstTest::Arrival (Ptr<const Packet> packet, Time rxTime)
+{
+  m_result.arrivals.push_back (rxTime);
+}
+
+void
+PointToPointBurstTest::Reception (Ptr<const Packet> packet)
+{
+  m_result.receptions.push_back (Simulator::Now ());
+  m_result.sizes.push_back (packet->GetSize ());
+}
+
+struct PointToPointBurstTest::Result
+PointToPointBurstTest::Run (uint32_t maxBurstSize)
+{
+  m_result = Result ();
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->SetInterframeGap (MicroSeconds (3));
+  devA->SetAttribute ("MaxBurstSize", UintegerValue (maxBurstSize));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->TraceConnectWithoutContext ("PhyRxArrival", MakeCallback (&PointToPointBurstTest::Arrival, this));
+  devB->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&PointToPointBurstTest::Reception, this));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendPackets, this, devA);
+
+  Simulator::Run ();
+  m_result.nEvents = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return m_result;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  struct Result single = Run (1);
+  struct Result burst = Run (4);
+
+  NS_TEST_ASSERT_MSG_EQ (single.arrivals.size (), N_PACKETS, "Wrong number of packets received");
+  NS_TEST_ASSERT_MSG_EQ (burst.arrivals.size (), N_PACKETS, "Wrong number of packets received in bursts");
+  NS_TEST_ASSERT_MSG_EQ (burst.receptions.size (), N_PACKETS, "Wrong number of packets traced");
+  // The packets are sent back to back, with their PPP header.
+  Time txEnd = Seconds (1);
+  for (uint32_t i = 0; i < N_PACKETS; ++i)
+    {
+      txEnd += DataRate ("8Mbps").CalculateBytesTxTime (102 + 10 * i);
+      NS_TEST_EXPECT_MSG_EQ (single.arrivals[i], txEnd + MilliSeconds (1), "Wrong arrival time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (single.receptions[i], single.arrivals[i], "Wrong reception time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (burst.arrivals[i], single.arrivals[i], "Wrong arrival time of packet " << i << " in a burst");
+      NS_TEST_EXPECT_MSG_EQ (burst.sizes[i], single.sizes[i], "Wrong packet " << i << " in a burst");
+      txEnd += MicroSeconds (3);
+    }
+  // The first packet is sent alone, the next eight in two bursts of four
+  // packets, and the last one alone again.
+  NS_TEST_EXPECT_MSG_EQ (burst.receptions[0], burst.arrivals[0], "Wrong reception time of packet 0");
+  NS_TEST_EXPECT_MSG_EQ (burst.receptions[1], burst.arrivals[4], "Wrong reception time of packet 1");
+  NS_TEST_EXPECT_MSG_EQ (burst.receptions[4], burst.arrivals[4], "Wrong reception time of packet 4");
+  NS_TEST_EXPECT_MSG_EQ (burst.receptions[5], burst.arrivals[8], "Wrong reception time of packet 5");
+  NS_TEST_EXPECT_MSG_EQ (burst.receptions[9], burst.arrivals[9], "Wrong reception time of packet 9");
+  // Each burst saves three transmission and three reception events.
+  NS_TEST_EXPECT_MSG_EQ (single.nEvents - burst.nEvents, 12U, "Wrong number of events saved");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +267,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
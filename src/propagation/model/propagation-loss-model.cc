@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -82,6 +83,31 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double range = DoGetMaxRange (txPowerDbm, rxPowerDbm);
+  if (m_next != 0)
+    {
+      // a model which does not bound the range may also amplify the
+      // signal, and void the bounds of the other models.
+      double next = m_next->GetMaxRange (txPowerDbm, rxPowerDbm);
+      if (range == std::numeric_limits<double>::infinity ()
+          || next == std::numeric_limits<double>::infinity ())
+        {
+          return std::numeric_limits<double>::infinity ();
+        }
+      range = std::min (range, next);
+    }
+  return range;
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -277,6 +303,22 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  if (m_minLoss < 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (maxLossDb < m_minLoss)
+    {
+      return 0;
+    }
+  // the distance at which the loss of the equation above is maxLossDb.
+  return m_lambda / (4 * M_PI * std::sqrt (m_systemLoss)) * std::pow (10.0, maxLossDb / 20);
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -540,6 +582,21 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  if (m_referenceLoss < 0 || m_exponent <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (maxLossDb < m_referenceLoss)
+    {
+      return 0;
+    }
+  return m_referenceDistance * std::pow (10.0, (maxLossDb - m_referenceLoss) / (10 * m_exponent));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -642,6 +699,36 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  if (m_referenceLoss < 0 || m_exponent0 <= 0 || m_exponent1 <= 0 || m_exponent2 <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (maxLossDb < 0)
+    {
+      return 0;
+    }
+  if (maxLossDb < m_referenceLoss)
+    {
+      return m_distance0;
+    }
+  // the loss at the beginning of the middle and far fields.
+  double loss1 = m_referenceLoss + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  double loss2 = loss1 + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  if (maxLossDb < loss1)
+    {
+      return m_distance0 * std::pow (10.0, (maxLossDb - m_referenceLoss) / (10 * m_exponent0));
+    }
+  else if (maxLossDb < loss2)
+    {
+      return m_distance1 * std::pow (10.0, (maxLossDb - loss1) / (10 * m_exponent1));
+    }
+  return m_distance2 * std::pow (10.0, (maxLossDb - loss2) / (10 * m_exponent2));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -930,6 +1017,20 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (rxPowerDbm <= -1000)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (txPowerDbm < rxPowerDbm)
+    {
+      return 0;
+    }
+  return m_range;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
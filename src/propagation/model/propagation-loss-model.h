@@ -93,6 +93,19 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * Returns an upper bound of the distance at which the reception power,
+   * taking into account all the PropagationLossModel(s) chained to the
+   * current one, can be at least \p rxPowerDbm.  Channels use it to skip
+   * the receivers which can not get the signal.
+   *
+   * \param txPowerDbm the transmission power (in dBm)
+   * \param rxPowerDbm the reception power (in dBm)
+   * \returns the maximum distance (in meters), or infinity if the chain
+   *          of models does not bound it
+   */
+  double GetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -140,6 +153,20 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns an upper bound of the distance at which this particular
+   * PropagationLossModel can give a reception power of at least
+   * \p rxPowerDbm.  Since the models of a chain attenuate the output of
+   * the previous ones, a model which may return more power than it is
+   * given must return infinity, which is what the default
+   * implementation does.
+   *
+   * \param txPowerDbm the transmission power (in dBm)
+   * \param rxPowerDbm the reception power (in dBm)
+   * \returns the maximum distance (in meters), or infinity
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +349,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +558,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +642,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -852,6 +882,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
@@ -25,6 +25,8 @@
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
 
+#include <limits>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("PropagationLossModelsTest");
@@ -436,6 +438,80 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class MaxRangeTestCase : public TestCase
+{
+public:
+  MaxRangeTestCase ();
+  virtual ~MaxRangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the reception power is above the threshold within the
+   * range and below beyond it.
+   * \param model the propagation loss model
+   * \param txPowerDbm the transmission power
+   * \param rxPowerDbm the threshold
+   */
+  void CheckRange (Ptr<PropagationLossModel> model, double txPowerDbm, double rxPowerDbm);
+};
+
+MaxRangeTestCase::MaxRangeTestCase ()
+  : TestCase ("Test PropagationLossModel::GetMaxRange")
+{
+}
+
+MaxRangeTestCase::~MaxRangeTestCase ()
+{
+}
+
+void
+MaxRangeTestCase::CheckRange (Ptr<PropagationLossModel> model, double txPowerDbm, double rxPowerDbm)
+{
+  double range = model->GetMaxRange (txPowerDbm, rxPowerDbm);
+  NS_TEST_ASSERT_MSG_GT (range, 0, "The range should not be empty");
+  NS_TEST_ASSERT_MSG_LT (range, std::numeric_limits<double>::infinity (), "The range should be bounded");
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (range * 0.999, 0, 0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (model->CalcRxPower (txPowerDbm, a, b), rxPowerDbm, "Within the range");
+  b->SetPosition (Vector (range * 1.001, 0, 0));
+  NS_TEST_EXPECT_MSG_LT (model->CalcRxPower (txPowerDbm, a, b), rxPowerDbm, "Beyond the range");
+}
+
+void
+MaxRangeTestCase::DoRun (void)
+{
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  CheckRange (friis, 16.0206, -96);
+
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  CheckRange (logDistance, 16.0206, -96);
+  CheckRange (logDistance, 0, -50);
+
+  // the threshold is reached in each of the three fields.
+  Ptr<ThreeLogDistancePropagationLossModel> threeLog = CreateObject<ThreeLogDistancePropagationLossModel> ();
+  CheckRange (threeLog, 16.0206, -60);
+  CheckRange (threeLog, 16.0206, -80);
+  CheckRange (threeLog, 16.0206, -96);
+
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  range->SetAttribute ("MaxRange", DoubleValue (50));
+  CheckRange (range, 16.0206, -96);
+
+  // a chain is bounded by its shortest range.
+  logDistance->SetNext (range);
+  NS_TEST_EXPECT_MSG_EQ (logDistance->GetMaxRange (16.0206, -96), 50, "Wrong range of the chain");
+
+  // a random model may amplify the signal.
+  Ptr<NakagamiPropagationLossModel> nakagami = CreateObject<NakagamiPropagationLossModel> ();
+  range->SetNext (nakagami);
+  NS_TEST_EXPECT_MSG_EQ (logDistance->GetMaxRange (16.0206, -96), std::numeric_limits<double>::infinity (),
+                         "A chain with a random model should not be bounded");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +526,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MaxRangeTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
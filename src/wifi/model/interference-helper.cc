@@ -25,6 +25,7 @@
 #include "interference-helper.h"
 #include "wifi-phy.h"
 #include "error-rate-model.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -107,7 +108,7 @@ InterferenceHelper::NiChange::AddPower (double power)
   m_power += power;
 }
 
-Ptr<Event>
+const Ptr<Event> &
 InterferenceHelper::NiChange::GetEvent (void) const
 {
   return m_event;
@@ -210,9 +211,12 @@ InterferenceHelper::AppendEvent (Ptr<Event> event)
       m_niChanges.erase (++(m_niChanges.begin ()),
                          GetNextPosition (event->GetStartTime ()));
     }
+  // the second insertion invalidates the iterators, but not the position
+  // of the first change, which comes before it.
   auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
+  std::size_t firstIndex = first - m_niChanges.begin ();
   auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
-  for (auto i = first; i != last; ++i)
+  for (auto i = m_niChanges.begin () + firstIndex; i != last; ++i)
     {
       i->second.AddPower (event->GetRxPowerW ());
     }
@@ -234,20 +238,24 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint1
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *first,
+                                                 NiChanges::const_iterator *last) const
 {
   double noiseInterference = m_firstPower;
-  auto it = m_niChanges.find (event->GetStartTime ());
+  auto it = GetFirstPosition (event->GetStartTime ());
   for (; it != m_niChanges.end () && it->second.GetEvent () != event; ++it)
     {
       noiseInterference = it->second.GetPower ();
     }
-  ni->emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != m_niChanges.end () && it->second.GetEvent () != event)
+  NS_ASSERT (it != m_niChanges.end ());
+  *first = it;
+  ++it;
+  while (it != m_niChanges.end () && it->second.GetEvent () != event)
     {
-      ni->insert (*it);
+      ++it;
     }
-  ni->emplace (event->GetEndTime (), NiChange (0, event));
+  NS_ASSERT (it != m_niChanges.end ());
+  *last = it + 1;
   return noiseInterference;
 }
 
@@ -274,12 +282,13 @@ InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiM
 }
 
 double
-InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                             NiChanges::const_iterator last) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = first;
   Time previous = j->first;
   WifiMode payloadMode = event->GetPayloadMode ();
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -289,7 +298,7 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  while (++j != last)
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -322,12 +331,13 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
 }
 
 double
-InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                            NiChanges::const_iterator last) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = first;
   Time previous = j->first;
   WifiPreamble preamble = txVector.GetPreambleType ();
   WifiMode mcsHeaderMode;
@@ -353,7 +363,7 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  while (++j != last)
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -739,8 +749,9 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator first;
+  NiChanges::const_iterator last;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &first, &last);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetTxVector ().GetChannelWidth ());
@@ -748,7 +759,7 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpPayloadPer (event, &ni);
+  double per = CalculatePlcpPayloadPer (event, first, last);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -759,8 +770,9 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator first;
+  NiChanges::const_iterator last;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &first, &last);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetTxVector ().GetChannelWidth ());
@@ -768,7 +780,7 @@ InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the plcp header and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpHeaderPer (event, &ni);
+  double per = CalculatePlcpHeaderPer (event, first, last);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -789,7 +801,15 @@ InterferenceHelper::EraseEvents (void)
 InterferenceHelper::NiChanges::const_iterator
 InterferenceHelper::GetNextPosition (Time moment) const
 {
-  return m_niChanges.upper_bound (moment);
+  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), moment,
+                           [] (Time t, const std::pair<Time, NiChange> &change) { return t < change.first; });
+}
+
+InterferenceHelper::NiChanges::const_iterator
+InterferenceHelper::GetFirstPosition (Time moment) const
+{
+  return std::lower_bound (m_niChanges.begin (), m_niChanges.end (), moment,
+                           [] (const std::pair<Time, NiChange> &change, Time t) { return change.first < t; });
 }
 
 InterferenceHelper::NiChanges::const_iterator
@@ -821,7 +841,11 @@ InterferenceHelper::NotifyRxEnd ()
   NS_LOG_FUNCTION (this);
   m_rxing = false;
   //Update m_firstPower for frame capture
-  auto it = m_niChanges.find (Simulator::Now ());
+  auto it = GetFirstPosition (Simulator::Now ());
+  if (it != m_niChanges.end () && it->first != Simulator::Now ())
+    {
+      it = m_niChanges.end ();
+    }
   it--;
   m_firstPower = it->second.GetPower ();
 }
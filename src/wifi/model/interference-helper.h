@@ -23,7 +23,7 @@
 
 #include "ns3/nstime.h"
 #include "wifi-tx-vector.h"
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -97,6 +97,12 @@ private:
 /**
  * \ingroup wifi
  * \brief handles interference calculations
+ *
+ * The changes of the noise and interference power on the medium are
+ * kept in a vector sorted by time, each entry holding the total power
+ * from its time on, so that the chunks of constant SINR of a packet
+ * are found by a linear scan of contiguous memory.  The changes older
+ * than the last packet received are dropped as new signals arrive.
  */
 class InterferenceHelper
 {
@@ -235,7 +241,7 @@ public:
      *
      * \return the event
      */
-    Ptr<Event> GetEvent (void) const;
+    const Ptr<Event> & GetEvent (void) const;
 
 
 private:
@@ -244,9 +250,10 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChanges
+   * typedef for a vector of NiChanges sorted by time, the changes at
+   * the same time being kept in insertion order
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<std::pair<Time, NiChange> > NiChanges;
 
   /**
    * Append the given Event.
@@ -258,11 +265,13 @@ private:
    * Calculate noise and interference power in W.
    *
    * \param event
-   * \param ni
+   * \param first the NiChange of the start of the event
+   * \param last the NiChange following the NiChange of the end of the event
    *
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *first,
+                                      NiChanges::const_iterator *last) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -291,21 +300,25 @@ private:
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param first the NiChange of the start of the event
+   * \param last the NiChange following the NiChange of the end of the event
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                  NiChanges::const_iterator last) const;
   /**
    * Calculate the error rate of the plcp header. The plcp header can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param first the NiChange of the start of the event
+   * \param last the NiChange following the NiChange of the end of the event
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges::const_iterator first,
+                                 NiChanges::const_iterator last) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
@@ -323,12 +336,12 @@ private:
    */
   NiChanges::const_iterator GetNextPosition (Time moment) const;
   /**
-   * Returns an iterator to the first nichange that is later than moment
+   * Returns an iterator to the first nichange that is not earlier than moment
    *
    * \param moment time to check from
    * \returns an iterator to the list of NiChanges
    */
-  //NiChanges::iterator GetNextPosition (Time moment);
+  NiChanges::const_iterator GetFirstPosition (Time moment) const;
   /**
    * Returns an iterator to the last nichange that is before than moment
    *
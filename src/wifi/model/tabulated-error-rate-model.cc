@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "tabulated-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "wifi-tx-vector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TabulatedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TabulatedErrorRateModel);
+
+TypeId
+TabulatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TabulatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TabulatedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The error rate model whose chunk success rates are tabulated "
+                   "(a NistErrorRateModel if not set).",
+                   PointerValue (),
+                   MakePointerAccessor (&TabulatedErrorRateModel::SetErrorRateModel,
+                                        &TabulatedErrorRateModel::GetErrorRateModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The smallest SNR (dB) of the tables; the smaller SNR values are "
+                   "rounded up to it.",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetMinSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The largest SNR (dB) of the tables; the larger SNR values are "
+                   "rounded down to it.",
+                   DoubleValue (50.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetMaxSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStep",
+                   "The step (dB) between two SNR values of the tables.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetSnrStep),
+                   MakeDoubleChecker<double> (0.001))
+  ;
+  return tid;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel ()
+  : m_minSnr (-10.0),
+    m_maxSnr (50.0),
+    m_step (0.1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TabulatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_tables.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TabulatedErrorRateModel::SetErrorRateModel (const Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  ClearTables ();
+}
+
+Ptr<ErrorRateModel>
+TabulatedErrorRateModel::GetErrorRateModel (void) const
+{
+  if (m_model == 0)
+    {
+      m_model = CreateObject<NistErrorRateModel> ();
+    }
+  return m_model;
+}
+
+void
+TabulatedErrorRateModel::SetMinSnr (double minSnr)
+{
+  NS_LOG_FUNCTION (this << minSnr);
+  m_minSnr = minSnr;
+  ClearTables ();
+}
+
+void
+TabulatedErrorRateModel::SetMaxSnr (double maxSnr)
+{
+  NS_LOG_FUNCTION (this << maxSnr);
+  m_maxSnr = maxSnr;
+  ClearTables ();
+}
+
+void
+TabulatedErrorRateModel::SetSnrStep (double step)
+{
+  NS_LOG_FUNCTION (this << step);
+  m_step = step;
+  ClearTables ();
+}
+
+void
+TabulatedErrorRateModel::ClearTables (void)
+{
+  m_tables.clear ();
+}
+
+const std::vector<double> &
+TabulatedErrorRateModel::GetTable (WifiMode mode, WifiTxVector txVector, uint8_t bucket) const
+{
+  uint64_t key = mode.GetUid ()
+    | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 8)
+    | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 24)
+    | (static_cast<uint64_t> (txVector.GetNss ()) << 40)
+    | (static_cast<uint64_t> (bucket) << 48);
+  std::map<uint64_t, std::vector<double> >::const_iterator it = m_tables.find (key);
+  if (it != m_tables.end ())
+    {
+      return it->second;
+    }
+
+  NS_ABORT_MSG_IF (m_maxSnr < m_minSnr, "The largest SNR of the tables is smaller than the smallest one");
+  Ptr<ErrorRateModel> model = GetErrorRateModel ();
+  uint32_t size = static_cast<uint32_t> (std::floor ((m_maxSnr - m_minSnr) / m_step + 0.5)) + 1;
+  // the size of the chunks in the middle of the bucket, in bits.
+  uint64_t nbits = static_cast<uint64_t> (1) << (4 * bucket + 2);
+  NS_LOG_DEBUG ("table of " << size << " SNR values for " << mode << ", " << txVector.GetChannelWidth ()
+                << " MHz, " << txVector.GetGuardInterval () << " ns GI, " << +txVector.GetNss ()
+                << " streams and " << nbits << " bits");
+  std::vector<double> &table = m_tables[key];
+  table.reserve (size);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      double snr = std::pow (10.0, (m_minSnr + i * m_step) / 10.0);
+      double csr = std::min (model->GetChunkSuccessRate (mode, txVector, snr, nbits), 1.0);
+      // the log of the error rate per bit, which is -inf for a success
+      // rate of 1 and +inf for a success rate of 0.
+      table.push_back (std::log (-std::log (csr) / nbits));
+    }
+  return table;
+}
+
+double
+TabulatedErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  if (nbits == 0)
+    {
+      return GetErrorRateModel ()->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  uint8_t bucket = 0;
+  for (uint64_t n = nbits >> 4; n != 0 && bucket < 15; n >>= 4)
+    {
+      bucket++;
+    }
+  const std::vector<double> &table = GetTable (mode, txVector, bucket);
+  double x = (10.0 * std::log10 (snr) - m_minSnr) / m_step;
+  double logRate;
+  if (!(x > 0))
+    {
+      logRate = table.front ();
+    }
+  else if (x >= table.size () - 1)
+    {
+      logRate = table.back ();
+    }
+  else
+    {
+      std::size_t i = static_cast<std::size_t> (x);
+      double fraction = x - i;
+      if (std::isinf (table[i]) || std::isinf (table[i + 1]))
+        {
+          logRate = fraction < 0.5 ? table[i] : table[i + 1];
+        }
+      else
+        {
+          logRate = table[i] + fraction * (table[i + 1] - table[i]);
+        }
+    }
+  return std::exp (-std::exp (logRate) * nbits);
+}
+
+} //namespace ns3
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABULATED_ERROR_RATE_MODEL_H
+#define TABULATED_ERROR_RATE_MODEL_H
+
+#include "error-rate-model.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * \brief An error rate model which interpolates the chunk success rates
+ * of another error rate model from tables.
+ *
+ * The analytic error rate models evaluate erfc, series and binomial
+ * sums for each chunk of each received frame.  This model computes the
+ * chunk success rates of its ErrorRateModel once, over a grid of SNR
+ * values in dB, and interpolates them afterwards.
+ *
+ * A table is built the first time a WifiMode is used with a given
+ * channel width, guard interval and number of spatial streams, for each
+ * bucket of chunk sizes: the chunks of 1 to 15 bits, of 16 to 255 bits,
+ * and so on.  It stores, for each SNR of the grid, the error rate per
+ * bit \f$h = -\ln (csr) / n\f$ of a chunk of \f$n\f$ bits in the middle
+ * of the bucket, so that the success rate of a chunk of \f$m\f$ bits is
+ * \f$e^{-hm}\f$; this is exact for the models in which the bits fail
+ * independently, as the Nist and Yans models.  The error rates are
+ * interpolated geometrically between two points of the grid, and the
+ * SNR values outside of the grid are clamped to it.
+ *
+ * The wifi-error-rate-models test suite checks the deviation of this
+ * model from the Nist and Yans models.
+ */
+class TabulatedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TabulatedErrorRateModel ();
+  virtual ~TabulatedErrorRateModel ();
+
+  /**
+   * Set the error rate model whose chunk success rates are tabulated.
+   *
+   * \param model the error rate model
+   */
+  void SetErrorRateModel (const Ptr<ErrorRateModel> model);
+  /**
+   * Return the error rate model whose chunk success rates are tabulated,
+   * which is a NistErrorRateModel unless another one was set.
+   *
+   * \return the error rate model
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * Return the table of a chunk, building it if needed.
+   *
+   * \param mode the Wi-Fi mode of the chunk
+   * \param txVector the TXVECTOR of the transmission
+   * \param bucket the bucket of the size of the chunk
+   *
+   * \return the error rates per bit over the grid of SNR values
+   */
+  const std::vector<double> & GetTable (WifiMode mode, WifiTxVector txVector, uint8_t bucket) const;
+  /**
+   * Clear the tables, after a change of the grid or of the model.
+   */
+  void ClearTables (void);
+  /**
+   * \param minSnr the smallest SNR of the grid (dB)
+   */
+  void SetMinSnr (double minSnr);
+  /**
+   * \param maxSnr the largest SNR of the grid (dB)
+   */
+  void SetMaxSnr (double maxSnr);
+  /**
+   * \param step the step of the grid (dB)
+   */
+  void SetSnrStep (double step);
+
+  mutable Ptr<ErrorRateModel> m_model; //!< the tabulated model
+  double m_minSnr;                     //!< the smallest SNR of the grid (dB)
+  double m_maxSnr;                     //!< the largest SNR of the grid (dB)
+  double m_step;                       //!< the step of the grid (dB)
+  /**
+   * The tables, indexed by the mode, the channel width, the guard
+   * interval, the number of spatial streams and the bucket.
+   */
+  mutable std::map<uint64_t, std::vector<double> > m_tables;
+};
+
+} //namespace ns3
+
+#endif /* TABULATED_ERROR_RATE_MODEL_H */
@@ -671,10 +671,10 @@ WifiPhy::GetMobility (void) const
     {
       return m_mobility;
     }
-  else
-    {
-      return m_device->GetNode ()->GetObject<MobilityModel> ();
-    }
+  // the mobility model aggregated to a node is never removed, so
+  // the lookup is only done until it is found.
+  m_mobility = m_device->GetNode ()->GetObject<MobilityModel> ();
+  return m_mobility;
 }
 
 void
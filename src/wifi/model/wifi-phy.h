@@ -22,6 +22,7 @@
 #ifndef WIFI_PHY_H
 #define WIFI_PHY_H
 
+#include <map>
 #include "ns3/event-id.h"
 #include "wifi-mpdu-type.h"
 #include "wifi-phy-standard.h"
@@ -1308,7 +1309,7 @@ public:
    * This method will return either the mobility model that has been
    * explicitly set by a call to YansWifiPhy::SetMobility(), or else
    * will return the mobility model (if any) that has been aggregated
-   * to the node.
+   * to the node, which is then cached by the PHY.
    *
    * \return the mobility model this PHY is associated with
    */
@@ -1785,7 +1786,7 @@ private:
   double m_totalAmpduNumSymbols; //!< Number of symbols previously transmitted for the MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
 
   Ptr<NetDevice>     m_device;   //!< Pointer to the device
-  Ptr<MobilityModel> m_mobility; //!< Pointer to the mobility model
+  mutable Ptr<MobilityModel> m_mobility; //!< Pointer to the mobility model
 
   Ptr<Event> m_currentEvent; //!< Hold the current event
   Ptr<FrameCaptureModel> m_frameCaptureModel; //!< Frame capture model
@@ -27,9 +27,14 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/mobility-model.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -52,11 +57,28 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverCulling",
+                   "Whether the frames are only delivered to the PHYs which are "
+                   "within the range of the propagation loss model.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_culling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CullingMargin",
+                   "How far below the energy detection and CCA thresholds of the PHYs "
+                   "the received power must be for a frame not to be delivered (dB).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cullingMargin),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_culling (false),
+    m_cullingMargin (0.0),
+    m_gridValid (false),
+    m_cellSize (0.0),
+    m_cullingThresholdDbm (0.0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -67,11 +89,27 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Ptr<MobilityModel> >::const_iterator i = m_tracked.begin (); i != m_tracked.end (); ++i)
+    {
+      (*i)->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+    }
+  m_tracked.clear ();
+  m_grid.clear ();
+  m_moving.clear ();
+  m_gridValid = false;
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
   NS_LOG_FUNCTION (this << loss);
   m_loss = loss;
+  m_gridValid = false;
 }
 
 void
@@ -87,38 +125,169 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  if (m_culling)
     {
-      if (sender != (*i))
+      if (!m_gridValid)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          BuildGrid ();
+        }
+      double range = m_loss->GetMaxRange (txPowerDbm, m_cullingThresholdDbm);
+      if (m_cellSize > 0 && range != std::numeric_limits<double>::infinity ())
+        {
+          // the candidates are visited in the order of m_phyList, so that
+          // the events of the receivers are scheduled in the same order as
+          // without culling.
+          GetCandidates (senderMobility->GetPosition (), range, m_candidates);
+          for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); ++i)
             {
-              continue;
+              Ptr<YansWifiPhy> receiver = m_phyList[*i];
+              if (sender != receiver
+                  && senderMobility->GetDistanceFrom (receiver->GetMobility ()) <= range)
+                {
+                  SendTo (sender, senderMobility, receiver, packet, txPowerDbm, duration);
+                }
             }
+          return;
+        }
+    }
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      if (sender != (*i))
+        {
+          SendTo (sender, senderMobility, *i, packet, txPowerDbm, duration);
+        }
+    }
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                         Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+{
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm, duration);
+}
+
+std::pair<int64_t, int64_t>
+YansWifiChannel::GetCell (const Vector &position) const
+{
+  return std::make_pair (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+                         static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+void
+YansWifiChannel::BuildGrid (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_grid.clear ();
+  m_moving.clear ();
+  m_cellSize = 0;
+  m_gridValid = true;
+  if (m_phyList.empty ())
+    {
+      return;
+    }
+
+  // a frame is culled when it can neither be detected nor make the
+  // medium busy at any PHY.
+  double threshold = std::numeric_limits<double>::infinity ();
+  double maxTxPowerDbm = -std::numeric_limits<double>::infinity ();
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); ++i)
+    {
+      double detection = std::min ((*i)->GetEdThreshold (), (*i)->GetCcaMode1Threshold ());
+      threshold = std::min (threshold, detection - (*i)->GetRxGain ());
+      maxTxPowerDbm = std::max (maxTxPowerDbm, std::max ((*i)->GetTxPowerStart (), (*i)->GetTxPowerEnd ()) + (*i)->GetTxGain ());
+    }
+  m_cullingThresholdDbm = threshold - m_cullingMargin;
+  double range = m_loss->GetMaxRange (maxTxPowerDbm, m_cullingThresholdDbm);
+  NS_LOG_DEBUG ("culling threshold=" << m_cullingThresholdDbm << "dBm, range=" << range << "m");
+  if (range == std::numeric_limits<double>::infinity ())
+    {
+      return;
+    }
+  m_cellSize = std::max (range, 1.0);
+
+  for (uint32_t i = 0; i < m_phyList.size (); ++i)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ();
+      NS_ASSERT (mobility != 0);
+      if (i >= m_tracked.size ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&YansWifiChannel::NotifyCourseChange,
+                                                                              const_cast<YansWifiChannel *> (this)));
+          m_tracked.push_back (mobility);
+        }
+      Vector velocity = mobility->GetVelocity ();
+      if (velocity.x != 0 || velocity.y != 0 || velocity.z != 0)
+        {
+          m_moving.push_back (i);
+        }
+      else
+        {
+          m_grid[GetCell (mobility->GetPosition ())].push_back (i);
+        }
+    }
+}
+
+void
+YansWifiChannel::GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates) const
+{
+  candidates.clear ();
+  std::pair<int64_t, int64_t> low = GetCell (Vector (position.x - range, position.y - range, 0));
+  std::pair<int64_t, int64_t> high = GetCell (Vector (position.x + range, position.y + range, 0));
+  if (static_cast<double> (high.first - low.first + 1) * (high.second - low.second + 1) > m_grid.size ())
+    {
+      // fewer cells are occupied than covered by the range.
+      for (Grid::const_iterator i = m_grid.begin (); i != m_grid.end (); ++i)
+        {
+          candidates.insert (candidates.end (), i->second.begin (), i->second.end ());
+        }
+    }
+  else
+    {
+      for (int64_t x = low.first; x <= high.first; ++x)
+        {
+          for (int64_t y = low.second; y <= high.second; ++y)
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              Grid::const_iterator cell = m_grid.find (std::make_pair (x, y));
+              if (cell != m_grid.end ())
+                {
+                  candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
+                }
             }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
         }
     }
+  candidates.insert (candidates.end (), m_moving.begin (), m_moving.end ());
+  std::sort (candidates.begin (), candidates.end ());
+}
+
+void
+YansWifiChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  m_gridValid = false;
 }
 
 void
@@ -145,6 +314,7 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  m_gridValid = false;
 }
 
 int64_t
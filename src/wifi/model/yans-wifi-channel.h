@@ -21,13 +21,17 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <map>
+#include <vector>
 #include "ns3/channel.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class MobilityModel;
 class YansWifiPhy;
 class Packet;
 class Time;
@@ -40,6 +44,21 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the ReceiverCulling attribute is set, the channel does not deliver
+ * a frame to the PHYs which are too far from the sender to detect it or
+ * to sense the medium busy because of it, that is, further than the
+ * range given by PropagationLossModel::GetMaxRange for the lowest
+ * EnergyDetectionThreshold and CcaMode1Threshold of the PHYs, minus the
+ * CullingMargin.  The PHYs are found with a grid of cells as large as
+ * this range, rebuilt when a PHY is added or a mobility model notifies
+ * a course change; the PHYs which were moving when it was built are
+ * checked at every transmission.  The frames which are not delivered do
+ * not add to the interference of the PHYs, nor do they draw from the
+ * random variables of the propagation delay model.  Culling needs
+ * propagation loss models which bound their range (such as Friis,
+ * LogDistance, ThreeLogDistance and Range, but no random model); with
+ * other models, all the PHYs get all the frames.
  */
 class YansWifiChannel : public Channel
 {
@@ -99,10 +118,52 @@ public:
 
 
 private:
+  virtual void DoDispose (void);
+
   /**
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  /**
+   * The indices in m_phyList of the PHYs of each cell of the grid.
+   */
+  typedef std::map<std::pair<int64_t, int64_t>, std::vector<uint32_t> > Grid;
+
+  /**
+   * Deliver a frame to one PHY.
+   *
+   * \param sender the phy object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the phy object to which the packet is delivered
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+               Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+  /**
+   * Build the grid of the PHYs and compute the culling threshold.
+   */
+  void BuildGrid (void) const;
+  /**
+   * Find the PHYs which may be within a range of a position.
+   *
+   * \param position the position
+   * \param range the range, in meters
+   * \param [out] candidates the indices in m_phyList of the PHYs, sorted
+   */
+  void GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates) const;
+  /**
+   * \param position a position
+   * \returns the cell of the grid which holds the position
+   */
+  std::pair<int64_t, int64_t> GetCell (const Vector &position) const;
+  /**
+   * Invalidate the grid when a PHY moves.
+   *
+   * \param mobility the mobility model which changed its course
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
 
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
@@ -119,6 +180,16 @@ private:
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_culling;                      //!< Whether the unreachable PHYs are skipped
+  double m_cullingMargin;              //!< Margin below the PHY thresholds (dB)
+  mutable bool m_gridValid;            //!< Whether the grid is up to date
+  mutable double m_cellSize;           //!< Size of the cells (m), or 0 to disable culling
+  mutable double m_cullingThresholdDbm; //!< Power below which frames are not delivered (dBm)
+  mutable Grid m_grid;                 //!< PHYs which were not moving when the grid was built
+  mutable std::vector<uint32_t> m_moving; //!< PHYs which were moving when the grid was built
+  mutable std::vector<Ptr<MobilityModel> > m_tracked; //!< Mobility models connected to NotifyCourseChange
+  mutable std::vector<uint32_t> m_candidates; //!< Candidate receivers of the current transmission
 };
 
 } //namespace ns3
@@ -42,6 +42,8 @@
 #include "ns3/wifi-spectrum-signal-parameters.h"
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
+#include "ns3/interference-helper.h"
+#include "ns3/nist-error-rate-model.h"
 #include "ns3/mgt-headers.h"
 
 using namespace ns3;
@@ -1690,6 +1692,293 @@ StaWifiMacScanningTestCase::DoRun (void)
   }
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel receiver culling test
+ *
+ * Two clusters of four nodes, 1 km apart, broadcast frames at the same
+ * times.  The frames of a cluster reach the other one far below the
+ * energy detection and CCA thresholds, so that the receptions must be
+ * the same whether the channel culls the receivers or not, while
+ * culling saves the reception events of the other cluster.
+ */
+class YansWifiChannelCullingTest : public TestCase
+{
+public:
+  YansWifiChannelCullingTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /// A reception: the index of the node, the time and the size of the packet
+  typedef std::vector<std::pair<uint32_t, std::pair<int64_t, uint32_t> > > Receptions;
+
+  /**
+   * Run the scenario.
+   * \param culling whether the channel culls the receivers
+   * \param [out] receptions the receptions
+   * \returns the number of events executed
+   */
+  uint64_t RunOne (bool culling, Receptions &receptions);
+  /**
+   * Record a reception.
+   * \param receptions the receptions
+   * \param index the index of the receiving node
+   * \param p the packet
+   */
+  static void PhyRxEnd (Receptions *receptions, uint32_t index, Ptr<const Packet> p);
+  /**
+   * Broadcast a packet.
+   * \param dev the device
+   */
+  static void SendOnePacket (Ptr<NetDevice> dev);
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : TestCase ("Check that receiver culling in YansWifiChannel does not change the receptions")
+{
+}
+
+void
+YansWifiChannelCullingTest::PhyRxEnd (Receptions *receptions, uint32_t index, Ptr<const Packet> p)
+{
+  receptions->push_back (std::make_pair (index, std::make_pair (Simulator::Now ().GetNanoSeconds (), p->GetSize ())));
+}
+
+void
+YansWifiChannelCullingTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+uint64_t
+YansWifiChannelCullingTest::RunOne (bool culling, Receptions &receptions)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+
+  YansWifiChannelHelper channelHelper;
+  channelHelper.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  channelHelper.AddPropagationLoss ("ns3::LogDistancePropagationLossModel");
+  Ptr<YansWifiChannel> channel = channelHelper.Create ();
+  channel->SetAttribute ("ReceiverCulling", BooleanValue (culling));
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, 100);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t cluster = 0; cluster < 2; ++cluster)
+    {
+      positionAlloc->Add (Vector (cluster * 1000.0, 0.0, 0.0));
+      positionAlloc->Add (Vector (cluster * 1000.0 + 10.0, 0.0, 0.0));
+      positionAlloc->Add (Vector (cluster * 1000.0, 10.0, 0.0));
+      positionAlloc->Add (Vector (cluster * 1000.0 + 10.0, 10.0, 0.0));
+    }
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  for (uint32_t i = 0; i < devices.GetN (); ++i)
+    {
+      Ptr<WifiNetDevice> dev = DynamicCast<WifiNetDevice> (devices.Get (i));
+      dev->GetPhy ()->TraceConnectWithoutContext ("PhyRxEnd", MakeBoundCallback (&YansWifiChannelCullingTest::PhyRxEnd, &receptions, i));
+      // the nodes of the two clusters send at the same times.
+      for (uint32_t j = 0; j < 5; ++j)
+        {
+          Simulator::Schedule (Seconds (1.0) + MilliSeconds (10 * j + 2 * (i % 4)), &YansWifiChannelCullingTest::SendOnePacket, dev);
+        }
+    }
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  Receptions all;
+  uint64_t allEvents = RunOne (false, all);
+  Receptions culled;
+  uint64_t culledEvents = RunOne (true, culled);
+
+  // each frame is received by the three other nodes of its cluster.
+  NS_TEST_ASSERT_MSG_EQ (all.size (), 8 * 5 * 3U, "Wrong number of receptions without culling");
+  NS_TEST_ASSERT_MSG_EQ (culled.size (), all.size (), "Culling changed the number of receptions");
+  for (uint32_t i = 0; i < all.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (culled[i].first, all[i].first, "Culling changed the receiver of reception " << i);
+      NS_TEST_EXPECT_MSG_EQ (culled[i].second.first, all[i].second.first, "Culling changed the time of reception " << i);
+      NS_TEST_EXPECT_MSG_EQ (culled[i].second.second, all[i].second.second, "Culling changed the size of reception " << i);
+    }
+  NS_TEST_EXPECT_MSG_LT (culledEvents, allEvents, "Culling should save events");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief InterferenceHelper chunks test
+ *
+ * Three overlapping signals are added to an InterferenceHelper, and the
+ * SNR, the PER of the payload of the first one and the energy durations
+ * are checked against the chunks of constant interference which they
+ * define.  A fourth signal, added after the reception of the first one,
+ * checks that the older power changes are dropped correctly.
+ */
+class InterferenceHelperChunksTest : public TestCase
+{
+public:
+  InterferenceHelperChunksTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Add a signal to the interference helper
+   * \param index the index of the signal
+   * \param powerW the power of the signal
+   * \param duration the duration of the signal
+   */
+  void AddSignal (uint32_t index, double powerW, Time duration);
+  /**
+   * Check the energy duration
+   * \param energyW the energy threshold
+   * \param expected the expected duration
+   */
+  void CheckEnergyDuration (double energyW, Time expected);
+  /**
+   * Check the SNR and PER of the payload of the first signal, and end its reception
+   */
+  void CheckFirstSignal (void);
+  /**
+   * Check the SNR of the last signal
+   */
+  void CheckLastSignal (void);
+  /**
+   * \param signalW the power of the signal
+   * \param interferenceW the power of the interference
+   * \returns the SNR
+   */
+  double GetSnr (double signalW, double interferenceW) const;
+  /**
+   * \param signalW the power of the signal
+   * \param interferenceW the power of the interference
+   * \param duration the duration of the chunk
+   * \returns the success rate of the chunk
+   */
+  double GetChunkSuccessRate (double signalW, double interferenceW, Time duration) const;
+
+  InterferenceHelper m_interference; ///< the interference helper
+  Ptr<ErrorRateModel> m_errorRateModel; ///< the error rate model
+  WifiTxVector m_txVector; ///< the TXVECTOR of the signals
+  Ptr<Event> m_events[4]; ///< the events of the signals
+};
+
+InterferenceHelperChunksTest::InterferenceHelperChunksTest ()
+  : TestCase ("Check the chunks of constant interference of InterferenceHelper")
+{
+}
+
+void
+InterferenceHelperChunksTest::AddSignal (uint32_t index, double powerW, Time duration)
+{
+  m_events[index] = m_interference.Add (Create<Packet> (1000), m_txVector, duration, powerW);
+}
+
+void
+InterferenceHelperChunksTest::CheckEnergyDuration (double energyW, Time expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_interference.GetEnergyDuration (energyW), expected,
+                         "Wrong energy duration at " << Simulator::Now ().GetMicroSeconds () << "us");
+}
+
+double
+InterferenceHelperChunksTest::GetSnr (double signalW, double interferenceW) const
+{
+  // the thermal noise at 290K over 20 MHz, with a noise figure of 1
+  double noiseFloorW = 1.3803e-23 * 290 * 20e6;
+  return signalW / (noiseFloorW + interferenceW);
+}
+
+double
+InterferenceHelperChunksTest::GetChunkSuccessRate (double signalW, double interferenceW, Time duration) const
+{
+  WifiMode mode = m_txVector.GetMode ();
+  uint64_t nbits = static_cast<uint64_t> (mode.GetPhyRate (m_txVector) * duration.GetSeconds ());
+  return m_errorRateModel->GetChunkSuccessRate (mode, m_txVector, GetSnr (signalW, interferenceW), nbits);
+}
+
+void
+InterferenceHelperChunksTest::CheckFirstSignal (void)
+{
+  InterferenceHelper::SnrPer snrPer = m_interference.CalculatePlcpPayloadSnrPer (m_events[0]);
+  NS_TEST_EXPECT_MSG_EQ_TOL (snrPer.snr, GetSnr (1e-9, 0), 1e-6, "Wrong SNR of the first signal");
+  // the payload starts after the 16us of the preamble and the 4us of the header
+  double psr = GetChunkSuccessRate (1e-9, 0, MicroSeconds (180))
+    * GetChunkSuccessRate (1e-9, 1e-10, MicroSeconds (300))
+    * GetChunkSuccessRate (1e-9, 0, MicroSeconds (100))
+    * GetChunkSuccessRate (1e-9, 2e-10, MicroSeconds (400));
+  NS_TEST_EXPECT_MSG_EQ_TOL (snrPer.per, 1 - psr, 1e-9, "Wrong PER of the first signal");
+  m_interference.NotifyRxEnd ();
+}
+
+void
+InterferenceHelperChunksTest::CheckLastSignal (void)
+{
+  InterferenceHelper::SnrPer snrPer = m_interference.CalculatePlcpPayloadSnrPer (m_events[3]);
+  NS_TEST_EXPECT_MSG_EQ_TOL (snrPer.snr, GetSnr (1e-9, 2e-10), 1e-6, "Wrong SNR of the last signal");
+}
+
+void
+InterferenceHelperChunksTest::DoRun (void)
+{
+  m_errorRateModel = CreateObject<NistErrorRateModel> ();
+  m_interference.SetNoiseFigure (1);
+  m_interference.SetErrorRateModel (m_errorRateModel);
+  m_txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  m_txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
+  m_txVector.SetChannelWidth (20);
+
+  // the first signal is received from 0 to 1000us, the second one adds
+  // interference from 200 to 500us and the third one from 600 to 1200us.
+  AddSignal (0, 1e-9, MicroSeconds (1000));
+  m_interference.NotifyRxStart ();
+  Simulator::Schedule (MicroSeconds (100), &InterferenceHelperChunksTest::CheckEnergyDuration, this, 5e-10, MicroSeconds (900));
+  Simulator::Schedule (MicroSeconds (200), &InterferenceHelperChunksTest::AddSignal, this, 1, 1e-10, MicroSeconds (300));
+  Simulator::Schedule (MicroSeconds (300), &InterferenceHelperChunksTest::CheckEnergyDuration, this, 1.05e-9, MicroSeconds (200));
+  Simulator::Schedule (MicroSeconds (600), &InterferenceHelperChunksTest::AddSignal, this, 2, 2e-10, MicroSeconds (600));
+  Simulator::Schedule (MicroSeconds (700), &InterferenceHelperChunksTest::CheckEnergyDuration, this, 1.1e-9, MicroSeconds (300));
+  Simulator::Schedule (MicroSeconds (1000), &InterferenceHelperChunksTest::CheckFirstSignal, this);
+  // the last signal is added once the reception of the first one ended.
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelperChunksTest::AddSignal, this, 3, 1e-9, MicroSeconds (500));
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelperChunksTest::CheckEnergyDuration, this, 1.1e-9, MicroSeconds (100));
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelperChunksTest::CheckLastSignal, this);
+  Simulator::Schedule (MicroSeconds (1300), &InterferenceHelperChunksTest::CheckEnergyDuration, this, 5e-10, MicroSeconds (300));
+  Simulator::Schedule (MicroSeconds (1300), &InterferenceHelperChunksTest::CheckEnergyDuration, this, 1.1e-9, MicroSeconds (0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_events[i] = 0;
+    }
+  m_interference.EraseEvents ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1715,6 +2004,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
+  AddTestCase (new InterferenceHelperChunksTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
@@ -26,12 +26,17 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/queue-size.h"
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <stdlib.h> // for exit ()
 #include <limits>
 #include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -328,6 +333,204 @@ benchByteTags (uint32_t n)
     }
 }
 
+/// Number of real (allocated) bytes of the last virtual payload packet.
+static uint32_t g_virtualPayloadRealBytes = 0;
+
+/**
+ * Stream buffer discarding its output, standing for a pcap file.
+ */
+class NullStreamBuffer : public std::streambuf
+{
+protected:
+  virtual std::streamsize xsputn (const char *, std::streamsize n)
+  {
+    return n;
+  }
+  virtual int_type overflow (int_type c)
+  {
+    return traits_type::not_eof (c);
+  }
+};
+
+static void
+benchVirtualPayload (uint32_t n)
+{
+  BenchHeader<20> tcp;
+  BenchHeader<20> ipv4;
+  NullStreamBuffer buffer;
+  std::ostream pcap (&buffer);
+
+  for (uint32_t i = 0; i < n; i++) {
+    /* A TCP segment gathering three application writes */
+    Ptr<Packet> segment = Create<Packet> (500);
+    segment->AddAtEnd (Create<Packet> (500));
+    segment->AddAtEnd (Create<Packet> (460));
+    segment->AddHeader (tcp);
+    segment->AddHeader (ipv4);
+    segment->CopyData (&pcap, segment->GetSize ());
+
+    /* Forwarded over a link with a smaller MTU */
+    Ptr<Packet> frag0 = segment->CreateFragment (0, 600);
+    Ptr<Packet> frag1 = segment->CreateFragment (600, 600);
+    Ptr<Packet> frag2 = segment->CreateFragment (1200, 300);
+    frag0->CopyData (&pcap, frag0->GetSize ());
+    frag1->CopyData (&pcap, frag1->GetSize ());
+    frag2->CopyData (&pcap, frag2->GetSize ());
+
+    /* Reassembled at the receiver */
+    frag0->AddAtEnd (frag1);
+    frag0->AddAtEnd (frag2);
+    frag0->RemoveHeader (ipv4);
+    frag0->RemoveHeader (tcp);
+    frag0->RemoveAtStart (500);
+    g_virtualPayloadRealBytes = frag0->GetSize () - frag0->GetVirtualPayloadSize ();
+  }
+}
+
+static void
+benchMixedSizes (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+  static uint8_t jumbo[9000];
+  std::vector<Ptr<Packet> > queue (64);
+
+  /* Small packets with an occasional jumbo frame, through a queue */
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p;
+    if (i % 16 == 0)
+      {
+        p = Create<Packet> (jumbo, sizeof (jumbo));
+      }
+    else
+      {
+        p = Create<Packet> (100);
+      }
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    queue[i % queue.size ()] = p;
+  }
+}
+
+static void
+benchLinkHeaders (uint32_t n)
+{
+  EthernetHeader ethernet;
+  LlcSnapHeader llc;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (1000);
+    p->AddHeader (llc);
+    p->AddHeader (ethernet);
+    p->RemoveHeader (ethernet);
+    p->RemoveHeader (llc);
+  }
+}
+
+static void
+benchRemoveAddHeader (uint32_t n)
+{
+  LlcSnapHeader llc;
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddHeader (llc);
+
+  /* The outer header modified at each hop */
+  for (uint32_t i = 0; i < n; i++) {
+    p->RemoveHeader (llc);
+    llc.SetType (i & 0xffff);
+    p->AddHeader (llc);
+  }
+}
+
+static void
+benchReplaceHeader (uint32_t n)
+{
+  LlcSnapHeader llc;
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddHeader (llc);
+
+  for (uint32_t i = 0; i < n; i++) {
+    p->PeekHeader (llc);
+    llc.SetType (i & 0xffff);
+    p->ReplaceHeader (llc);
+  }
+}
+
+/**
+ * The packet tags of a unicast data frame sent and received by wifi.
+ * The tags stand for the wifi and IP tags of similar sizes, noted in
+ * the comments.
+ */
+static void
+benchWifiTags (uint32_t n)
+{
+  BenchTag<1> priority;     // SocketPriorityTag
+  BenchTag<2> ttl;          // SocketIpTtlTag
+  BenchTag<24> dataTx;      // HighLatencyDataTxVectorTag
+  BenchTag<23> rtsTx;       // HighLatencyRtsTxVectorTag
+  BenchTag<22> ctsToSelfTx; // HighLatencyCtsToSelfTxVectorTag
+  BenchTag<10> ampdu;       // AmpduTag
+  BenchTag<27> phy;         // WifiPhyTag
+  BenchTag<8> snr;          // SnrTag
+
+  for (uint32_t i = 0; i < n; i++) {
+    // Transmission: socket, IP, station manager, MAC and PHY.
+    Ptr<Packet> p = Create<Packet> (1000);
+    p->AddPacketTag (priority);
+    p->RemovePacketTag (ttl);
+    p->PeekPacketTag (priority);
+    p->RemovePacketTag (dataTx);
+    p->RemovePacketTag (rtsTx);
+    p->RemovePacketTag (ctsToSelfTx);
+    p->AddPacketTag (dataTx);
+    p->AddPacketTag (rtsTx);
+    p->AddPacketTag (ctsToSelfTx);
+    p->PeekPacketTag (dataTx);
+    p->PeekPacketTag (ampdu);
+    p->RemovePacketTag (phy);
+    p->AddPacketTag (phy);
+    // Reception of the copy delivered by the channel.
+    Ptr<Packet> r = p->Copy ();
+    r->PeekPacketTag (ampdu);
+    r->RemovePacketTag (phy);
+    r->AddPacketTag (snr);
+    r->RemovePacketTag (snr);
+    r->RemovePacketTag (priority);
+  }
+}
+
+static void
+benchDropTailQueue (uint32_t n)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("1000p"));
+  Ptr<Packet> p = Create<Packet> (1000);
+  // Bursts of 1 to 64 packets, leaving a standing backlog of 100 packets.
+  for (uint32_t i = 0; i < 100; i++) {
+    queue->Enqueue (p);
+  }
+  uint32_t burst = 1;
+  for (uint32_t i = 0; i < n; i += burst) {
+    burst = (burst * 13) % 64 + 1;
+    for (uint32_t j = 0; j < burst; j++) {
+      queue->Enqueue (p);
+    }
+    for (uint32_t j = 0; j < burst; j++) {
+      queue->Dequeue ();
+    }
+  }
+}
+
+static void
+printAllocationStatistics (char const *name, const PacketAllocator::Statistics &statistics)
+{
+  std::cout << name << ": "
+            << statistics.allocations << " allocations, "
+            << statistics.GetRecycleRate () * 100 << "% recycled, "
+            << statistics.peakBytes << " peak bytes"
+            << std::endl;
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -385,6 +588,21 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchVirtualPayload, n, minIterations, "Virtual payload through fragmentation and pcap");
+  std::cout << "Real payload bytes after reassembly: "
+            << g_virtualPayloadRealBytes << std::endl;
+  runBench (&benchMixedSizes, n, minIterations, "Small and jumbo packets");
+  runBench (&benchLinkHeaders, n, minIterations, "Add and remove Ethernet and LLC headers");
+  runBench (&benchRemoveAddHeader, n, minIterations, "Modify header with remove and add");
+  runBench (&benchReplaceHeader, n, minIterations, "Modify header with replace");
+  runBench (&benchWifiTags, n, minIterations, "Packet tags of a wifi data frame");
+  runBench (&benchDropTailQueue, n, minIterations, "Enqueue and dequeue bursts in a DropTailQueue");
+
+  Packet::AllocationStatistics statistics = Packet::GetAllocationStatistics ();
+  printAllocationStatistics ("Buffer", statistics.buffer);
+  printAllocationStatistics ("Metadata", statistics.metadata);
+  printAllocationStatistics ("Byte tags", statistics.byteTags);
+  printAllocationStatistics ("Packet tags", statistics.packetTags);
 
   return 0;
 }
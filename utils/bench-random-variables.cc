@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * Time drawing \p total values from \p rv one GetValue () at a time.
+ *
+ * \param [in] rv The random variable.
+ * \param [in] total The number of values to draw.
+ * \param [out] sum The sum of the values, to keep them live.
+ * \returns The elapsed time, in s.
+ */
+double
+BenchScalar (Ptr<RandomVariableStream> rv, uint64_t total, double &sum)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t i = 0; i < total; ++i)
+    {
+      sum += rv->GetValue ();
+    }
+  return time.End () / 1000.0;
+}
+
+/**
+ * Time drawing \p total values from \p rv with GetValues (),
+ * \p block values at a time.
+ *
+ * \param [in] rv The random variable.
+ * \param [in] total The number of values to draw.
+ * \param [in] block The number of values drawn per call.
+ * \param [out] sum The sum of the values, to keep them live.
+ * \returns The elapsed time, in s.
+ */
+double
+BenchBatch (Ptr<RandomVariableStream> rv, uint64_t total, uint32_t block, double &sum)
+{
+  std::vector<double> values (block);
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t done = 0; done < total; done += block)
+    {
+      rv->GetValues (&values[0], block);
+      for (uint32_t i = 0; i < block; ++i)
+        {
+          sum += values[i];
+        }
+    }
+  return time.End () / 1000.0;
+}
+
+/**
+ * Benchmark one random variable.
+ *
+ * \param [in] name The TypeId name of the random variable.
+ * \param [in] total The number of values to draw.
+ * \param [in] block The number of values drawn per GetValues () call.
+ */
+void
+Bench (std::string name, uint64_t total, uint32_t block)
+{
+  ObjectFactory factory (name);
+  // Draw both sequences from the same stream, so the sums must agree.
+  Ptr<RandomVariableStream> scalar = factory.Create<RandomVariableStream> ();
+  scalar->SetStream (1);
+  Ptr<RandomVariableStream> batch = factory.Create<RandomVariableStream> ();
+  batch->SetStream (1);
+
+  double scalarSum = 0;
+  double batchSum = 0;
+  double scalarTime = BenchScalar (scalar, total, scalarSum);
+  double batchTime = BenchBatch (batch, total, block, batchSum);
+
+  std::string type = name.substr (name.find ("::") + 2);
+  LOG (std::left << std::setw (2 * g_fwidth) << type <<
+       std::right << std::setw (g_fwidth) << (total / scalarTime) <<
+       std::setw (g_fwidth) << (total / batchTime) <<
+       std::setw (g_fwidth) << (scalarTime / batchTime) <<
+       std::setw (g_fwidth) << (scalarSum == batchSum ? "yes" : "NO"));
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t total = 10000000;
+  uint32_t block = 1024;
+  std::string type = "";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark RandomVariableStream::GetValue against GetValues.\n"
+             "\n"
+             "For each random variable, draws the same sequence of values\n"
+             "one at a time and in blocks, and reports the rate of each\n"
+             "(values/s), the speedup, and whether the sequences matched.");
+  cmd.AddValue ("total", "number of values to draw (default 1E7)", total);
+  cmd.AddValue ("block", "number of values per GetValues call (default 1024)", block);
+  cmd.AddValue ("type",  "only benchmark this TypeId, e.g. ns3::UniformRandomVariable", type);
+  cmd.Parse (argc, argv);
+
+  if (block == 0)
+    {
+      NS_FATAL_ERROR ("--block must be positive");
+    }
+  // Draw whole blocks only, so both methods draw the same count.
+  total = (total + block - 1) / block * block;
+
+  std::vector<std::string> types;
+  if (type != "")
+    {
+      types.push_back (type);
+    }
+  else
+    {
+      types.push_back ("ns3::UniformRandomVariable");
+      types.push_back ("ns3::ExponentialRandomVariable");
+      types.push_back ("ns3::ParetoRandomVariable");
+      types.push_back ("ns3::WeibullRandomVariable");
+      types.push_back ("ns3::NormalRandomVariable");
+    }
+
+  LOG ("total values: " << total);
+  LOG ("block size: " << block);
+  LOG ("");
+  LOG (std::left << std::setw (2 * g_fwidth) << "Type" <<
+       std::right << std::setw (g_fwidth) << "GetValue/s" <<
+       std::setw (g_fwidth) << "GetValues/s" <<
+       std::setw (g_fwidth) << "Speedup" <<
+       std::setw (g_fwidth) << "Identical");
+  for (std::vector<std::string>::const_iterator i = types.begin (); i != types.end (); ++i)
+    {
+      Bench (*i, total, block);
+    }
+  return 0;
+}
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/trace-recorder-helper.h"
+
+using namespace ns3;
+
+/**
+ * Convert a recording written by TraceRecorder to ASCII and pcap traces.
+ *
+ * \code
+ *   ./waf --run "trace-recording-decoder --input=trace.bin --ascii=trace.tr --pcap=trace"
+ * \endcode
+ */
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string ascii = "-";
+  std::string pcap;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a TraceRecorder recording to ASCII and pcap traces.");
+  cmd.AddValue ("input", "The recording to convert.", input);
+  cmd.AddValue ("ascii", "The ASCII trace to write; \"-\" for the standard output, "
+                "\"\" for none.", ascii);
+  cmd.AddValue ("pcap", "The prefix of the pcap files to write, one per packet "
+                "trace source; \"\" for none.", pcap);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "No --input recording given." << std::endl;
+      return 1;
+    }
+  if (!TraceRecording (input).IsOk ())
+    {
+      std::cerr << input << " is not a TraceRecorder recording." << std::endl;
+      return 1;
+    }
+
+  bool ok = true;
+  if (ascii == "-")
+    {
+      ok = TraceRecorderHelper::WriteAscii (input, std::cout);
+    }
+  else if (!ascii.empty ())
+    {
+      std::ofstream os (ascii.c_str ());
+      ok = TraceRecorderHelper::WriteAscii (input, os);
+    }
+  if (!pcap.empty ())
+    {
+      // The sources of the pcap files are listed on the standard error
+      // when the ASCII trace goes to the standard output.
+      std::ostream &index = ascii == "-" ? std::cerr : std::cout;
+      TraceRecorderHelper::WritePcap (input, pcap, index);
+    }
+  if (!ok)
+    {
+      std::cerr << input << " is truncated or corrupted." << std::endl;
+      return 1;
+    }
+  return 0;
+}